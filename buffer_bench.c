@@ -0,0 +1,401 @@
+/*
+buffer_bench.c
+Author: Pradyumna Deshpande
+*/
+
+// Benchmark suite for the buffer manager. Runs synthetic workloads on a shared pool for every combination of workload,
+// pool size, replacement strategy and thread count and prints one result line per run as CSV (or JSON lines with -j).
+// Usage: buffer_bench [-w workloads] [-s pool sizes] [-r strategies] [-t thread counts] [-n operations] [-p pages]
+//                     [-P partitions] [-W write percent] [-j]
+// Lists are comma separated, e.g. -w zipf,scan -s 100,1000 -r LRU,CLOCK -t 1,4.
+// Workloads:
+//   uniform  every page equally likely
+//   zipf     Zipfian page popularity (theta 0.99), page 0 is the most popular
+//   scan     each thread reads all pages in order, starting at its own offset
+//   scanhot  70% of pins go to a hot set of 5% of the pages, the rest scan the other pages
+//   rwmix    zipf where a share of the pins (-W, default 30%) marks the page dirty
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<strings.h>
+#include<math.h>
+#include<time.h>
+#include<unistd.h>
+#include<pthread.h>
+
+#include "storage_mgr.h"
+#include "buffer_mgr.h"
+#include "metrics.h"
+
+#define BENCH_PAGE_FILE "buffer_bench.bin"
+#define MAX_LIST 32
+#define ZIPF_THETA 0.99
+#define HOT_SET_PERCENT 5
+#define HOT_PIN_PERCENT 70
+
+typedef enum Workload {
+    WL_UNIFORM = 0,
+    WL_ZIPF = 1,
+    WL_SCAN = 2,
+    WL_SCAN_HOT = 3,
+    WL_RW_MIX = 4,
+    NUM_WORKLOADS = 5
+} Workload;
+
+static const char *workloadNames[NUM_WORKLOADS] = {"uniform", "zipf", "scan", "scanhot", "rwmix"};
+
+#define NUM_STRATEGIES 5
+static const ReplacementStrategy strategies[NUM_STRATEGIES] = {RS_FIFO, RS_LRU, RS_CLOCK, RS_LFU, RS_LRU_K};
+static const char *strategyNames[NUM_STRATEGIES] = {"FIFO", "LRU", "CLOCK", "LFU", "LRU-K"};
+
+// Struct for the settings of one run
+typedef struct BenchRun {
+    Workload workload;
+    int strategy;
+    int poolSize;
+    int numThreads;
+    int numOps;
+    int numPages;
+    int numPartitions;
+    int writePercent;
+} BenchRun;
+
+// Struct for the state shared by the threads of a run
+typedef struct BenchShared {
+    BenchRun *run;
+    BM_BufferPool *bm;
+    PoolMetrics *latencies;  // client side pin latency, including waits for partition latches
+    const double *zipfCdf;
+    pthread_barrier_t start;
+    uint64_t failedPins;
+} BenchShared;
+
+typedef struct BenchThread {
+    BenchShared *shared;
+    int threadNum;
+    pthread_t thread;
+} BenchThread;
+
+// Function for a fast per thread random number generator (xorshift64*)
+static uint64_t nextRandom(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * UINT64_C(2685821657736338717);
+}
+
+static double nextUniform(uint64_t *state) {
+    return (nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Function to build the cumulative Zipf distribution over numPages pages
+static double *createZipfCdf(int numPages) {
+    double *cdf = (double*)malloc(sizeof(double) * numPages);
+    double sum = 0;
+
+    for(int i = 0; i < numPages; i++) {
+        sum += 1.0 / pow(i + 1, ZIPF_THETA);
+        cdf[i] = sum;
+    }
+
+    for(int i = 0; i < numPages; i++) {
+        cdf[i] /= sum;
+    }
+
+    return cdf;
+}
+
+// Function to draw a page from the Zipf distribution by binary search over the cumulative distribution
+static PageNumber nextZipfPage(const double *cdf, int numPages, uint64_t *state) {
+    double u = nextUniform(state);
+    int low = 0, high = numPages - 1;
+
+    while(low < high) {
+        int mid = (low + high) / 2;
+        if(cdf[mid] < u) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+// Function to choose the next page of a thread. cursor is the thread's scan position
+static PageNumber nextPage(BenchShared *shared, uint64_t *state, int *cursor) {
+    BenchRun *run = shared->run;
+    int hotPages = run->numPages * HOT_SET_PERCENT / 100 > 0 ? run->numPages * HOT_SET_PERCENT / 100 : 1;
+
+    switch(run->workload) {
+        case WL_UNIFORM:
+            return nextRandom(state) % run->numPages;
+
+        case WL_ZIPF:
+        case WL_RW_MIX:
+            return nextZipfPage(shared->zipfCdf, run->numPages, state);
+
+        case WL_SCAN:
+            *cursor = (*cursor + 1) % run->numPages;
+            return *cursor;
+
+        case WL_SCAN_HOT:
+            if(hotPages >= run->numPages || (int) (nextRandom(state) % 100) < HOT_PIN_PERCENT) {
+                return nextRandom(state) % hotPages;
+            }
+
+            *cursor = (*cursor + 1) % (run->numPages - hotPages);
+            return hotPages + *cursor;
+
+        default:
+            return 0;
+    }
+}
+
+// Function for a benchmark thread. Pins, optionally marks dirty and unpins its share of the operations
+static void *runBenchThread(void *arg) {
+    BenchThread *self = (BenchThread*) arg;
+    BenchShared *shared = self->shared;
+    BenchRun *run = shared->run;
+    BM_PageHandle h;
+    uint64_t state = 0x9E3779B97F4A7C15ULL * (self->threadNum + 1);
+    int cursor = (int) ((long) run->numPages * self->threadNum / run->numThreads);
+    int numOps = run->numOps / run->numThreads;
+    uint64_t failed = 0;
+
+    h.frameNum = -1;
+    pthread_barrier_wait(&shared->start);
+
+    for(int i = 0; i < numOps; i++) {
+        PageNumber pageNum = nextPage(shared, &state, &cursor);
+        bool write = run->workload == WL_RW_MIX && (int) (nextRandom(&state) % 100) < run->writePercent;
+
+        uint64_t start = metricsNow();
+        RC rc = pinPage(shared->bm, &h, pageNum);
+        recordLatency(shared->latencies, LATENCY_PIN_HIT, metricsNow() - start);
+
+        if(rc != RC_OK) {
+            failed++;
+            continue;
+        }
+
+        if(write) {
+            markDirty(shared->bm, &h);
+        }
+
+        unpinPage(shared->bm, &h);
+    }
+
+    __atomic_fetch_add(&shared->failedPins, failed, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// Function to run one benchmark and print its result line. The pool is warmed up with the same workload first, and
+// only the counters of the timed part are reported
+static RC runBenchmark(BenchRun *run, const double *zipfCdf, bool json, FILE *results) {
+    BM_BufferPool bm;
+    BM_PoolOptions opts;
+    BM_PoolMetrics before, after, latencies;
+    BenchShared shared;
+
+    initPoolOptions(&opts);
+    opts.numPartitions = run->numPartitions;
+
+    RC rc = initBufferPoolWithOptions(&bm, BENCH_PAGE_FILE, run->poolSize, strategies[run->strategy], NULL, &opts);
+    if(rc != RC_OK) {
+        return rc;
+    }
+
+    shared.run = run;
+    shared.bm = &bm;
+    shared.zipfCdf = zipfCdf;
+    shared.failedPins = 0;
+
+    // Warm up with twice the pool size in operations on a single thread
+    BenchRun warmRun = *run;
+    warmRun.numThreads = 1;
+    warmRun.numOps = 2 * run->poolSize;
+    shared.run = &warmRun;
+    shared.latencies = createPoolMetrics();
+    pthread_barrier_init(&shared.start, NULL, 1);
+
+    BenchThread warmThread = {&shared, 0, 0};
+    runBenchThread(&warmThread);
+
+    pthread_barrier_destroy(&shared.start);
+    destroyPoolMetrics(shared.latencies);
+
+    shared.run = run;
+    shared.failedPins = 0;
+    shared.latencies = createPoolMetrics();
+    pthread_barrier_init(&shared.start, NULL, run->numThreads + 1);
+
+    BenchThread *threads = (BenchThread*)malloc(sizeof(BenchThread) * run->numThreads);
+    for(int t = 0; t < run->numThreads; t++) {
+        threads[t].shared = &shared;
+        threads[t].threadNum = t;
+        pthread_create(&threads[t].thread, NULL, runBenchThread, &threads[t]);
+    }
+
+    getPoolMetrics(&bm, &before);
+    pthread_barrier_wait(&shared.start);
+    uint64_t start = metricsNow();
+
+    for(int t = 0; t < run->numThreads; t++) {
+        pthread_join(threads[t].thread, NULL);
+    }
+
+    uint64_t elapsed = metricsNow() - start;
+    getPoolMetrics(&bm, &after);
+    readPoolMetrics(shared.latencies, &latencies);
+
+    uint64_t ops = (uint64_t) (run->numOps / run->numThreads) * run->numThreads;
+    uint64_t hits = after.counters[METRIC_HITS] - before.counters[METRIC_HITS];
+    uint64_t misses = after.counters[METRIC_MISSES] - before.counters[METRIC_MISSES];
+    uint64_t reads = after.counters[METRIC_READS] - before.counters[METRIC_READS];
+    uint64_t writes = after.counters[METRIC_WRITES] - before.counters[METRIC_WRITES];
+    double opsPerSec = elapsed > 0 ? ops * 1e9 / elapsed : 0;
+    double hitRatio = hits + misses > 0 ? (double) hits / (hits + misses) : 0;
+    BM_LatencySummary *pin = &latencies.latencies[LATENCY_PIN_HIT];
+
+    if(json) {
+        fprintf(results, "{\"workload\":\"%s\",\"strategy\":\"%s\",\"poolSize\":%d,\"threads\":%d,\"ops\":%llu,"
+                "\"opsPerSec\":%.0f,\"hitRatio\":%.4f,\"p50Nanos\":%llu,\"p99Nanos\":%llu,\"reads\":%llu,\"writes\":%llu,"
+                "\"failedPins\":%llu}\n",
+                workloadNames[run->workload], strategyNames[run->strategy], run->poolSize, run->numThreads,
+                (unsigned long long) ops, opsPerSec, hitRatio, (unsigned long long) pin->p50Nanos,
+                (unsigned long long) pin->p99Nanos, (unsigned long long) reads, (unsigned long long) writes,
+                (unsigned long long) shared.failedPins);
+    } else {
+        fprintf(results, "%s,%s,%d,%d,%llu,%.0f,%.4f,%llu,%llu,%llu,%llu,%llu\n",
+                workloadNames[run->workload], strategyNames[run->strategy], run->poolSize, run->numThreads,
+                (unsigned long long) ops, opsPerSec, hitRatio, (unsigned long long) pin->p50Nanos,
+                (unsigned long long) pin->p99Nanos, (unsigned long long) reads, (unsigned long long) writes,
+                (unsigned long long) shared.failedPins);
+    }
+    fflush(results);
+
+    pthread_barrier_destroy(&shared.start);
+    destroyPoolMetrics(shared.latencies);
+    free(threads);
+
+    return shutdownBufferPool(&bm);
+}
+
+// Function to parse a comma separated list of names into indexes. Returns the number of entries or -1 for unknown names
+static int parseNames(char *list, const char **names, int numNames, int *out) {
+    int count = 0;
+
+    for(char *name = strtok(list, ","); name != NULL && count < MAX_LIST; name = strtok(NULL, ",")) {
+        int found = -1;
+        for(int i = 0; i < numNames; i++) {
+            if(strcasecmp(name, names[i]) == 0) {
+                found = i;
+            }
+        }
+
+        if(found == -1) {
+            fprintf(stderr, "Unknown name %s.\n", name);
+            return -1;
+        }
+
+        out[count++] = found;
+    }
+
+    return count;
+}
+
+// Function to parse a comma separated list of positive numbers. Returns the number of entries or -1 for bad numbers
+static int parseNumbers(char *list, int *out) {
+    int count = 0;
+
+    for(char *num = strtok(list, ","); num != NULL && count < MAX_LIST; num = strtok(NULL, ",")) {
+        out[count] = atoi(num);
+        if(out[count] <= 0) {
+            fprintf(stderr, "Bad number %s.\n", num);
+            return -1;
+        }
+        count++;
+    }
+
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    int workloads[MAX_LIST] = {WL_UNIFORM, WL_ZIPF, WL_SCAN, WL_SCAN_HOT, WL_RW_MIX};
+    int sizes[MAX_LIST] = {64, 512};
+    int strats[MAX_LIST] = {0, 1, 2, 3, 4};
+    int threadCounts[MAX_LIST] = {1, 4};
+    int numWorkloads = NUM_WORKLOADS, numSizes = 2, numStrats = NUM_STRATEGIES, numThreadCounts = 2;
+    int numOps = 20000, numPages = 2048, numPartitions = 0, writePercent = 30;
+    bool json = false;
+    int opt;
+
+    while((opt = getopt(argc, argv, "w:s:r:t:n:p:P:W:j")) != -1) {
+        switch(opt) {
+            case 'w': numWorkloads = parseNames(optarg, workloadNames, NUM_WORKLOADS, workloads); break;
+            case 's': numSizes = parseNumbers(optarg, sizes); break;
+            case 'r': numStrats = parseNames(optarg, strategyNames, NUM_STRATEGIES, strats); break;
+            case 't': numThreadCounts = parseNumbers(optarg, threadCounts); break;
+            case 'n': numOps = atoi(optarg); break;
+            case 'p': numPages = atoi(optarg); break;
+            case 'P': numPartitions = atoi(optarg); break;
+            case 'W': writePercent = atoi(optarg); break;
+            case 'j': json = true; break;
+            default: numOps = -1; break;
+        }
+    }
+
+    if(numWorkloads <= 0 || numSizes <= 0 || numStrats <= 0 || numThreadCounts <= 0 || numOps <= 0 || numPages <= 0
+            || numPartitions < 0 || writePercent < 0 || writePercent > 100) {
+        fprintf(stderr, "Usage: %s [-w workloads] [-s pool sizes] [-r strategies] [-t thread counts] [-n operations] "
+                "[-p pages] [-P partitions] [-W write percent] [-j]\n", argv[0]);
+        return 1;
+    }
+
+    // Results go to the original stdout. The buffer manager's own logging is discarded while measuring
+    fflush(stdout);
+    FILE *results = fdopen(dup(STDOUT_FILENO), "w");
+    if(results == NULL || freopen("/dev/null", "w", stdout) == NULL) {
+        fprintf(stderr, "Could not redirect buffer manager output.\n");
+        return 1;
+    }
+
+    SM_FileHandle fHandle;
+    initStorageManager();
+    createPageFile(BENCH_PAGE_FILE);
+    openPageFile(BENCH_PAGE_FILE, &fHandle);
+    ensureCapacity(numPages, &fHandle);
+    closePageFile(&fHandle);
+
+    double *zipfCdf = createZipfCdf(numPages);
+
+    if(!json) {
+        fprintf(results, "workload,strategy,poolSize,threads,ops,opsPerSec,hitRatio,p50Nanos,p99Nanos,reads,writes,failedPins\n");
+    }
+
+    int exitCode = 0;
+    for(int w = 0; w < numWorkloads; w++) {
+        for(int s = 0; s < numSizes; s++) {
+            for(int r = 0; r < numStrats; r++) {
+                for(int t = 0; t < numThreadCounts; t++) {
+                    BenchRun run = {(Workload) workloads[w], strats[r], sizes[s], threadCounts[t], numOps, numPages,
+                            numPartitions, writePercent};
+
+                    if(runBenchmark(&run, zipfCdf, json, results) != RC_OK) {
+                        fprintf(stderr, "Run %s with %s, %d frames and %d threads failed.\n", workloadNames[run.workload],
+                                strategyNames[run.strategy], run.poolSize, run.numThreads);
+                        exitCode = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    free(zipfCdf);
+    destroyPageFile(BENCH_PAGE_FILE);
+    fclose(results);
+
+    return exitCode;
+}
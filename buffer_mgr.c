@@ -5,73 +5,443 @@ Author: Pradyumna Deshpande
 
 #include<stdio.h>
 #include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+#include<errno.h>
+#include<time.h>
+#include<pthread.h>
 
 #include "buffer_mgr.h"
 #include "storage_mgr.h"
-
-// Need to initialize buffer stat variables globally as well or else will be initialized with garbage values
-int readCnt = 0;
-int writeCnt = 0;
-int lruCounter = 0;
-int fifoCounter = 0;
-int lfuCounter = 0;
-int clockCounter = 0;
-SM_FileHandle *fHandle = NULL;
-
-// Struct for storing page frames. This struct will be be stored in mgmtData of given buffer pool object
+#include "victim_cache.h"
+#include "frame_arena.h"
+#include "metrics.h"
+#include "trace.h"
+#include "mrc.h"
+#include "hot_pages.h"
+#include "frame_search.h"
+#include "pin_tracker.h"
+#include "tenant_quota.h"
+#include "shared_pool.h"
+
+// File id for flushFiles() to write the dirty pages of every file
+#define ALL_FILES -1
+
+// Pages allocated at once for shadow copies of update pins
+#define SHADOW_CHUNK_PAGES 16
+
+// Context of pins made without one
+static const BM_PinContext defaultPinContext = { DEFAULT_TENANT, PRIORITY_NORMAL };
+
+// Call site recorded with tracked pins. Only debug builds record it
+#ifdef NDEBUG
+#define PIN_CALL_SITE() NULL
+#else
+#define PIN_CALL_SITE() __builtin_return_address(0)
+#endif
+
+// Struct for a page read running without the partition latch. Pins of the same page find the frame meanwhile and wait
+// for this read instead of reading the page again. Freed by whoever is done with it last
+typedef struct InFlightRead {
+    pthread_cond_t done;
+    bool finished;
+    RC rc;  // Result of the read, handed to every waiting pin
+    int numWaiters;
+} InFlightRead;
+
+// Struct for page data a published shadow copy replaced while pins still read it. Goes back to the partition's free
+// page data once the last of those pins is unpinned
+typedef struct PageVersion {
+    char *data;
+    int numReaders;
+    struct PageVersion *next;
+} PageVersion;
+
+// Struct for the cold fields of a page frame, only read once a frame has been chosen
 typedef struct Frame {
-    int pinCnt;
-    bool isDirty;
-    PageNumber pageNo;
     SM_PageHandle pageData;
-    int lruPos;
-    int fifoPos;
-    int lfuPos;
-    int lfuHit;
-    bool clockChance;
+    unsigned int version;   // Seqlock counter for optimistic readers. Odd while the frame's page or data is changing
+    unsigned int generation;    // Increased every time the frame gets a new page, so page handles can tell if it was evicted
+    InFlightRead *read; // Read of the frame's page still in progress, NULL once the page data is valid
+    char *shadow;   // Copy of the page data changed by update pins, published when the last of them unpins. NULL if none
+    int updatePins; // Pins of the frame working on the shadow
+    bool shadowDirty;   // Set by markDirty() on the shadow. A shadow which wasn't marked dirty is dropped, not published
+    PageVersion *oldVersions;   // Page data replaced by published shadows which pins still read
 } Frame;
 
-// Function to replace page in case of a replacement strategy or in case of pinning to empty frame
-RC replacePage(char *stratName, int frameToEvict, Frame *fr, BM_PageHandle *const page, BM_BufferPool *const bm, const PageNumber pageNum) {
-    // If page to replace is dirty, write it back to disk first
-    if(fr[frameToEvict].isDirty) {
-        page->pageNum = fr[frameToEvict].pageNo;
-        page->data = fr[frameToEvict].pageData;
+// Struct for the frames of a partition. Hot fields are kept in packed arrays, one per field and each starting on a
+// cache line, so page lookups only read page numbers and victim searches only read fix counts and the positions of
+// their strategy. Frame i is entry i of every array. Tables are stored in the arena of the partition they belong to
+typedef struct FrameTable {
+    PageNumber *pageNos;
+    int *fileIds;
+    int *pinCnts;
+    bool *dirtyFlags;
+    int *lruPos;
+    int *fifoPos;
+    int *lfuPos;
+    int *lfuHits;
+    bool *clockChances;
+    int *owners;    // Tenant which loaded the frame's page
+    int *priorities;    // Highest priority class of the pins which loaded or hit the frame's page
+    int *victimPins;    // Fix counts the strategy sees while tenant rules hide frames from it. Scratch of the latch holder
+    Frame *frames;
+} FrameTable;
+
+struct ReadBatch;
+
+// Struct for a thread waiting in pinPage() because all frames of a partition are pinned. Lives on the waiting thread's
+// stack and is queued on the partition until the thread wakes up
+typedef struct PinWaiter {
+    pthread_cond_t wake;
+    int frame;  // Frame handed to the waiter, -1 while it waits. A handed frame stays pinned once for the waiter
+    struct PinWaiter *next;
+} PinWaiter;
+
+// Struct for memory a partition gets when it is resized (new frame arrays and page data). Freed with the partition
+typedef struct ExtraArena {
+    void *arena;
+    size_t size;
+    int flags;
+    struct ExtraArena *next;
+} ExtraArena;
+
+// Struct for a partition of the buffer pool. Each partition owns a share of the frames, has its own latch and runs
+// the replacement strategy on its own frames only. The struct sits at the start of the partition's arena, followed by
+// its frame table on a cache line boundary. Page data has an arena of its own, which may use huge pages. Both are allocated
+// on the partition's NUMA node
+typedef struct Partition {
+    pthread_mutex_t latch;
+    FrameTable *table;
+    int numFrames;
+    int frameCapacity;  // Size of the table's arrays. Never shrinks, so optimistic readers without the latch stay in bounds
+    FrameTable *spareTable;     // Table published before the current one. The next resize writes its table there
+    int spareCapacity;
+    unsigned int tableSeq;      // Odd while a resize writes a table. Optimistic readers retry if it changed while they read
+    int firstFrame;
+    int numaNode;
+    int arenaFlags;     // Flags for page data arenas. Frame arrays only use ARENA_LOCKED of them
+    size_t arenaSize;
+    char *dataArena;
+    size_t dataArenaSize;
+    ExtraArena *extraArenas;
+    char **freeSlots;   // Page data no frame uses: dropped by resizeBufferPool() or replaced by a published shadow copy
+    unsigned int *freeSlotVersions;
+    int numFreeSlots;
+    int freeSlotCapacity;
+    int lruCounter;
+    int fifoCounter;
+    int lfuCounter;
+    int clockCounter;
+    struct ReadBatch *batch;    // Set while pinPages() holds the latch. Misses are then collected instead of read one by one
+    PinWaiter *waiters; // Threads waiting for a frame, longest waiting first
+    InFlightRead *startedRead;  // Read set up by replacePage() for the pin holding the latch. Done once the latch can be released
+    const int *victimPins;  // Fix counts the replacement strategy picks an unpinned frame by, set for each miss
+    int coldCounter;    // Positions given to frames hinted DONTNEED, below those of all other frames
+} Partition;
+
+// Struct for a page read that waits until all pages pinned by pinPages() have a frame
+typedef struct BatchRead {
+    Partition *part;
+    int frame;
+    PageNumber pageNo;
+} BatchRead;
+
+// Struct for a page pinned by pinPages() whose read was started by another pin. Waited for once the latches are released
+typedef struct BatchWait {
+    Partition *part;
+    InFlightRead *read;
+    BM_PageHandle *page;
+} BatchWait;
+
+typedef struct ReadBatch {
+    BatchRead *reads;
+    int numReads;
+    BatchWait *waits;
+    int numWaits;
+} ReadBatch;
+
+// Struct for a page file registered with the pool. Its storage manager handle stays open until it is unregistered
+typedef struct PoolFile {
+    bool isOpen;
+    bool isRegistered;  // Stays set while unregisterPageFile() runs, so handles of the file's pinned pages still count
+    char *fileName;
+    SM_FileHandle fHandle;
+} PoolFile;
+
+// Struct for the bookkeeping of a buffer pool. This struct will be stored in mgmtData of given buffer pool object
+typedef struct PoolMgmt {
+    Partition **parts;
+    int numParts;
+    PoolFile *files;    // MAX_POOL_FILES entries. Entry MAIN_FILE_ID is the pool's own page file
+    pthread_mutex_t ioLatch;    // Guards the page files, I/O counters and victim cache, which all partitions share
+    int pinWaitMillis;
+    int readAheadPages;
+    int readCnt;
+    int writeCnt;
+    VictimCache *victimCache;
+    PoolMetrics *metrics;
+    PageTrace *trace;   // NULL unless tracing is enabled
+    MrcSampler *mrc;    // NULL unless miss ratio curve estimation is enabled
+    PinTracker *pins;   // NULL unless pin tracking or a pin limit is enabled
+    TenantQuotas *tenants;
+    SharedPool *shared; // NULL unless the pool is in shared memory. Partitions and optional features are then unused
+    bool tenantRules;   // Set once a tenant limit or a pin context is used. Until then misses skip the tenant rules
+    char *warmStartFile;    // NULL unless warm start is enabled
+    int warmSaveSeconds;
+    bool saverRunning;
+    bool stopSaver;
+    pthread_t saver;
+    pthread_mutex_t warmLatch;  // Guards writing the hot page file and stopping the saver thread
+    pthread_cond_t warmWake;
+} PoolMgmt;
+
+// Function to find the partition a page belongs to. Consecutive pages are spread round robin over the partitions, and
+// the pages of each file start at a different partition
+static int partitionIndex(PoolMgmt *pool, int fileId, PageNumber pageNum) {
+    return ((unsigned int) pageNum + (unsigned int) fileId * 31u) % pool->numParts;
+}
 
-        int success = forcePage(bm, page);
-        if(success != RC_OK) {
-            printf("%s: Could not write dirty page %d to disk.\n", stratName, page->pageNum);
-            return RC_WRITE_FAILED;
-        }
+static Partition *partitionOf(PoolMgmt *pool, int fileId, PageNumber pageNum) {
+    return pool->parts[partitionIndex(pool, fileId, pageNum)];
+}
+
+// Function to check if a file id belongs to a registered page file. Entries never move, so no latch is needed
+static bool isOpenFile(PoolMgmt *pool, int fileId) {
+    return fileId >= 0 && fileId < MAX_POOL_FILES && __atomic_load_n(&pool->files[fileId].isOpen, __ATOMIC_ACQUIRE);
+}
+
+// Function to make sure a handle names a registered page file before its page is looked up. Handles made by
+// MAKE_PAGE_HANDLE() start with MAIN_FILE_ID, so only ids out of range or of unregistered files are rejected
+static RC checkHandleFile(PoolMgmt *pool, BM_PageHandle *const page) {
+    if(page->fileId < 0 || page->fileId >= MAX_POOL_FILES
+            || !__atomic_load_n(&pool->files[page->fileId].isRegistered, __ATOMIC_ACQUIRE)) {
+        printf("Operation Check Handle: Page %d names file %d which isn't registered.\n", page->pageNum, page->fileId);
+        RC_message = "Page handle names a file which isn't registered";
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    return RC_OK;
+}
+
+// Function to find the frame a page is pinned to by searching the frames of its partition. Returns -1 if it isn't in the buffer.
+// Page numbers are compared a vector at a time, file ids only for frames with the same page number
+static int findFrame(Partition *part, const int fileId, const PageNumber pageNum) {
+    FrameTable *ft = part->table;
+    int frame = findValue(ft->pageNos, 0, part->numFrames, pageNum);
+
+    while(frame != -1 && ft->fileIds[frame] != fileId) {
+        frame = findValue(ft->pageNos, frame + 1, part->numFrames, pageNum);
     }
 
-    // Block to read new page into the buffer
-    fHandle = (SM_FileHandle*)malloc(sizeof(SM_FileHandle));
+    return frame;
+}
 
-    fr[frameToEvict].pinCnt++;
-    fr[frameToEvict].pageNo = pageNum;
+// Function to find the frame of a page handle filled by pinPage(). If the frame still has the same generation and page,
+// no search is needed. Otherwise (page was evicted, or the handle was never pinned) fall back to searching the partition
+static int lookupFrame(Partition *part, BM_PageHandle *const page, const int fileId, const PageNumber pageNum) {
+    int frame = page->frameNum - part->firstFrame;
 
-    fr[frameToEvict].pageData = (char*)malloc(PAGE_SIZE);
-    int success = openPageFile(bm->pageFile, &fHandle);
-                
-    if(success != RC_OK) {
-        printf("%s: Could not open file. File doesn't exist.\n", stratName);
+    if(page->pageNum == pageNum && page->fileId == fileId && frame >= 0 && frame < part->numFrames
+            && part->table->frames[frame].generation == page->frameGen && part->table->pageNos[frame] == pageNum
+            && part->table->fileIds[frame] == fileId) {
+        return frame;
+    }
+
+    return findFrame(part, fileId, pageNum);
+}
+
+// Function to remember in the handle which frame the page is pinned to
+static void setFrameHandle(Partition *part, int frame, BM_PageHandle *const page) {
+    page->frameNum = part->firstFrame + frame;
+    page->frameGen = part->table->frames[frame].generation;
+}
+
+// Functions to bracket a change of a frame's page or page data. The caller holds the partition latch, so only
+// optimistic readers can observe the frame in between
+static void beginFrameChange(Frame *fr) {
+    __atomic_store_n(&fr->version, fr->version + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void endFrameChange(Frame *fr) {
+    __atomic_store_n(&fr->version, fr->version + 1, __ATOMIC_RELEASE);
+}
+
+// Function to get a frame's page file ready for reading one of its pages. Only growing the file and flushing buffered
+// writes need the I/O latch, so misses in different partitions read in parallel. Expects the partition latch to be held
+static RC prepareFrameRead(char *opName, PoolMgmt *pool, Partition *part, int frame, const PageNumber pageNum, SM_FileHandle **fHandle) {
+    pthread_mutex_lock(&pool->ioLatch);
+
+    // Pages are only loaded for open files. Checked under the partition latch, so unregisterPageFile() sees the frame
+    // and doesn't close the file before the read is done
+    if(!isOpenFile(pool, part->table->fileIds[frame])) {
+        pthread_mutex_unlock(&pool->ioLatch);
+        printf("%s: Could not read page. File is not open.\n", opName);
         return RC_FILE_NOT_FOUND;
     }
 
-    ensureCapacity(pageNum+1, &fHandle);
-    success = readBlock(pageNum, &fHandle, fr[frameToEvict].pageData);
+    *fHandle = &pool->files[part->table->fileIds[frame]].fHandle;
+
+    ensureCapacity(pageNum+1, *fHandle);
+
+    // Evicted dirty pages may still be in the stream's buffer. Other writes of this page can't start while the
+    // frame holds it, so the read sees the latest version
+    int success = flushBlockWrites(*fHandle);
+    pool->readCnt++;
+
+    pthread_mutex_unlock(&pool->ioLatch);
 
     if(success != RC_OK) {
-        printf("%s: Could not read page. Page doesn't exist.\n", stratName);
-        closePageFile(&fHandle);
+        pthread_mutex_lock(&pool->ioLatch);
+        pool->readCnt--;
+        pthread_mutex_unlock(&pool->ioLatch);
+
+        printf("%s: Could not read page. Page doesn't exist.\n", opName);
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+
+    return RC_OK;
+}
+
+// Function to read a page straight into a frame's page data with one system call. Needs no latch
+static RC readFrameData(char *opName, PoolMgmt *pool, SM_FileHandle *fHandle, const PageNumber pageNum, SM_PageHandle pageData) {
+    if(readBlockDirect(pageNum, fHandle, pageData) != RC_OK) {
+        pthread_mutex_lock(&pool->ioLatch);
+        pool->readCnt--;
+        pthread_mutex_unlock(&pool->ioLatch);
+
+        printf("%s: Could not read page. Page doesn't exist.\n", opName);
         return RC_READ_NON_EXISTING_PAGE;
     }
 
-    readCnt++;
+    addMetric(pool->metrics, METRIC_READS, 1);
+    return RC_OK;
+}
+
+// Function to read a page from disk into a frame while keeping the partition latch. The page comes from the file the
+// frame belongs to
+static RC readFrame(char *opName, BM_BufferPool *const bm, Partition *part, int frame, const PageNumber pageNum) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    SM_FileHandle *fHandle;
+
+    RC success = prepareFrameRead(opName, pool, part, frame, pageNum, &fHandle);
+    if(success != RC_OK) {
+        return success;
+    }
+
+    return readFrameData(opName, pool, fHandle, pageNum, part->table->frames[frame].pageData);
+}
+
+// Function to write the dirty page of a frame to disk
+static RC writeFrame(BM_BufferPool *const bm, Partition *part, int frame) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    FrameTable *ft = part->table;
+
+    pthread_mutex_lock(&pool->ioLatch);
+
+    // Handle of the frame's file stays open while any frame holds one of its pages, even during unregisterPageFile()
+    SM_FileHandle *fHandle = &pool->files[ft->fileIds[frame]].fHandle;
+
+    ensureCapacity(ft->pageNos[frame]+1, fHandle);
+
+    uint64_t start = metricsNow();
+    int success = writeBlock(ft->pageNos[frame], fHandle, ft->frames[frame].pageData);
+    recordLatency(pool->metrics, LATENCY_WRITE_BLOCK, metricsNow() - start);
+
+    if(success != RC_OK) {
+        pthread_mutex_unlock(&pool->ioLatch);
+        printf("Operation Force Page: Could not write page. Page doesn't exist.\n");
+        return RC_WRITE_FAILED;
+    }
+
+    pool->writeCnt++;
+
+    pthread_mutex_unlock(&pool->ioLatch);
+
+    addMetric(pool->metrics, METRIC_WRITES, 1);
+
+    ft->dirtyFlags[frame] = false;
+
+    if(bm->strategy == RS_LRU) {
+        // Update lruPos to most recently used (highest)
+
+        ft->lruPos[frame] = part->lruCounter;
+        part->lruCounter++;
+    }
+
+    printf("Operation Force Page: Page %s at frame %d written to disk.\n", ft->frames[frame].pageData, part->firstFrame + frame);
+    return RC_OK;
+}
+
+// Function to replace page in case of a replacement strategy or in case of pinning to empty frame
+RC replacePage(char *stratName, int frameToEvict, Partition *part, BM_PageHandle *const page, BM_BufferPool *const bm, const PageNumber pageNum) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    FrameTable *ft = part->table;
+
+    // If page to replace is dirty, write it back to disk first
+    if(ft->dirtyFlags[frameToEvict]) {
+        int success = writeFrame(bm, part, frameToEvict);
+        if(success != RC_OK) {
+            printf("%s: Could not write dirty page %d to disk.\n", stratName, ft->pageNos[frameToEvict]);
+            return RC_WRITE_FAILED;
+        }
+
+        addMetric(pool->metrics, METRIC_DIRTY_EVICTIONS, 1);
+    } else if(ft->pageNos[frameToEvict] != NO_PAGE) {
+        addMetric(pool->metrics, METRIC_CLEAN_EVICTIONS, 1);
+    }
+
+    ft->pinCnts[frameToEvict]++;
+
+    beginFrameChange(&ft->frames[frameToEvict]);
+
+    // Evicted page is clean now, so keep a compressed copy of it in the victim cache and check if the new page is there.
+    // Cache is only set up by initBufferPoolWithOptions(), so pools without one never take the I/O latch here
+    bool victimHit = false;
+    if(pool->victimCache != NULL) {
+        pthread_mutex_lock(&pool->ioLatch);
+
+        putVictimPage(pool->victimCache, ft->fileIds[frameToEvict], ft->pageNos[frameToEvict], ft->frames[frameToEvict].pageData);
+        victimHit = takeVictimPage(pool->victimCache, page->fileId, pageNum, ft->frames[frameToEvict].pageData);
+
+        pthread_mutex_unlock(&pool->ioLatch);
+    }
+
+    // The file of the new page was stored in the handle by pinPageInPartition()
+    __atomic_store_n(&ft->fileIds[frameToEvict], page->fileId, __ATOMIC_RELAXED);
+    __atomic_store_n(&ft->pageNos[frameToEvict], pageNum, __ATOMIC_RELAXED);
+    ft->frames[frameToEvict].generation++;
+
+    // Page was evicted earlier and is still in the victim cache. No need to read it from disk
+    if(victimHit) {
+        printf("%s: Page %d restored from victim cache.\n", stratName, pageNum);
+    } else if(part->batch != NULL) {
+        // Batched pin. Page is read together with the other misses of the batch, which also ends the frame change
+        BatchRead *read = &part->batch->reads[part->batch->numReads++];
+        read->part = part;
+        read->frame = frameToEvict;
+        read->pageNo = pageNum;
+    } else {
+        // Page is read by pinPageInPartition() once the replacement strategy is done with the frame, without the
+        // partition latch. Until then pins of the page find the frame and wait for the read
+        InFlightRead *read = (InFlightRead*)malloc(sizeof(InFlightRead));
+        pthread_cond_init(&read->done, NULL);
+        read->finished = false;
+        read->rc = RC_OK;
+        read->numWaiters = 0;
+
+        ft->frames[frameToEvict].read = read;
+        part->startedRead = read;
+    }
+
+    if(victimHit) {
+        endFrameChange(&ft->frames[frameToEvict]);
+    }
 
-    page->data = fr[frameToEvict].pageData;
+    page->data = ft->frames[frameToEvict].pageData;
     page->pageNum = pageNum;
+    setFrameHandle(part, frameToEvict, page);
 
     return RC_OK;
 }
@@ -79,567 +449,3044 @@ RC replacePage(char *stratName, int frameToEvict, Frame *fr, BM_PageHandle *cons
 // Page Replacement Strategy Functions
 
 // Function for FIFO
-RC firstInFirstOutRS(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, Frame *fr) {
-    int min = INT_MAX;
-    int frameToEvict = -1;
-    
+RC firstInFirstOutRS(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, Partition *part) {
+    FrameTable *ft = part->table;
+
     // Determine the first frame in queue with fix count = 0 and smallest queue position
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        if(fr[frame].pinCnt == 0 && fr[frame].fifoPos < min) {
-            min = fr[frame].fifoPos;
-            frameToEvict = frame;
-        }
-    }
+    int frameToEvict = findMinUnpinned(part->victimPins, ft->fifoPos, part->numFrames);
 
     // If all pages are in use by clients, no page can be evicted and hence new page cannot be pinned.
     if(frameToEvict == -1) {
         printf("FIFO: Could not pin page. All Pages are in use.\n");
+        addMetric(((PoolMgmt*) bm->mgmtData)->metrics, METRIC_PIN_FAILURES, 1);
         return RC_WRITE_FAILED;
     }
 
-    int success = replacePage("FIFO", frameToEvict, fr, page, bm, pageNum);
+    int success = replacePage("FIFO", frameToEvict, part, page, bm, pageNum);
     if(success != RC_OK) {
         return success;
     }
 
     // Update queue position of frame to latest (highest)
-    fr[frameToEvict].fifoPos = fifoCounter;
-    fifoCounter++;
-
-    closePageFile(&fHandle);
+    ft->fifoPos[frameToEvict] = part->fifoCounter;
+    part->fifoCounter++;
 
-    printf("FIFO: Page pinned to frame %d.\n", frameToEvict);
+    printf("FIFO: Page pinned to frame %d.\n", part->firstFrame + frameToEvict);
     return RC_OK;
 }
 
 // Function for LRU
-RC leastRecentlyUsedRS(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, Frame *fr) {
-    int min = INT_MAX;
-    int frameToEvict = -1;
-    
+RC leastRecentlyUsedRS(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, Partition *part) {
+    FrameTable *ft = part->table;
+
     // Determine the frame in buffer with fix count = 0 and least recently used
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        if(fr[frame].pinCnt == 0 && fr[frame].lruPos < min) {
-            min = fr[frame].lruPos;
-            frameToEvict = frame;
-        }
-    }
+    int frameToEvict = findMinUnpinned(part->victimPins, ft->lruPos, part->numFrames);
 
     // If all pages are in use by clients, no page can be evicted and hence new page cannot be pinned.
     if(frameToEvict == -1) {
         printf("LRU: Could not pin page. All Pages are in use.\n");
+        addMetric(((PoolMgmt*) bm->mgmtData)->metrics, METRIC_PIN_FAILURES, 1);
         return RC_WRITE_FAILED;
     }
 
-    int success = replacePage("LRU", frameToEvict, fr, page, bm, pageNum);
+    int success = replacePage("LRU", frameToEvict, part, page, bm, pageNum);
     if(success != RC_OK) {
         return success;
     }
-    
-    // Update lruPos to most recently used (highest)
-    fr[frameToEvict].lruPos = lruCounter;
-    lruCounter++;
 
-    closePageFile(&fHandle);
+    // Update lruPos to most recently used (highest)
+    ft->lruPos[frameToEvict] = part->lruCounter;
+    part->lruCounter++;
 
-    printf("LRU: Page pinned to frame %d.\n", frameToEvict);
+    printf("LRU: Page pinned to frame %d.\n", part->firstFrame + frameToEvict);
     return RC_OK;
 }
 
 // Function for LRU-k (LRU-3)
-RC kLeastRecentlyUsedRS(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, Frame *fr) {
-    int min = INT_MAX;
-    int frameToEvict = -1;
-    
+RC kLeastRecentlyUsedRS(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, Partition *part) {
+    FrameTable *ft = part->table;
+
     // Determine the frame in buffer with fix count = 0 and 3rd most recently used
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        if(fr[frame].pinCnt == 0 && fr[frame].lruPos < min) {
-            min = fr[frame].lruPos;
-            frameToEvict = frame;
-        }
-    }
+    int frameToEvict = findMinUnpinned(part->victimPins, ft->lruPos, part->numFrames);
 
     // If all pages are in use by clients, no page can be evicted and hence new page cannot be pinned.
     if(frameToEvict == -1) {
         printf("LRU-K (LRU-3): Could not pin page. All Pages are in use.\n");
+        addMetric(((PoolMgmt*) bm->mgmtData)->metrics, METRIC_PIN_FAILURES, 1);
         return RC_WRITE_FAILED;
     }
 
-    int success = replacePage("LRU-K (LRU-3)", frameToEvict, fr, page, bm, pageNum);
+    int success = replacePage("LRU-K (LRU-3)", frameToEvict, part, page, bm, pageNum);
     if(success != RC_OK) {
         return success;
     }
-    
-    // Update lruPos to most recently used (highest)
-    fr[frameToEvict].lruPos = lruCounter;
-    lruCounter++;
 
-    closePageFile(&fHandle);
+    // Update lruPos to most recently used (highest)
+    ft->lruPos[frameToEvict] = part->lruCounter;
+    part->lruCounter++;
 
-    printf("LRU-K (LRU-3): Page pinned to frame %d.\n", frameToEvict);
+    printf("LRU-K (LRU-3): Page pinned to frame %d.\n", part->firstFrame + frameToEvict);
     return RC_OK;
 }
 
 // Function for Clock
-RC clockRS(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, Frame *fr) {
+RC clockRS(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, Partition *part) {
+    FrameTable *ft = part->table;
     int frameToEvict = -1;
-    int frame = 0; 
-    
-    while(frame < bm->numPages) {
-        if(fr[frame].pinCnt == 0) {
-            break;
-        }
-
-        frame++;
-    }
+    int frame = findValue(part->victimPins, 0, part->numFrames, 0);
 
     // If all pages are in use by clients, no page can be evicted and hence new page cannot be pinned.
-    if(frame == bm->numPages) {
+    if(frame == -1) {
         printf("CLOCK: Could not pin page. All Pages are in use.\n");
+        addMetric(((PoolMgmt*) bm->mgmtData)->metrics, METRIC_PIN_FAILURES, 1);
         return RC_WRITE_FAILED;
     }
 
     // Determine the first frame in buffer with fix count = 0 and no second chance starting from frame least checked by algorithm
-    while(clockCounter < bm->numPages) {
-        if(fr[clockCounter].pinCnt == 0 && !fr[frame].clockChance) {
-            frameToEvict = clockCounter;
+    while(part->clockCounter < part->numFrames) {
+        if(part->victimPins[part->clockCounter] == 0 && !ft->clockChances[frame]) {
+            frameToEvict = part->clockCounter;
             break;
         }
-        
-        if(fr[clockCounter].clockChance) {
-            fr[clockCounter].clockChance = false;
+
+        if(ft->clockChances[part->clockCounter]) {
+            ft->clockChances[part->clockCounter] = false;
         }
 
-        clockCounter = (clockCounter + 1) % bm->numPages;
+        part->clockCounter = (part->clockCounter + 1) % part->numFrames;
     }
 
-    int success = replacePage("CLOCK", frameToEvict, fr, page, bm, pageNum);
+    int success = replacePage("CLOCK", frameToEvict, part, page, bm, pageNum);
     if(success != RC_OK) {
         return success;
     }
 
     // Set newly added page's second chance to true since its hit
-    fr[frameToEvict].clockChance = true;
-
-    closePageFile(&fHandle);
+    ft->clockChances[frameToEvict] = true;
 
-    printf("CLOCK: Page pinned to frame %d.\n", frameToEvict);
+    printf("CLOCK: Page pinned to frame %d.\n", part->firstFrame + frameToEvict);
     return RC_OK;
 }
 
 // Function for LFU
-RC leastFrequentlyUsedRS(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, Frame *fr) {
-    int earliestAdded = INT_MAX;
-    int lowestHitCnt = INT_MAX;
-    int frameToEvict = -1;
-    
+RC leastFrequentlyUsedRS(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, Partition *part) {
+    FrameTable *ft = part->table;
+
     // Determine the frame in buffer with fix count = 0 and lowest hit count OR same lowest hit count and added first
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        if((fr[frame].pinCnt == 0) && (fr[frame].lfuHit < lowestHitCnt || (fr[frame].lfuHit == lowestHitCnt && fr[frame].lfuPos < earliestAdded))) {
-            earliestAdded = fr[frame].lfuPos;
-            lowestHitCnt = fr[frame].lfuHit;
-            frameToEvict = frame;
-        }
-    }
+    int frameToEvict = findMinUnpinnedPair(part->victimPins, ft->lfuHits, ft->lfuPos, part->numFrames);
 
     // If all pages are in use by clients, no page can be evicted and hence new page cannot be pinned.
     if(frameToEvict == -1) {
         printf("LFU: Could not pin page. All Pages are in use.\n");
+        addMetric(((PoolMgmt*) bm->mgmtData)->metrics, METRIC_PIN_FAILURES, 1);
         return RC_WRITE_FAILED;
     }
 
-    int success = replacePage("LFU", frameToEvict, fr, page, bm, pageNum);
+    int success = replacePage("LFU", frameToEvict, part, page, bm, pageNum);
     if(success != RC_OK) {
         return success;
     }
-    
-    // Update lfuPos to most recently added (highest) and set page hit to 1
-    fr[frameToEvict].lfuPos = lfuCounter;
-    lfuCounter++;
 
-    fr[frameToEvict].lfuHit = 1;
+    // Update lfuPos to most recently added (highest) and set page hit to 1
+    ft->lfuPos[frameToEvict] = part->lfuCounter;
+    part->lfuCounter++;
 
-    closePageFile(&fHandle);
+    ft->lfuHits[frameToEvict] = 1;
 
-    printf("LFU: Page pinned to frame %d.\n", frameToEvict);
+    printf("LFU: Page pinned to frame %d.\n", part->firstFrame + frameToEvict);
     return RC_OK;
 }
 
-// Buffer Manager Interface Pool Handling
-
-// Function to Initialize buffer pool with default values and allocate memory
-RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName, const int numPages, ReplacementStrategy strategy, void *stratData) {
-    fHandle = (SM_FileHandle*)malloc(sizeof(SM_FileHandle));
-    
-    int success = openPageFile((char*) pageFileName, &fHandle);
-
-    // If file doesn't exist
-    if(success != RC_OK) {
-        printf("Could not open file. File doesn't exist.\n");
-        return RC_FILE_NOT_FOUND;
+// Waiting for Frames
+
+// Function to give a frame whose fix count just dropped to 0 to the thread which waited longest for a frame of the
+// partition. The frame stays pinned once for that thread, so no other pin can take it first. Returns false if no
+// thread is waiting. Expects the partition latch to be held
+static bool handOffFrame(Partition *part, int frame) {
+    for(PinWaiter *waiter = part->waiters; waiter != NULL; waiter = waiter->next) {
+        if(waiter->frame == -1) {
+            part->table->pinCnts[frame]++;
+            waiter->frame = frame;
+            pthread_cond_signal(&waiter->wake);
+            return true;
+        }
     }
 
-    closePageFile(&fHandle);
-
-    Frame *fr = (Frame*)malloc(sizeof(Frame) * numPages);
+    return false;
+}
 
-    // Initialize Page Frames
-    for(int frame = 0; frame < numPages; frame++) {
-        fr[frame].pinCnt = 0;
-        fr[frame].isDirty = false;
-        fr[frame].pageNo = NO_PAGE;
-        fr[frame].pageData = (char*)malloc(PAGE_SIZE);
-        fr[frame].lruPos = INT_MAX;
-        fr[frame].fifoPos = INT_MAX;
-        fr[frame].lfuPos = INT_MAX;
-        fr[frame].lfuHit = 0;
-        fr[frame].clockChance = false;
+// Function to wait until another thread hands a frame of the partition over, at most waitMillis milliseconds (-1 waits
+// without limit). Returns the frame, pinned once for the caller, or -1 on timeout. Expects the partition latch to be
+// held, which is released while waiting
+static int waitForFrame(Partition *part, int waitMillis) {
+    PinWaiter self;
+    pthread_condattr_t attr;
+    struct timespec deadline;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&self.wake, &attr);
+    pthread_condattr_destroy(&attr);
+
+    self.frame = -1;
+    self.next = NULL;
+
+    // Waiters are queued at the end, so frames go to them in the order they started waiting
+    PinWaiter **tail = &part->waiters;
+    while(*tail != NULL) {
+        tail = &(*tail)->next;
+    }
+    *tail = &self;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += waitMillis / 1000;
+    deadline.tv_nsec += (long) (waitMillis % 1000) * 1000000;
+    if(deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
     }
 
-    // Initialize Buffer
-    bm->pageFile = (char*) pageFileName;
-    bm->numPages = numPages;
-    bm->strategy = strategy;
-    bm->mgmtData = fr;
+    // A frame handed over while the wait times out is still taken
+    while(self.frame == -1) {
+        if(waitMillis < 0) {
+            pthread_cond_wait(&self.wake, &part->latch);
+        } else if(pthread_cond_timedwait(&self.wake, &part->latch, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
 
-    // Initialize buffer stat variables
-    readCnt = 0;
-    writeCnt = 0;
-    fifoCounter = 0;
-    lruCounter = 0;
-    lfuCounter = 0;
-    clockCounter = 0;
+    PinWaiter **link = &part->waiters;
+    while(*link != &self) {
+        link = &(*link)->next;
+    }
+    *link = self.next;
 
-    printf("Buffer Pool Initialized.\n");
-    return RC_OK;
+    pthread_cond_destroy(&self.wake);
+    return self.frame;
 }
 
-// Function to De-allocate memory and shut down the buffer pool
-RC shutdownBufferPool(BM_BufferPool *const bm) {
-    Frame *fr = (Frame*) bm->mgmtData;
-
-    // Check if all pages have fix count = 0
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        if(fr[frame].pinCnt > 0) {
-            printf("Operation Shut Down: Cannot shut down buffer pool. There are page(s) still in use.\n");
-            return RC_IM_KEY_ALREADY_EXISTS;
+// Function to fix the frame numbers of threads which were handed a frame but didn't wake up yet, when a resize moves
+// frames to other positions
+static void moveHandedFrame(Partition *part, int from, int to) {
+    for(PinWaiter *waiter = part->waiters; waiter != NULL; waiter = waiter->next) {
+        if(waiter->frame == from) {
+            waiter->frame = to;
         }
     }
+}
 
-    // Write all dirty pages to disk
-    int success = forceFlushPool(bm);
-    if(success != RC_OK) {
-        printf("Operation Shut Down: Could not write all dirty pages to disk.\n");
-        return RC_WRITE_FAILED;
-    }
+// Reads in Flight
 
-    // Free memory allocated to store page data in each frame
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        free(fr[frame].pageData);
+// Function to wait until the read another pin started for a page is done. The waiting pin already holds the frame, so
+// it can't be evicted meanwhile. Returns the result of the read. Expects the partition latch to be held, which is
+// released while waiting
+static RC waitForRead(Partition *part, BM_PageHandle *const page, InFlightRead *read) {
+    while(!read->finished) {
+        pthread_cond_wait(&read->done, &part->latch);
     }
 
-    // Free memory allocated to frames
-    free(fr);
-
-    // Set buffer pool fields to NULL and 0
-    bm->pageFile = NULL;
-    bm->numPages = 0;
-    bm->mgmtData = NULL;
-
-    printf("Operation Shut Down: Successfully shut down buffer pool.\n");
-    return RC_OK;
-}
-
-// Function to Write all dirty pages to disk
-RC forceFlushPool(BM_BufferPool *const bm) {
-    Frame *fr = (Frame*) bm->mgmtData;
-    
+    RC rc = read->rc;
 
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        // If page fix count = 0 and page is dirty, call force page to write page to disk
-        if(fr[frame].pinCnt == 0 && fr[frame].isDirty) {
-            BM_PageHandle *const page = (BM_PageHandle*)malloc(sizeof(BM_PageHandle));
-
-            page->data = fr[frame].pageData;
-            page->pageNum = fr[frame].pageNo;
+    read->numWaiters--;
+    if(read->numWaiters == 0) {
+        pthread_cond_destroy(&read->done);
+        free(read);
+    }
 
-            int success = forcePage(bm, page);
-            if(success != RC_OK) {
-                printf("Operation Flush Pool: Could not write dirty page %d to disk.\n", page->pageNum);
-                return RC_WRITE_FAILED;
-            }
-        }
+    // Frame may have moved while waiting
+    if(rc == RC_OK) {
+        setFrameHandle(part, findFrame(part, page->fileId, page->pageNum), page);
     }
 
-    printf("Operation Flush Pool: All dirty pages written to disk.\n");
-    return RC_OK;
+    return rc;
 }
 
-// Buffer Manager Interface Access Pages
+// Function to do the read replacePage() set up for the pin holding the latch. The partition latch is released during
+// the read, so other pages of the partition can be pinned meanwhile. If the read fails the frame is emptied and every
+// pin waiting for the read gets the error. Expects the partition latch to be held
+static RC finishStartedRead(BM_BufferPool *const bm, Partition *part, BM_PageHandle *const page) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    InFlightRead *read = part->startedRead;
+    SM_FileHandle *fHandle;
 
-// Function to mark all pages dirty
-RC markDirty (BM_BufferPool *const bm, BM_PageHandle *const page) {
-    Frame *fr = (Frame*) bm->mgmtData;
-
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        // Find frame which contains page to mark as dirty
-        if(fr[frame].pageNo == page->pageNum) {
-            // If page is already dirty, write it to disk and read the updated page to make the buffer thread-safe
-            if(fr[frame].isDirty) {
-                int success = forcePage(bm, page);
-                if(success != RC_OK) {
-                    printf("Operation Dirty: Could not write dirty page %d to disk.\n", page->pageNum);
-                    return RC_WRITE_FAILED;
-                }
+    part->startedRead = NULL;
 
-                fHandle = (SM_FileHandle*)malloc(sizeof(SM_FileHandle));
+    int frame = lookupFrame(part, page, page->fileId, page->pageNum);
+    RC rc = prepareFrameRead("Operation Pin", pool, part, frame, page->pageNum, &fHandle);
 
-                success = openPageFile(bm->pageFile, &fHandle);
-                if(success != RC_OK) {
-                    printf("Operation Dirty: Could not open file. File doesn't exist.\n");
-                    return RC_FILE_NOT_FOUND;
-                }
+    if(rc == RC_OK) {
+        pthread_mutex_unlock(&part->latch);
+        rc = readFrameData("Operation Pin", pool, fHandle, page->pageNum, page->data);
+        pthread_mutex_lock(&part->latch);
+    }
 
-                ensureCapacity(page->pageNum+1, &fHandle);
-                success = readBlock(page->pageNum, &fHandle, fr[frame].pageData);
+    // A resize may have moved the frame meanwhile. It is pinned, so it still holds the page
+    FrameTable *ft = part->table;
+    frame = findFrame(part, page->fileId, page->pageNum);
+    ft->frames[frame].read = NULL;
+
+    if(rc == RC_OK) {
+        setFrameHandle(part, frame, page);
+        endFrameChange(&ft->frames[frame]);
+    } else {
+        ft->pinCnts[frame] -= 1 + read->numWaiters;
+        __atomic_store_n(&ft->pageNos[frame], NO_PAGE, __ATOMIC_RELAXED);
+        ft->frames[frame].generation++;
+        endFrameChange(&ft->frames[frame]);
+
+        handOffFrame(part, frame);
+    }
 
-                if(success != RC_OK) {
-                    printf("Operation Dirty: Could not read page. Page doesn't exist.\n");
-                    closePageFile(&fHandle);
-                    return RC_READ_NON_EXISTING_PAGE;
-                }
+    read->rc = rc;
+    read->finished = true;
 
-                closePageFile(&fHandle);
+    if(read->numWaiters == 0) {
+        pthread_cond_destroy(&read->done);
+        free(read);
+    } else {
+        pthread_cond_broadcast(&read->done);
+    }
 
-                readCnt++;
-            }
+    return rc;
+}
 
-            fr[frame].isDirty = true;
+// Partition Handling
 
-            if(bm->strategy == RS_LRU) {
-                // Update lruPos to most recently used (highest)
+static size_t alignToCacheLine(size_t size) {
+    return (size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+}
 
-                fr[frame].lruPos = lruCounter;
-                lruCounter++;
-            }
-            
-            printf("Operation Dirty: Page %d at frame %d marked as dirty.\n", page->pageNum, frame);
-            return RC_OK;
-        }
-    }
+// Function to get the memory needed for a frame table with capacity frames
+static size_t frameTableSize(int capacity) {
+    return alignToCacheLine(sizeof(FrameTable)) + alignToCacheLine(sizeof(Frame) * capacity)
+            + 10 * alignToCacheLine(sizeof(int) * capacity) + 2 * alignToCacheLine(sizeof(bool) * capacity);
+}
 
-    printf("Operation Dirty: Page %d does not exist.\n", page->pageNum);
-    return RC_READ_NON_EXISTING_PAGE;
+// Function to take the next cache line aligned piece of size bytes from a frame table's memory
+static void *carveTable(char **cursor, size_t size) {
+    void *piece = *cursor;
+    *cursor += alignToCacheLine(size);
+    return piece;
 }
 
-// Function to unpin page from frame
-RC unpinPage (BM_BufferPool *const bm, BM_PageHandle *const page) {
-    Frame *fr = (Frame*) bm->mgmtData;
+// Function to lay out a frame table with capacity frames in cache line aligned memory of frameTableSize() bytes
+static FrameTable *layoutFrameTable(char *mem, int capacity) {
+    FrameTable *ft = (FrameTable*) carveTable(&mem, sizeof(FrameTable));
+
+    ft->pageNos = (PageNumber*) carveTable(&mem, sizeof(PageNumber) * capacity);
+    ft->fileIds = (int*) carveTable(&mem, sizeof(int) * capacity);
+    ft->pinCnts = (int*) carveTable(&mem, sizeof(int) * capacity);
+    ft->dirtyFlags = (bool*) carveTable(&mem, sizeof(bool) * capacity);
+    ft->lruPos = (int*) carveTable(&mem, sizeof(int) * capacity);
+    ft->fifoPos = (int*) carveTable(&mem, sizeof(int) * capacity);
+    ft->lfuPos = (int*) carveTable(&mem, sizeof(int) * capacity);
+    ft->lfuHits = (int*) carveTable(&mem, sizeof(int) * capacity);
+    ft->clockChances = (bool*) carveTable(&mem, sizeof(bool) * capacity);
+    ft->owners = (int*) carveTable(&mem, sizeof(int) * capacity);
+    ft->priorities = (int*) carveTable(&mem, sizeof(int) * capacity);
+    ft->victimPins = (int*) carveTable(&mem, sizeof(int) * capacity);
+    ft->frames = (Frame*) carveTable(&mem, sizeof(Frame) * capacity);
+
+    return ft;
+}
 
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        // Decrease fix count by 1
-        if(fr[frame].pageNo == page->pageNum) {
-            fr[frame].pinCnt--;
+// Function to set up an empty frame using the given page data
+static void initFrame(FrameTable *ft, int frame, char *pageData, unsigned int version) {
+    ft->pinCnts[frame] = 0;
+    ft->dirtyFlags[frame] = false;
+    ft->fileIds[frame] = MAIN_FILE_ID;
+    ft->pageNos[frame] = NO_PAGE;
+    ft->lruPos[frame] = INT_MAX;
+    ft->fifoPos[frame] = INT_MAX;
+    ft->lfuPos[frame] = INT_MAX;
+    ft->lfuHits[frame] = 0;
+    ft->clockChances[frame] = false;
+    ft->owners[frame] = DEFAULT_TENANT;
+    ft->priorities[frame] = PRIORITY_NORMAL;
+    ft->frames[frame].pageData = pageData;
+    ft->frames[frame].version = version;
+    ft->frames[frame].generation = 0;
+    ft->frames[frame].read = NULL;
+    ft->frames[frame].shadow = NULL;
+    ft->frames[frame].updatePins = 0;
+    ft->frames[frame].shadowDirty = false;
+    ft->frames[frame].oldVersions = NULL;
+}
 
-            if(bm->strategy == RS_LRU) {
-                // Update lruPos to most recently used (highest)
+// Function to copy all fields of a frame to a frame of another table
+static void copyFrame(FrameTable *to, int toFrame, FrameTable *from, int fromFrame) {
+    to->pinCnts[toFrame] = from->pinCnts[fromFrame];
+    to->dirtyFlags[toFrame] = from->dirtyFlags[fromFrame];
+    to->fileIds[toFrame] = from->fileIds[fromFrame];
+    to->pageNos[toFrame] = from->pageNos[fromFrame];
+    to->lruPos[toFrame] = from->lruPos[fromFrame];
+    to->fifoPos[toFrame] = from->fifoPos[fromFrame];
+    to->lfuPos[toFrame] = from->lfuPos[fromFrame];
+    to->lfuHits[toFrame] = from->lfuHits[fromFrame];
+    to->clockChances[toFrame] = from->clockChances[fromFrame];
+    to->owners[toFrame] = from->owners[fromFrame];
+    to->priorities[toFrame] = from->priorities[fromFrame];
+    to->frames[toFrame] = from->frames[fromFrame];
+}
 
-                fr[frame].lruPos = lruCounter;
-                lruCounter++;
-            }
+// Function to allocate a partition on the given NUMA node. The partition struct and frames get one arena and the page
+// data another, so scans of the frames don't share cache lines or TLB entries with page data
+static Partition *createPartition(int numFrames, int firstFrame, int numaNode, int arenaFlags) {
+    size_t tableOffset = alignToCacheLine(sizeof(Partition));
+    size_t arenaSize = tableOffset + frameTableSize(numFrames);
+    size_t dataArenaSize = (size_t) PAGE_SIZE * numFrames;
 
-            printf("Operation Unpin: Page %d unpinned from frame %d.\n", page->pageNum, frame);
-            return RC_OK;
-        }
+    char *arena = (char*) allocFrameArena(arenaSize, numaNode, arenaFlags & ARENA_LOCKED);
+    if(arena == NULL) {
+        return NULL;
     }
 
-    printf("Operation Unpin: Page %d does not exist in the buffer.\n", page->pageNum);
-    return RC_READ_NON_EXISTING_PAGE;
-}
+    char *dataArena = (char*) allocFrameArena(dataArenaSize, numaNode, arenaFlags);
+    if(dataArena == NULL) {
+        freeFrameArena(arena, arenaSize, arenaFlags & ARENA_LOCKED);
+        return NULL;
+    }
 
-// Function to write a specific dirty page to disk
-RC forcePage (BM_BufferPool *const bm, BM_PageHandle *const page) {
-    Frame *fr = (Frame*) bm->mgmtData;
+    Partition *part = (Partition*) arena;
+    FrameTable *ft = layoutFrameTable(arena + tableOffset, numFrames);
 
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        // Find frame which contains page to write to disk and if it is dirty
-        if(fr[frame].pageNo == page->pageNum && fr[frame].isDirty) {
-            fHandle = (SM_FileHandle*)malloc(sizeof(SM_FileHandle));
+    // Initialize Page Frames
+    for(int frame = 0; frame < numFrames; frame++) {
+        initFrame(ft, frame, dataArena + (size_t) PAGE_SIZE * frame, 0);
+    }
 
-            int success = openPageFile(bm->pageFile, &fHandle);
-            if(success != RC_OK) {
-                printf("Operation Force Page: Could not open file. File doesn't exist.\n");
-                return RC_FILE_NOT_FOUND;
-            }
+    pthread_mutex_init(&part->latch, NULL);
+    part->batch = NULL;
+    part->table = ft;
+    part->numFrames = numFrames;
+    part->frameCapacity = numFrames;
+    part->spareTable = NULL;
+    part->spareCapacity = 0;
+    part->tableSeq = 0;
+    part->firstFrame = firstFrame;
+    part->numaNode = numaNode;
+    part->arenaFlags = arenaFlags;
+    part->arenaSize = arenaSize;
+    part->dataArena = dataArena;
+    part->dataArenaSize = dataArenaSize;
+    part->extraArenas = NULL;
+    part->freeSlots = NULL;
+    part->freeSlotVersions = NULL;
+    part->numFreeSlots = 0;
+    part->freeSlotCapacity = 0;
+    part->lruCounter = 0;
+    part->fifoCounter = 0;
+    part->lfuCounter = 0;
+    part->clockCounter = 0;
+    part->waiters = NULL;
+    part->startedRead = NULL;
+    part->victimPins = ft->pinCnts;
+    part->coldCounter = 0;
+
+    return part;
+}
 
-            ensureCapacity(page->pageNum+1, &fHandle);
-            success = writeBlock(fr[frame].pageNo, &fHandle, fr[frame].pageData);
+static void destroyPartition(Partition *part) {
+    while(part->extraArenas != NULL) {
+        ExtraArena *extra = part->extraArenas;
+        part->extraArenas = extra->next;
 
-            if(success != RC_OK) {
-                printf("Operation Force Page: Could not write page. Page doesn't exist.\n");
-                closePageFile(&fHandle);
-                return RC_WRITE_FAILED;
-            }
+        freeFrameArena(extra->arena, extra->size, extra->flags);
+        free(extra);
+    }
 
-            closePageFile(&fHandle);
+    free(part->freeSlots);
+    free(part->freeSlotVersions);
 
-            writeCnt++;
+    pthread_mutex_destroy(&part->latch);
+    freeFrameArena(part->dataArena, part->dataArenaSize, part->arenaFlags);
+    freeFrameArena(part, part->arenaSize, part->arenaFlags & ARENA_LOCKED);
+}
 
-            fr[frame].isDirty = false;
+// Function to free the pool's bookkeeping and close its files. Returns the first error of closing a file, which
+// means pages only its tier had could not be written to it
+static RC destroyPoolMgmt(PoolMgmt *pool) {
+    RC rc = RC_OK;
 
-            if(bm->strategy == RS_LRU) {
-                // Update lruPos to most recently used (highest)
+    for(int p = 0; p < pool->numParts; p++) {
+        if(pool->parts[p] != NULL) {
+            destroyPartition(pool->parts[p]);
+        }
+    }
 
-                fr[frame].lruPos = lruCounter;
-                lruCounter++;
+    for(int fileId = 0; fileId < MAX_POOL_FILES; fileId++) {
+        if(pool->files[fileId].isOpen) {
+            RC closed = closePageFile(&pool->files[fileId].fHandle);
+            if(rc == RC_OK) {
+                rc = closed;
             }
-            
-            printf("Operation Force Page: Page %s at frame %d written to disk.\n", page->data, frame);
-            return RC_OK;
         }
+        free(pool->files[fileId].fileName);
     }
-
-    printf("Operation Force Page: Page %d does not exist or is not dirty.\n", page->pageNum);
-    return RC_WRITE_FAILED;
+    free(pool->files);
+
+    destroyVictimCache(pool->victimCache);
+    destroyPoolMetrics(pool->metrics);
+    destroyPageTrace(pool->trace);
+    destroyMrcSampler(pool->mrc);
+    destroyPinTracker(pool->pins);
+    destroyTenantQuotas(pool->tenants);
+    free(pool->warmStartFile);
+    pthread_mutex_destroy(&pool->ioLatch);
+    pthread_mutex_destroy(&pool->warmLatch);
+    pthread_cond_destroy(&pool->warmWake);
+
+    free(pool->parts);
+    free(pool);
+
+    return rc;
 }
 
-// Function to pin page to frame. Done either directly or through a page replacement strategy
-RC pinPage (BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum) {
-    Frame *fr = (Frame*) bm->mgmtData;
-
-    // Check if page is already pinned to a frame
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        // If it is, inecrease fix count by 1
-        if(fr[frame].pageNo == pageNum) {
-            fr[frame].pinCnt++;
-
-            page->data = fr->pageData;
-            page->pageNum = pageNum;
-
-            printf("LRU: %d, FIFO: %d", lruCounter, fifoCounter);
-            if(bm->strategy == RS_LRU) {
-                // Update lruPos to most recently used (highest)
-                fr[frame].lruPos = lruCounter;
-                lruCounter++;
-            } else if(bm->strategy == RS_LFU) {
-                // Increment lfuHit
-                fr[frame].lfuHit++;
-            } else if(bm->strategy == RS_CLOCK) {
-                // Page is hit, so set second chance to true
-                fr[frame].clockChance = true;
-            }
-            
-            bm->mgmtData = fr;
-
-            printf("Page is already pinned to frame %d. Increased pin count to %d.\n", frame, fr[frame].pinCnt);
-            return RC_OK;
-        }
-    }
-
-    // If page is not pinned to any frame
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        // If there is an empty frame (Meaning buffer is not full). Pin page to 1st unpinned frame
-        if(fr[frame].pageNo == NO_PAGE) {
-            // This function contains same logic as page pinning just an extra dirty check condition which will be false for empty frame
-            // So used this function to reduce Lines Of Code
-            replacePage("Operation Pin", frame, fr, page, bm, pageNum);
-
-            if(bm->strategy == RS_LRU) {
-                // Update lruPos to most recently used (highest)
-                fr[frame].lruPos = lruCounter;
-                lruCounter++;
-            } else if(bm->strategy == RS_FIFO) {
-                // Update queue position of frame to latest (highest)
-                fr[frame].fifoPos = fifoCounter;
-                fifoCounter++;
-            } else if(bm->strategy == RS_LFU) {
-                // Update lfuPos to most recently added (highest) and increment lfuHit
-                fr[frame].lfuPos = lfuCounter;
-                lfuCounter++;
-
-                fr[frame].lfuHit++;
-            }  else if(bm->strategy == RS_CLOCK) {
-                // Page is hit, so set second chance to true
-                fr[frame].clockChance = true;
-            }
+static RC writePoolHotPages(BM_BufferPool *const bm, const char *fileName);
 
-            bm->mgmtData = fr;
+// Function run by the saver thread. Writes the hot page file every warmSaveSeconds until the pool shuts down
+static void *runHotPageSaver(void *arg) {
+    BM_BufferPool *bm = (BM_BufferPool*) arg;
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
 
-            closePageFile(&fHandle);
+    pthread_mutex_lock(&pool->warmLatch);
 
-            printf("Operation Pin: Buffer is not full. Page %d pinned to frame %d.\n", pageNum, frame);
-            
-            return RC_OK;
+    while(!pool->stopSaver) {
+        struct timespec wake;
+        clock_gettime(CLOCK_REALTIME, &wake);
+        wake.tv_sec += pool->warmSaveSeconds;
+
+        if(pthread_cond_timedwait(&pool->warmWake, &pool->warmLatch, &wake) == ETIMEDOUT && !pool->stopSaver) {
+            writePoolHotPages(bm, pool->warmStartFile);
         }
     }
 
-    // Buffer is full. Implement page replacement strategy
-    switch(bm->strategy) {
-        case RS_FIFO:
-            return firstInFirstOutRS(bm, page, pageNum, fr);
-	
-        case RS_LRU:
-            return leastRecentlyUsedRS(bm, page, pageNum, fr);
-
-	    case RS_CLOCK:
-            return clockRS(bm, page, pageNum, fr);
-
-	    case RS_LFU:
-            return leastFrequentlyUsedRS(bm, page, pageNum, fr);
-
-	    case RS_LRU_K:
-            return kLeastRecentlyUsedRS(bm, page, pageNum, fr);
+    pthread_mutex_unlock(&pool->warmLatch);
+    return NULL;
+}
 
-        default:
-            printf("Page Replacement Strategy doesn't exist.\n");
-            return RC_IM_KEY_NOT_FOUND;
+// Function to stop the saver thread. Waits for a save in progress to finish
+static void stopHotPageSaver(PoolMgmt *pool) {
+    if(!pool->saverRunning) {
+        return;
     }
-}
 
-// Statistics Interface
+    pthread_mutex_lock(&pool->warmLatch);
+    pool->stopSaver = true;
+    pthread_cond_signal(&pool->warmWake);
+    pthread_mutex_unlock(&pool->warmLatch);
 
-// Funtion to Get page numbers pinned to each frame
-PageNumber *getFrameContents (BM_BufferPool *const bm) {
-    PageNumber *pageNos = (PageNumber*)malloc(sizeof(PageNumber)*bm->numPages);
-    Frame *fr = (Frame*) bm->mgmtData;
+    pthread_join(pool->saver, NULL);
+    pool->saverRunning = false;
+}
 
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        pageNos[frame] = fr[frame].pageNo;
-    }
+// Buffer Manager Interface Pool Handling
 
-    return pageNos;
+// Function to set pool options to their defaults (all optional features disabled)
+void initPoolOptions(BM_PoolOptions *const opts) {
+    opts->victimCacheBytes = 0;
+    opts->numPartitions = 1;
+    opts->traceRecords = 0;
+    opts->mrcSampledPages = 0;
+    opts->warmStartFile = NULL;
+    opts->warmSaveSeconds = 0;
+    opts->hugePages = HUGE_PAGES_NONE;
+    opts->lockMemory = false;
+    opts->pinWaitMillis = 0;
+    opts->trackPins = false;
+    opts->maxPinsPerClient = 0;
+    opts->readAheadPages = 8;
+    opts->sharedName = NULL;
+    opts->tierFileName = NULL;
+    opts->tierPages = 0;
+    opts->tierWriteBack = false;
 }
 
-// Funtion to Get dirty flags of pages pinned to each frame
-bool *getDirtyFlags (BM_BufferPool *const bm) {
-    bool *dirtyFlags = (bool*)malloc(sizeof(bool)*bm->numPages);
-    Frame *fr = (Frame*) bm->mgmtData;
+// Function to Initialize buffer pool with default values and allocate memory
+RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName, const int numPages, ReplacementStrategy strategy, void *stratData) {
+    return initBufferPoolWithOptions(bm, pageFileName, numPages, strategy, stratData, NULL);
+}
 
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        dirtyFlags[frame] = fr[frame].isDirty;
+// Function to refuse an operation pools in shared memory don't have
+static bool isSharedPool(BM_BufferPool *const bm, const char *opName) {
+    if(((PoolMgmt*) bm->mgmtData)->shared == NULL) {
+        return false;
     }
 
-    return dirtyFlags;
+    printf("%s: Not available for pools in shared memory.\n", opName);
+    return true;
 }
 
-// Funtion to Get fix counts of pages pinned to each frame
-int *getFixCounts (BM_BufferPool *const bm) {
-    int *pinCnts = (PageNumber*)malloc(sizeof(int)*bm->numPages);
-    Frame *fr = (Frame*) bm->mgmtData;
+// Function to create or attach to a pool in shared memory. Each process keeps a PoolMgmt of its own without partitions,
+// so pin tracking still works per process
+static RC initSharedBufferPool(BM_BufferPool *const bm, const char *const pageFileName, const int numPages, ReplacementStrategy strategy, const BM_PoolOptions *options) {
+    SharedPool *shared;
 
-    for(int frame = 0; frame < bm->numPages; frame++) {
-        pinCnts[frame] = fr[frame].pinCnt;
+    RC rc = attachSharedPool(options->sharedName, pageFileName, numPages, strategy, &shared);
+    if(rc != RC_OK) {
+        return rc;
     }
 
-    return pinCnts;
-}
+    PoolMgmt *pool = (PoolMgmt*)calloc(1, sizeof(PoolMgmt));
+    pool->files = (PoolFile*)calloc(MAX_POOL_FILES, sizeof(PoolFile));
+    pthread_mutex_init(&pool->ioLatch, NULL);
+    pthread_mutex_init(&pool->warmLatch, NULL);
+    pthread_cond_init(&pool->warmWake, NULL);
+    pool->metrics = createPoolMetrics();
+    pool->shared = shared;
 
-// Funtion to Get count of how many times page read has been done from disk
+    if(options->trackPins || options->maxPinsPerClient > 0) {
+        pool->pins = createPinTracker(options->maxPinsPerClient);
+    }
+
+    bm->pageFile = (char*) pageFileName;
+    bm->numPages = numPages;
+    bm->strategy = strategy;
+    bm->mgmtData = pool;
+
+    printf("Buffer pool uses shared memory '%s'.\n", options->sharedName);
+    return RC_OK;
+}
+
+// Function to Initialize buffer pool with optional features enabled through opts (NULL means defaults)
+RC initBufferPoolWithOptions(BM_BufferPool *const bm, const char *const pageFileName, const int numPages, ReplacementStrategy strategy, void *stratData, const BM_PoolOptions *const opts) {
+    BM_PoolOptions options;
+    SM_FileHandle fHandle;
+
+    if(opts != NULL) {
+        options = *opts;
+    } else {
+        initPoolOptions(&options);
+    }
+
+    // Frame searches use the widest vector instructions this CPU has
+    initFrameSearch();
+
+    if(options.sharedName != NULL) {
+        return initSharedBufferPool(bm, pageFileName, numPages, strategy, &options);
+    }
+
+    int success = openPageFile((char*) pageFileName, &fHandle);
+
+    // If file doesn't exist
+    if(success != RC_OK) {
+        printf("Could not open file. File doesn't exist.\n");
+        return RC_FILE_NOT_FOUND;
+    }
+
+    // Misses of the pool check the local tier before the page file
+    if(options.tierFileName != NULL) {
+        success = attachPageTier(&fHandle, (char*) options.tierFileName, options.tierPages,
+                options.tierWriteBack ? TIER_WRITE_BACK : TIER_WRITE_THROUGH);
+        if(success != RC_OK) {
+            closePageFile(&fHandle);
+            return success;
+        }
+    }
+
+    // Frames are split into one partition per NUMA node if asked for. Memory is only bound when there is more than one node
+    int numNodes = getNumNumaNodes();
+    int numParts = options.numPartitions > 0 ? options.numPartitions : numNodes;
+    if(numParts > numPages) {
+        numParts = numPages > 0 ? numPages : 1;
+    }
+
+    // Huge pages and locking only apply to frame memory, not to the pool's other bookkeeping
+    int arenaFlags = options.lockMemory ? ARENA_LOCKED : 0;
+    if(options.hugePages == HUGE_PAGES_TRANSPARENT) {
+        arenaFlags |= ARENA_TRANSPARENT_HUGE;
+    } else if(options.hugePages == HUGE_PAGES_EXPLICIT) {
+        arenaFlags |= ARENA_EXPLICIT_HUGE;
+    }
+
+    PoolMgmt *pool = (PoolMgmt*)malloc(sizeof(PoolMgmt));
+    pool->parts = (Partition**)calloc(numParts, sizeof(Partition*));
+    pool->numParts = numParts;
+
+    // Pool's own page file is the first registered file and stays open until shutdown
+    pool->files = (PoolFile*)calloc(MAX_POOL_FILES, sizeof(PoolFile));
+    pool->files[MAIN_FILE_ID].isOpen = true;
+    pool->files[MAIN_FILE_ID].isRegistered = true;
+    pool->files[MAIN_FILE_ID].fileName = strdup(pageFileName);
+    pool->files[MAIN_FILE_ID].fHandle = fHandle;
+    pthread_mutex_init(&pool->ioLatch, NULL);
+    pool->pinWaitMillis = options.pinWaitMillis;
+    pool->readAheadPages = options.readAheadPages;
+    pool->victimCache = NULL;
+    pool->metrics = createPoolMetrics();
+    pool->trace = NULL;
+    pool->mrc = NULL;
+    pool->pins = NULL;
+    pool->tenants = createTenantQuotas();
+    pool->tenantRules = false;
+    pool->shared = NULL;
+    pool->warmStartFile = NULL;
+    pool->warmSaveSeconds = 0;
+    pool->saverRunning = false;
+    pool->stopSaver = false;
+    pthread_mutex_init(&pool->warmLatch, NULL);
+    pthread_cond_init(&pool->warmWake, NULL);
+
+    int firstFrame = 0;
+    for(int p = 0; p < numParts; p++) {
+        int numFrames = numPages / numParts + (p < numPages % numParts ? 1 : 0);
+        int numaNode = (numParts > 1 && numNodes > 1) ? p % numNodes : NO_NUMA_NODE;
+
+        pool->parts[p] = createPartition(numFrames, firstFrame, numaNode, arenaFlags);
+        if(pool->parts[p] == NULL) {
+            printf("Could not allocate frames for partition %d.\n", p);
+            destroyPoolMgmt(pool);
+            return RC_OUT_OF_MEMORY;
+        }
+
+        firstFrame += numFrames;
+    }
+
+    // Initialize buffer stat variables
+    pool->readCnt = 0;
+    pool->writeCnt = 0;
+
+    if(arenaFlags != 0) {
+        printf("Frame memory uses %s pages%s.\n", options.hugePages == HUGE_PAGES_NONE ? "normal" : "huge",
+                options.lockMemory ? " locked in memory" : "");
+    }
+
+    // Second tier cache for evicted pages
+    if(options.victimCacheBytes > 0) {
+        pool->victimCache = createVictimCache(options.victimCacheBytes);
+        printf("Victim cache enabled with %d bytes.\n", options.victimCacheBytes);
+    }
+
+    // Ring buffer recording page accesses
+    if(options.traceRecords > 0) {
+        pool->trace = createPageTrace(options.traceRecords);
+        printf("Page access tracing enabled for %d records.\n", options.traceRecords);
+    }
+
+    // Sampled reuse distances for the miss ratio curve
+    if(options.mrcSampledPages > 0) {
+        pool->mrc = createMrcSampler(options.mrcSampledPages, numPages);
+        if(pool->mrc != NULL) {
+            printf("Miss ratio curve estimation enabled with %d sampled pages.\n", options.mrcSampledPages);
+        } else {
+            printf("Miss ratio curve estimation could not be enabled. Not enough memory for %d sampled pages.\n", options.mrcSampledPages);
+        }
+    }
+
+    // Pins held by each client
+    if(options.trackPins || options.maxPinsPerClient > 0) {
+        pool->pins = createPinTracker(options.maxPinsPerClient);
+        if(options.maxPinsPerClient > 0) {
+            printf("Pin tracking enabled with at most %d pins per client.\n", options.maxPinsPerClient);
+        } else {
+            printf("Pin tracking enabled.\n");
+        }
+    }
+
+    // Initialize Buffer
+    bm->pageFile = (char*) pageFileName;
+    bm->numPages = numPages;
+    bm->strategy = strategy;
+    bm->mgmtData = pool;
+
+    if(numParts > 1) {
+        printf("Buffer pool split into %d partitions over %d NUMA node(s).\n", numParts, numNodes);
+    }
+
+    // Pages resident at the last shutdown are read back before the pool is used. A missing file just means a cold start
+    if(options.warmStartFile != NULL) {
+        pool->warmStartFile = strdup(options.warmStartFile);
+        pool->warmSaveSeconds = options.warmSaveSeconds;
+
+        if(loadHotPages(bm, pool->warmStartFile) != RC_OK) {
+            printf("Warm start: No pages reloaded. Starting with an empty pool.\n");
+        }
+
+        if(pool->warmSaveSeconds > 0) {
+            pool->saverRunning = pthread_create(&pool->saver, NULL, runHotPageSaver, bm) == 0;
+        }
+    }
+
+    printf("Buffer Pool Initialized.\n");
+    return RC_OK;
+}
+
+// Function to De-allocate memory and shut down the buffer pool
+RC shutdownBufferPool(BM_BufferPool *const bm) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    // Pages stay in shared memory for the other processes. The last one writes them
+    if(pool->shared != NULL) {
+        RC rc = detachSharedPool(pool->shared);
+        if(rc != RC_OK) {
+            printf("Operation Shut Down: Cannot shut down buffer pool. There are page(s) still in use.\n");
+            if(pool->pins != NULL) {
+                reportPins(pool->pins);
+            }
+            return rc;
+        }
+
+        destroyPoolMgmt(pool);
+        bm->pageFile = NULL;
+        bm->numPages = 0;
+        bm->mgmtData = NULL;
+
+        printf("Operation Shut Down: Detached from shared buffer pool.\n");
+        return RC_OK;
+    }
+
+    // Check if all pages have fix count = 0
+    for(int p = 0; p < pool->numParts; p++) {
+        Partition *part = pool->parts[p];
+
+        for(int frame = 0; frame < part->numFrames; frame++) {
+            if(part->table->pinCnts[frame] > 0) {
+                printf("Operation Shut Down: Cannot shut down buffer pool. There are page(s) still in use.\n");
+                if(pool->pins != NULL) {
+                    reportPins(pool->pins);
+                }
+                return RC_IM_KEY_ALREADY_EXISTS;
+            }
+        }
+    }
+
+    // Remember the resident pages for the next start. The pool still shuts down if the file can't be written
+    if(pool->warmStartFile != NULL) {
+        stopHotPageSaver(pool);
+        saveHotPages(bm, pool->warmStartFile);
+    }
+
+    // Write all dirty pages to disk
+    int success = forceFlushPool(bm);
+    if(success != RC_OK) {
+        printf("Operation Shut Down: Could not write all dirty pages to disk.\n");
+        return RC_WRITE_FAILED;
+    }
+
+    // Free memory allocated to partitions, frames and page data. Write-back tiers write their pages to the files here
+    RC rc = destroyPoolMgmt(pool);
+
+    // Set buffer pool fields to NULL and 0
+    bm->pageFile = NULL;
+    bm->numPages = 0;
+    bm->mgmtData = NULL;
+
+    if(rc != RC_OK) {
+        printf("Operation Shut Down: Buffer pool shut down, but pages of a tier could not be written to their page file.\n");
+        return rc;
+    }
+
+    printf("Operation Shut Down: Successfully shut down buffer pool.\n");
+    return RC_OK;
+}
+
+// Function to write the dirty unpinned pages of one file (or of all files for ALL_FILES) to disk
+static RC flushFiles(BM_BufferPool *const bm, int fileId) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    for(int p = 0; p < pool->numParts; p++) {
+        Partition *part = pool->parts[p];
+
+        pthread_mutex_lock(&part->latch);
+
+        for(int frame = 0; frame < part->numFrames; frame++) {
+            if(fileId != ALL_FILES && part->table->fileIds[frame] != fileId) {
+                continue;
+            }
+
+            // If page fix count = 0 and page is dirty, write page to disk
+            if(part->table->pinCnts[frame] == 0 && part->table->dirtyFlags[frame]) {
+                int success = writeFrame(bm, part, frame);
+                if(success != RC_OK) {
+                    pthread_mutex_unlock(&part->latch);
+                    printf("Operation Flush Pool: Could not write dirty page %d to disk.\n", part->table->pageNos[frame]);
+                    return RC_WRITE_FAILED;
+                }
+
+                addMetric(pool->metrics, METRIC_FLUSHES, 1);
+            }
+        }
+
+        pthread_mutex_unlock(&part->latch);
+    }
+
+    return RC_OK;
+}
+
+// Function to Write all dirty pages to disk
+RC forceFlushPool(BM_BufferPool *const bm) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    RC rc = pool->shared != NULL ? flushSharedPool(pool->shared) : flushFiles(bm, ALL_FILES);
+    if(rc != RC_OK) {
+        return rc;
+    }
+
+    printf("Operation Flush Pool: All dirty pages written to disk.\n");
+    return RC_OK;
+}
+
+// Multiple Page Files
+
+// Function to open another page file and share the pool's frames with it. Pages of the file are pinned with pinFilePage()
+// using the returned file id. Ids of unregistered files are reused
+RC registerPageFile(BM_BufferPool *const bm, char *fileName, int *fileId) {
+    if(isSharedPool(bm, "Operation Register File")) {
+        return RC_NOT_ENABLED;
+    }
+
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    SM_FileHandle fHandle;
+
+    pthread_mutex_lock(&pool->ioLatch);
+
+    int id = MAIN_FILE_ID + 1;
+    while(id < MAX_POOL_FILES && pool->files[id].isRegistered) {
+        id++;
+    }
+
+    if(id == MAX_POOL_FILES) {
+        pthread_mutex_unlock(&pool->ioLatch);
+        printf("Operation Register File: Pool already has %d files open.\n", MAX_POOL_FILES);
+        return RC_OUT_OF_MEMORY;
+    }
+
+    if(openPageFile(fileName, &fHandle) != RC_OK) {
+        pthread_mutex_unlock(&pool->ioLatch);
+        printf("Operation Register File: Could not open file. File doesn't exist.\n");
+        return RC_FILE_NOT_FOUND;
+    }
+
+    free(pool->files[id].fileName);
+    pool->files[id].fileName = strdup(fileName);
+    pool->files[id].fHandle = fHandle;
+    __atomic_store_n(&pool->files[id].isRegistered, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&pool->files[id].isOpen, true, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&pool->ioLatch);
+
+    *fileId = id;
+
+    printf("Operation Register File: File '%s' registered as file %d.\n", fileName, id);
+    return RC_OK;
+}
+
+// Function to write the dirty pages of one file to disk. Pages of other files are not touched
+RC flushPageFile(BM_BufferPool *const bm, const int fileId) {
+    if(((PoolMgmt*) bm->mgmtData)->shared != NULL) {
+        return fileId == MAIN_FILE_ID ? forceFlushPool(bm) : RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    if(!isOpenFile((PoolMgmt*) bm->mgmtData, fileId)) {
+        printf("Operation Flush File: File %d is not registered.\n", fileId);
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    return flushFiles(bm, fileId);
+}
+
+// Function to write and drop all pages of a file from the pool and close it. Fails if a page of the file is pinned.
+// Partitions are latched one at a time, so pages of other files can be used meanwhile
+RC unregisterPageFile(BM_BufferPool *const bm, const int fileId) {
+    if(isSharedPool(bm, "Operation Unregister File")) {
+        return RC_NOT_ENABLED;
+    }
+
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    if(fileId == MAIN_FILE_ID || !isOpenFile(pool, fileId)) {
+        printf("Operation Unregister File: File %d is not a registered file.\n", fileId);
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    // New pins of the file fail from here on
+    __atomic_store_n(&pool->files[fileId].isOpen, false, __ATOMIC_RELEASE);
+
+    for(int p = 0; p < pool->numParts; p++) {
+        Partition *part = pool->parts[p];
+        FrameTable *ft = part->table;
+
+        pthread_mutex_lock(&part->latch);
+
+        for(int frame = 0; frame < part->numFrames; frame++) {
+            if(ft->fileIds[frame] != fileId || ft->pageNos[frame] == NO_PAGE) {
+                continue;
+            }
+
+            if(ft->pinCnts[frame] > 0) {
+                pthread_mutex_unlock(&part->latch);
+                __atomic_store_n(&pool->files[fileId].isOpen, true, __ATOMIC_RELEASE);
+                printf("Operation Unregister File: Page %d of file %d is still in use.\n", ft->pageNos[frame], fileId);
+                return RC_IM_KEY_ALREADY_EXISTS;
+            }
+
+            if(ft->dirtyFlags[frame]) {
+                int success = writeFrame(bm, part, frame);
+                if(success != RC_OK) {
+                    pthread_mutex_unlock(&part->latch);
+                    __atomic_store_n(&pool->files[fileId].isOpen, true, __ATOMIC_RELEASE);
+                    return success;
+                }
+            }
+
+            beginFrameChange(&ft->frames[frame]);
+            __atomic_store_n(&ft->pageNos[frame], NO_PAGE, __ATOMIC_RELAXED);
+            ft->frames[frame].generation++;
+            endFrameChange(&ft->frames[frame]);
+        }
+
+        pthread_mutex_unlock(&part->latch);
+    }
+
+    pthread_mutex_lock(&pool->ioLatch);
+
+    dropVictimFile(pool->victimCache, fileId);
+    RC rc = closePageFile(&pool->files[fileId].fHandle);
+    __atomic_store_n(&pool->files[fileId].isRegistered, false, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&pool->ioLatch);
+
+    printf("Operation Unregister File: File %d closed.\n", fileId);
+    return rc;
+}
+
+// Pool Resizing
+
+// Function to allocate memory on the partition's NUMA node which is kept until the partition is destroyed
+static void *allocPartitionArena(Partition *part, size_t size, int flags) {
+    void *arena = allocFrameArena(size, part->numaNode, flags);
+    if(arena == NULL) {
+        return NULL;
+    }
+
+    ExtraArena *extra = (ExtraArena*)malloc(sizeof(ExtraArena));
+    extra->arena = arena;
+    extra->size = size;
+    extra->flags = flags;
+    extra->next = part->extraArenas;
+    part->extraArenas = extra;
+
+    return arena;
+}
+
+// Function to make room for numSlots more entries of free page data
+static void reserveFreeSlots(Partition *part, int numSlots) {
+    if(part->numFreeSlots + numSlots <= part->freeSlotCapacity) {
+        return;
+    }
+
+    int capacity = part->freeSlotCapacity > 0 ? part->freeSlotCapacity * 2 : 16;
+    if(capacity < part->numFreeSlots + numSlots) {
+        capacity = part->numFreeSlots + numSlots;
+    }
+
+    part->freeSlots = (char**)realloc(part->freeSlots, sizeof(char*) * capacity);
+    part->freeSlotVersions = (unsigned int*)realloc(part->freeSlotVersions, sizeof(unsigned int) * capacity);
+    part->freeSlotCapacity = capacity;
+}
+
+// Function to keep page data no frame uses for later frames or shadow copies
+static void addFreeSlot(Partition *part, char *pageData, unsigned int version) {
+    reserveFreeSlots(part, 1);
+
+    part->freeSlots[part->numFreeSlots] = pageData;
+    part->freeSlotVersions[part->numFreeSlots] = version;
+    part->numFreeSlots++;
+}
+
+// Function to get memory for the table of a resize with at least capacity frames. The partition's two tables take
+// turns, so resizes don't allocate more memory. Only a grow past their capacity allocates a table, of twice the
+// capacity, and the smaller tables are kept until shutdown, since optimistic readers may still scan them
+static FrameTable *nextFrameTable(Partition *part, int capacity, int *tableCapacity) {
+    if(capacity <= part->frameCapacity && part->spareTable != NULL && part->spareCapacity == part->frameCapacity) {
+        *tableCapacity = part->spareCapacity;
+        return part->spareTable;
+    }
+
+    if(capacity > part->frameCapacity && capacity < part->frameCapacity * 2) {
+        capacity = part->frameCapacity * 2;
+    } else if(capacity < part->frameCapacity) {
+        capacity = part->frameCapacity;
+    }
+
+    char *tableMem = (char*) allocPartitionArena(part, frameTableSize(capacity), part->arenaFlags & ARENA_LOCKED);
+    if(tableMem == NULL) {
+        return NULL;
+    }
+
+    *tableCapacity = capacity;
+    return (FrameTable*) tableMem;
+}
+
+// Function to start writing a table. The spare table may still be scanned by an optimistic reader which loaded it
+// before the last resize, so readers have to see the change
+static void beginTableChange(Partition *part) {
+    __atomic_store_n(&part->tableSeq, part->tableSeq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+// Function to publish a new frame table. The size is stored after the table when growing and before it when shrinking,
+// so an optimistic reader never scans past the end of the table it loaded
+static void publishFrames(Partition *part, FrameTable *table, int numFrames) {
+    if(numFrames > part->numFrames) {
+        __atomic_store_n(&part->table, table, __ATOMIC_RELEASE);
+        __atomic_store_n(&part->numFrames, numFrames, __ATOMIC_RELEASE);
+    } else {
+        __atomic_store_n(&part->numFrames, numFrames, __ATOMIC_RELEASE);
+        __atomic_store_n(&part->table, table, __ATOMIC_RELEASE);
+    }
+
+    // Clock hand has to point to an existing frame
+    if(part->clockCounter >= numFrames) {
+        part->clockCounter = 0;
+    }
+}
+
+// Function to make a table written since beginTableChange() the current one. The table it replaces is the spare
+// for the next resize
+static void endTableChange(Partition *part, FrameTable *table, int capacity, int numFrames) {
+    part->spareTable = part->table;
+    part->spareCapacity = part->frameCapacity;
+
+    publishFrames(part, table, numFrames);
+    part->frameCapacity = capacity;
+
+    __atomic_store_n(&part->tableSeq, part->tableSeq + 1, __ATOMIC_RELEASE);
+}
+
+// Function to add frames to a partition. New frames reuse page data released by earlier shrinks before new memory is
+// allocated. Page data of existing frames doesn't move, so pinned pages stay valid
+static RC growPartition(Partition *part, int numFrames) {
+    int numNew = numFrames - part->numFrames;
+    int fromSlots = numNew < part->numFreeSlots ? numNew : part->numFreeSlots;
+    int capacity;
+
+    char *pageData = NULL;
+    if(numNew > fromSlots) {
+        pageData = (char*) allocPartitionArena(part, (size_t) PAGE_SIZE * (numNew - fromSlots), part->arenaFlags);
+        if(pageData == NULL) {
+            return RC_OUT_OF_MEMORY;
+        }
+    }
+
+    FrameTable *tableMem = nextFrameTable(part, numFrames, &capacity);
+    if(tableMem == NULL) {
+        // Page data just allocated is kept for the next grow
+        for(int i = 0; i < numNew - fromSlots; i++) {
+            addFreeSlot(part, pageData + (size_t) PAGE_SIZE * i, 0);
+        }
+
+        return RC_OUT_OF_MEMORY;
+    }
+
+    beginTableChange(part);
+
+    FrameTable *ft = layoutFrameTable((char*) tableMem, capacity);
+
+    for(int frame = 0; frame < part->numFrames; frame++) {
+        copyFrame(ft, frame, part->table, frame);
+    }
+
+    for(int i = 0; i < numNew; i++) {
+        int frame = part->numFrames + i;
+
+        // Reused page data continues its old version, so a reader holding the old version can't validate by chance
+        if(i < fromSlots) {
+            part->numFreeSlots--;
+            initFrame(ft, frame, part->freeSlots[part->numFreeSlots], part->freeSlotVersions[part->numFreeSlots]);
+        } else {
+            initFrame(ft, frame, pageData + (size_t) PAGE_SIZE * (i - fromSlots), 0);
+        }
+    }
+
+    for(int frame = numFrames; frame < capacity; frame++) {
+        initFrame(ft, frame, NULL, 0);
+    }
+
+    int oldNumFrames = part->numFrames;
+
+    endTableChange(part, ft, capacity, numFrames);
+
+    // New frames are empty. Threads waiting for a frame get them first
+    for(int frame = oldNumFrames; frame < numFrames; frame++) {
+        if(!handOffFrame(part, frame)) {
+            break;
+        }
+    }
+
+    return RC_OK;
+}
+
+// Function to rank a frame by how long the replacement strategy would keep it. Frames with a lower rank are evicted first
+static int64_t keepRank(ReplacementStrategy strategy, FrameTable *ft, int frame) {
+    switch(strategy) {
+        case RS_FIFO:
+            return ft->fifoPos[frame];
+
+        case RS_LFU:
+            return ((int64_t) ft->lfuHits[frame] << 32) + (uint32_t) ft->lfuPos[frame];
+
+        case RS_CLOCK:
+            return ft->clockChances[frame] ? 1 : 0;
+
+        default:
+            return ft->lruPos[frame];
+    }
+}
+
+// Function to compare two unpinned frames by the order the replacement strategy would evict them in
+static bool evictsBefore(ReplacementStrategy strategy, FrameTable *ft, int a, int b) {
+    return keepRank(strategy, ft, a) < keepRank(strategy, ft, b);
+}
+
+// Function to choose the next frame to drop when shrinking. Empty frames go first, then the unpinned frame the
+// replacement strategy would evict next. Returns -1 if all remaining frames are pinned
+static int shrinkVictim(BM_BufferPool *const bm, Partition *part, bool *dropped) {
+    FrameTable *ft = part->table;
+    int victim = -1;
+
+    for(int frame = 0; frame < part->numFrames; frame++) {
+        if(dropped[frame] || ft->pinCnts[frame] > 0) {
+            continue;
+        }
+
+        if(ft->pageNos[frame] == NO_PAGE) {
+            return frame;
+        }
+
+        if(victim == -1 || evictsBefore(bm->strategy, ft, frame, victim)) {
+            victim = frame;
+        }
+    }
+
+    return victim;
+}
+
+// Function to drop unpinned frames until the partition has numFrames frames or only pinned frames are left. Dirty pages
+// are written first. The frames which stay are copied to a new table, since optimistic readers may still scan the old one
+static RC shrinkPartition(BM_BufferPool *const bm, Partition *part, int numFrames) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    FrameTable *ft = part->table;
+    bool *dropped = (bool*)calloc(part->numFrames, sizeof(bool));
+    int numDropped = 0;
+    RC rc = RC_OK;
+
+    while(part->numFrames - numDropped > numFrames) {
+        int frame = shrinkVictim(bm, part, dropped);
+        if(frame == -1) {
+            break;
+        }
+
+        if(ft->dirtyFlags[frame]) {
+            rc = writeFrame(bm, part, frame);
+            if(rc != RC_OK) {
+                break;
+            }
+
+            addMetric(pool->metrics, METRIC_DIRTY_EVICTIONS, 1);
+        } else if(ft->pageNos[frame] != NO_PAGE) {
+            addMetric(pool->metrics, METRIC_CLEAN_EVICTIONS, 1);
+        }
+
+        // Frame stays odd in the old table, so optimistic readers of it retry
+        beginFrameChange(&ft->frames[frame]);
+
+        if(pool->victimCache != NULL) {
+            pthread_mutex_lock(&pool->ioLatch);
+            putVictimPage(pool->victimCache, ft->fileIds[frame], ft->pageNos[frame], ft->frames[frame].pageData);
+            pthread_mutex_unlock(&pool->ioLatch);
+        }
+
+        dropped[frame] = true;
+        numDropped++;
+    }
+
+    if(numDropped > 0) {
+        int capacity;
+        FrameTable *tableMem = nextFrameTable(part, part->frameCapacity, &capacity);
+        if(tableMem == NULL) {
+            for(int frame = 0; frame < part->numFrames; frame++) {
+                if(dropped[frame]) {
+                    endFrameChange(&ft->frames[frame]);
+                }
+            }
+
+            free(dropped);
+            return RC_OUT_OF_MEMORY;
+        }
+
+        reserveFreeSlots(part, numDropped);
+        beginTableChange(part);
+
+        FrameTable *kept = layoutFrameTable((char*) tableMem, capacity);
+        int numKept = 0;
+
+        for(int frame = 0; frame < part->numFrames; frame++) {
+            if(!dropped[frame]) {
+                moveHandedFrame(part, frame, numKept);
+                copyFrame(kept, numKept++, ft, frame);
+                continue;
+            }
+
+            // Physical memory of the page data goes back to the system. Readers still looking at it see zeros
+            releaseFrameMemory(ft->frames[frame].pageData, PAGE_SIZE);
+
+            addFreeSlot(part, ft->frames[frame].pageData, ft->frames[frame].version + 1);
+        }
+
+        for(int frame = numKept; frame < capacity; frame++) {
+            initFrame(kept, frame, NULL, 0);
+        }
+
+        endTableChange(part, kept, capacity, numKept);
+    }
+
+    free(dropped);
+    return rc;
+}
+
+// Function to change the number of frames of the pool while it is in use. Partitions are resized one at a time, so
+// pages of other partitions can be pinned meanwhile. If pinned pages keep the pool from shrinking far enough, the
+// pool shrinks as far as it can and RC_RESIZE_INCOMPLETE is returned. Calling it again later continues the shrink
+RC resizeBufferPool(BM_BufferPool *const bm, const int newNumPages) {
+    if(isSharedPool(bm, "Operation Resize")) {
+        return RC_NOT_ENABLED;
+    }
+
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    RC rc = RC_OK;
+
+    if(newNumPages < pool->numParts) {
+        printf("Operation Resize: Pool needs at least one frame per partition (%d).\n", pool->numParts);
+        return RC_BUFFER_TOO_SMALL;
+    }
+
+    for(int p = 0; p < pool->numParts && rc == RC_OK; p++) {
+        Partition *part = pool->parts[p];
+        int numFrames = newNumPages / pool->numParts + (p < newNumPages % pool->numParts ? 1 : 0);
+
+        pthread_mutex_lock(&part->latch);
+
+        if(numFrames > part->numFrames) {
+            rc = growPartition(part, numFrames);
+        } else if(numFrames < part->numFrames) {
+            rc = shrinkPartition(bm, part, numFrames);
+        }
+
+        pthread_mutex_unlock(&part->latch);
+    }
+
+    // Frame numbers of the partitions shift with their sizes
+    int numPages = 0;
+    for(int p = 0; p < pool->numParts; p++) {
+        pthread_mutex_lock(&pool->parts[p]->latch);
+    }
+
+    for(int p = 0; p < pool->numParts; p++) {
+        pool->parts[p]->firstFrame = numPages;
+        numPages += pool->parts[p]->numFrames;
+    }
+
+    bm->numPages = numPages;
+
+    for(int p = pool->numParts - 1; p >= 0; p--) {
+        pthread_mutex_unlock(&pool->parts[p]->latch);
+    }
+
+    if(rc != RC_OK) {
+        printf("Operation Resize: Could not resize buffer pool. Pool has %d frames.\n", numPages);
+        return rc;
+    }
+
+    if(numPages != newNumPages) {
+        printf("Operation Resize: Pool shrunk to %d frames. Remaining frames are pinned.\n", numPages);
+        return RC_RESIZE_INCOMPLETE;
+    }
+
+    printf("Operation Resize: Buffer pool resized to %d frames.\n", numPages);
+    return RC_OK;
+}
+
+// Page Versions
+
+// Function to get page data for a shadow copy. Free page data of the partition is used first. Otherwise a few pages
+// are allocated at once on the partition's NUMA node and the rest kept for later shadows. NULL if out of memory
+static char *takeShadowData(Partition *part) {
+    if(part->numFreeSlots == 0) {
+        char *chunk = (char*) allocPartitionArena(part, (size_t) PAGE_SIZE * SHADOW_CHUNK_PAGES, part->arenaFlags & ARENA_LOCKED);
+        if(chunk == NULL) {
+            return NULL;
+        }
+
+        for(int i = SHADOW_CHUNK_PAGES - 1; i >= 0; i--) {
+            addFreeSlot(part, chunk + (size_t) PAGE_SIZE * i, 0);
+        }
+    }
+
+    part->numFreeSlots--;
+    return part->freeSlots[part->numFreeSlots];
+}
+
+// Function to point an update pin's handle to the shadow copy of the frame's page data. The first update pin copies
+// the page, later ones share its copy. Other pins keep reading the frame's page data until the shadow is published
+static RC beginPageUpdate(Partition *part, int frame, BM_PageHandle *const page) {
+    Frame *fr = &part->table->frames[frame];
+
+    if(fr->shadow == NULL) {
+        char *shadow = takeShadowData(part);
+        if(shadow == NULL) {
+            printf("Operation Update Pin: No memory for a copy of page %d.\n", page->pageNum);
+            return RC_OUT_OF_MEMORY;
+        }
+
+        memcpy(shadow, fr->pageData, PAGE_SIZE);
+        fr->shadow = shadow;
+        fr->shadowDirty = false;
+    }
+
+    fr->updatePins++;
+    page->data = fr->shadow;
+
+    return RC_OK;
+}
+
+// Function to let go of the page data version a handle used, before its pin is dropped. When the last update pin
+// unpins, a shadow marked dirty becomes the frame's page data and the replaced page data is kept for the pins still
+// reading it. Page data nobody uses any more goes back to the partition's free page data
+static void releasePageVersion(Partition *part, int frame, BM_PageHandle *const page) {
+    FrameTable *ft = part->table;
+    Frame *fr = &ft->frames[frame];
+
+    if(page->data == fr->pageData) {
+        return;
+    }
+
+    if(page->data == fr->shadow) {
+        fr->updatePins--;
+        if(fr->updatePins > 0) {
+            return;
+        }
+
+        if(!fr->shadowDirty) {
+            addFreeSlot(part, fr->shadow, fr->version);
+            fr->shadow = NULL;
+            return;
+        }
+
+        // Every other pin reads the current page data or one of the older versions
+        int numReaders = ft->pinCnts[frame] - 1;
+        for(PageVersion *old = fr->oldVersions; old != NULL; old = old->next) {
+            numReaders -= old->numReaders;
+        }
+
+        char *replaced = fr->pageData;
+
+        beginFrameChange(fr);
+        fr->pageData = fr->shadow;
+        fr->shadow = NULL;
+        ft->dirtyFlags[frame] = true;
+        endFrameChange(fr);
+
+        if(numReaders > 0) {
+            PageVersion *old = (PageVersion*)malloc(sizeof(PageVersion));
+            old->data = replaced;
+            old->numReaders = numReaders;
+            old->next = fr->oldVersions;
+            fr->oldVersions = old;
+        } else {
+            addFreeSlot(part, replaced, fr->version);
+        }
+
+        printf("Operation Unpin: Changes of page %d published to frame %d.\n", page->pageNum, part->firstFrame + frame);
+        return;
+    }
+
+    for(PageVersion **link = &fr->oldVersions; *link != NULL; link = &(*link)->next) {
+        PageVersion *old = *link;
+        if(old->data != page->data) {
+            continue;
+        }
+
+        old->numReaders--;
+        if(old->numReaders == 0) {
+            *link = old->next;
+            addFreeSlot(part, old->data, fr->version);
+            free(old);
+        }
+        return;
+    }
+}
+
+// Buffer Manager Interface Access Pages
+// Each function latches the partition of the page and does the work in a helper which expects the latch to be held
+
+static RC markDirtyInPartition (BM_BufferPool *const bm, Partition *part, BM_PageHandle *const page) {
+    FrameTable *ft = part->table;
+
+    // Find frame which contains page to mark as dirty
+    int frame = lookupFrame(part, page, page->fileId, page->pageNum);
+    if(frame == -1) {
+        printf("Operation Dirty: Page %d does not exist.\n", page->pageNum);
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+
+    // Changes of update pins are published when they unpin. Until then the frame's page data stays as it is
+    if(ft->frames[frame].shadow != NULL && page->data == ft->frames[frame].shadow) {
+        ft->frames[frame].shadowDirty = true;
+
+        tracePageAccess(((PoolMgmt*) bm->mgmtData)->trace, TRACE_DIRTY, page->fileId, page->pageNum);
+
+        printf("Operation Dirty: Copy of page %d at frame %d marked as dirty.\n", page->pageNum, part->firstFrame + frame);
+        return RC_OK;
+    }
+
+    // Page data changes, so optimistic readers of the page have to retry
+    beginFrameChange(&ft->frames[frame]);
+
+    // If page is already dirty, write it to disk and read the updated page to make the buffer thread-safe
+    if(ft->dirtyFlags[frame]) {
+        int success = writeFrame(bm, part, frame);
+        if(success != RC_OK) {
+            endFrameChange(&ft->frames[frame]);
+            printf("Operation Dirty: Could not write dirty page %d to disk.\n", page->pageNum);
+            return RC_WRITE_FAILED;
+        }
+
+        success = readFrame("Operation Dirty", bm, part, frame, page->pageNum);
+        if(success != RC_OK) {
+            endFrameChange(&ft->frames[frame]);
+            return success;
+        }
+    }
+
+    ft->dirtyFlags[frame] = true;
+
+    endFrameChange(&ft->frames[frame]);
+
+    if(bm->strategy == RS_LRU) {
+        // Update lruPos to most recently used (highest)
+
+        ft->lruPos[frame] = part->lruCounter;
+        part->lruCounter++;
+    }
+
+    tracePageAccess(((PoolMgmt*) bm->mgmtData)->trace, TRACE_DIRTY, page->fileId, page->pageNum);
+
+    printf("Operation Dirty: Page %d at frame %d marked as dirty.\n", page->pageNum, part->firstFrame + frame);
+    return RC_OK;
+}
+
+// Function to mark all pages dirty
+RC markDirty (BM_BufferPool *const bm, BM_PageHandle *const page) {
+    if(((PoolMgmt*) bm->mgmtData)->shared != NULL) {
+        return markSharedDirty(((PoolMgmt*) bm->mgmtData)->shared, page);
+    }
+
+    RC rc = checkHandleFile((PoolMgmt*) bm->mgmtData, page);
+    if(rc != RC_OK) {
+        return rc;
+    }
+    Partition *part = partitionOf((PoolMgmt*) bm->mgmtData, page->fileId, page->pageNum);
+
+    pthread_mutex_lock(&part->latch);
+    rc = markDirtyInPartition(bm, part, page);
+    pthread_mutex_unlock(&part->latch);
+
+    return rc;
+}
+
+static RC unpinPageInPartition (BM_BufferPool *const bm, Partition *part, BM_PageHandle *const page) {
+    FrameTable *ft = part->table;
+
+    int frame = lookupFrame(part, page, page->fileId, page->pageNum);
+    if(frame == -1) {
+        printf("Operation Unpin: Page %d does not exist in the buffer.\n", page->pageNum);
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+
+    if(ft->pinCnts[frame] == 0) {
+        printf("Operation Unpin: Page %d is not pinned.\n", page->pageNum);
+        return RC_PAGE_NOT_PINNED;
+    }
+
+    // Update pins and readers of replaced page data let go of their version first
+    if(ft->frames[frame].shadow != NULL || ft->frames[frame].oldVersions != NULL) {
+        releasePageVersion(part, frame, page);
+    }
+
+    // Decrease fix count by 1
+    ft->pinCnts[frame]--;
+
+    // Pages pinned with HINT_DONTNEED keep their place at the eviction end
+    if(bm->strategy == RS_LRU && ft->lruPos[frame] >= 0) {
+        // Update lruPos to most recently used (highest)
+
+        ft->lruPos[frame] = part->lruCounter;
+        part->lruCounter++;
+    }
+
+    // Frame is free now. A thread waiting for a frame gets it before anyone else
+    if(ft->pinCnts[frame] == 0) {
+        handOffFrame(part, frame);
+    }
+
+    tracePageAccess(((PoolMgmt*) bm->mgmtData)->trace, TRACE_UNPIN, page->fileId, page->pageNum);
+
+    printf("Operation Unpin: Page %d unpinned from frame %d.\n", page->pageNum, part->firstFrame + frame);
+    return RC_OK;
+}
+
+// Function to unpin page from frame
+RC unpinPage (BM_BufferPool *const bm, BM_PageHandle *const page) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    RC rc;
+
+    if(pool->shared != NULL) {
+        rc = unpinSharedPage(pool->shared, page);
+    } else {
+        rc = checkHandleFile(pool, page);
+        if(rc != RC_OK) {
+            return rc;
+        }
+        Partition *part = partitionOf(pool, page->fileId, page->pageNum);
+
+        pthread_mutex_lock(&part->latch);
+        rc = unpinPageInPartition(bm, part, page);
+        pthread_mutex_unlock(&part->latch);
+    }
+
+    if(rc == RC_OK && pool->pins != NULL) {
+        removePin(pool->pins, page->fileId, page->pageNum);
+    }
+
+    return rc;
+}
+
+static RC forcePageInPartition (BM_BufferPool *const bm, Partition *part, BM_PageHandle *const page) {
+    // Find frame which contains page to write to disk and if it is dirty
+    int frame = lookupFrame(part, page, page->fileId, page->pageNum);
+    if(frame == -1 || !part->table->dirtyFlags[frame]) {
+        printf("Operation Force Page: Page %d does not exist or is not dirty.\n", page->pageNum);
+        return RC_WRITE_FAILED;
+    }
+
+    RC rc = writeFrame(bm, part, frame);
+    if(rc == RC_OK) {
+        addMetric(((PoolMgmt*) bm->mgmtData)->metrics, METRIC_FLUSHES, 1);
+    }
+
+    return rc;
+}
+
+// Function to write a specific dirty page to disk
+RC forcePage (BM_BufferPool *const bm, BM_PageHandle *const page) {
+    if(((PoolMgmt*) bm->mgmtData)->shared != NULL) {
+        return forceSharedPage(((PoolMgmt*) bm->mgmtData)->shared, page);
+    }
+
+    RC rc = checkHandleFile((PoolMgmt*) bm->mgmtData, page);
+    if(rc != RC_OK) {
+        return rc;
+    }
+    Partition *part = partitionOf((PoolMgmt*) bm->mgmtData, page->fileId, page->pageNum);
+
+    pthread_mutex_lock(&part->latch);
+    rc = forcePageInPartition(bm, part, page);
+    pthread_mutex_unlock(&part->latch);
+
+    return rc;
+}
+
+// Function to pin a page to a frame which is already in the buffer
+static void pinResidentFrame (BM_BufferPool *const bm, Partition *part, BM_PageHandle *const page, int frame, const PageNumber pageNum) {
+    FrameTable *ft = part->table;
+
+    ft->pinCnts[frame]++;
+
+    page->data = ft->frames[frame].pageData;
+    page->pageNum = pageNum;
+    setFrameHandle(part, frame, page);
+
+    printf("LRU: %d, FIFO: %d", part->lruCounter, part->fifoCounter);
+    if(bm->strategy == RS_LRU) {
+        // Update lruPos to most recently used (highest)
+        ft->lruPos[frame] = part->lruCounter;
+        part->lruCounter++;
+    } else if(bm->strategy == RS_LFU) {
+        // Increment lfuHit
+        ft->lfuHits[frame]++;
+    } else if(bm->strategy == RS_CLOCK) {
+        // Page is hit, so set second chance to true
+        ft->clockChances[frame] = true;
+    }
+
+    printf("Page is already pinned to frame %d. Increased pin count to %d.\n", part->firstFrame + frame, ft->pinCnts[frame]);
+}
+
+// Function to pin a page which is already in the buffer. If another pin is still reading the page, wait for that read
+// instead of reading the page again. Batched pins hold several latches, so they only wait once pinPages() released them
+static RC pinResidentPage (BM_BufferPool *const bm, Partition *part, BM_PageHandle *const page, int frame, const PageNumber pageNum) {
+    InFlightRead *read = part->table->frames[frame].read;
+
+    pinResidentFrame(bm, part, page, frame, pageNum);
+
+    if(read == NULL) {
+        return RC_OK;
+    }
+
+    read->numWaiters++;
+    addMetric(((PoolMgmt*) bm->mgmtData)->metrics, METRIC_READ_WAITS, 1);
+
+    if(part->batch != NULL) {
+        BatchWait *wait = &part->batch->waits[part->batch->numWaits++];
+        wait->part = part;
+        wait->read = read;
+        wait->page = page;
+        return RC_OK;
+    }
+
+    printf("Operation Pin: Page %d is being read by another pin. Waiting for the read.\n", pageNum);
+    return waitForRead(part, page, read);
+}
+
+// Function to pin a page to a frame chosen without the replacement strategy (an empty frame or one handed to a waiting
+// thread). Fails if the dirty page of a handed frame can't be written, the frame then keeps its page
+static RC pinFreeFrame (BM_BufferPool *const bm, Partition *part, BM_PageHandle *const page, int frame, const PageNumber pageNum) {
+    FrameTable *ft = part->table;
+
+    // This function contains same logic as page pinning just an extra dirty check condition which will be false for empty frame
+    // So used this function to reduce Lines Of Code
+    RC rc = replacePage("Operation Pin", frame, part, page, bm, pageNum);
+    if(rc != RC_OK) {
+        return rc;
+    }
+
+    if(bm->strategy == RS_LRU) {
+        // Update lruPos to most recently used (highest)
+        ft->lruPos[frame] = part->lruCounter;
+        part->lruCounter++;
+    } else if(bm->strategy == RS_FIFO) {
+        // Update queue position of frame to latest (highest)
+        ft->fifoPos[frame] = part->fifoCounter;
+        part->fifoCounter++;
+    } else if(bm->strategy == RS_LFU) {
+        // Update lfuPos to most recently added (highest) and increment lfuHit
+        ft->lfuPos[frame] = part->lfuCounter;
+        part->lfuCounter++;
+
+        ft->lfuHits[frame]++;
+    }  else if(bm->strategy == RS_CLOCK) {
+        // Page is hit, so set second chance to true
+        ft->clockChances[frame] = true;
+    }
+
+    return RC_OK;
+}
+
+// Function to remember which tenant loaded a frame's page and the priority class of that pin
+static void setFrameOwner (Partition *part, int frame, const BM_PinContext *ctx) {
+    part->table->owners[frame] = ctx->tenant;
+    part->table->priorities[frame] = ctx->priority;
+}
+
+static RC pinMissInPartition (BM_BufferPool *const bm, Partition *part, BM_PageHandle *const page, const PageNumber pageNum,
+        const BM_PinContext *ctx);
+
+// Function to wait for a frame when all frames of the partition are pinned, then pin the page to it
+static RC pinAfterWait (BM_BufferPool *const bm, Partition *part, BM_PageHandle *const page, const PageNumber pageNum,
+        const BM_PinContext *ctx) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    addMetric(pool->metrics, METRIC_PIN_WAITS, 1);
+    printf("Operation Pin: All frames are pinned. Waiting for a frame for page %d.\n", pageNum);
+
+    int frame = waitForFrame(part, pool->pinWaitMillis);
+    if(frame == -1) {
+        printf("Operation Pin: No frame was unpinned in time. Could not pin page %d.\n", pageNum);
+        addMetric(pool->metrics, METRIC_PIN_FAILURES, 1);
+        return RC_PIN_TIMEOUT;
+    }
+
+    // Table is loaded again, since a resize may have replaced it while waiting
+    FrameTable *ft = part->table;
+    ft->pinCnts[frame]--;
+
+    // Another thread may have loaded the page meanwhile. The handed frame then goes on to the next waiter
+    int resident = findFrame(part, page->fileId, pageNum);
+    if(resident != -1) {
+        if(ft->pinCnts[frame] == 0) {
+            handOffFrame(part, frame);
+        }
+        return pinResidentPage(bm, part, page, resident, pageNum);
+    }
+
+    // Page still in the handed frame may have been pinned by a hit meanwhile. It can't be evicted then, so the pin
+    // looks for a frame again
+    if(ft->pinCnts[frame] > 0) {
+        return pinMissInPartition(bm, part, page, pageNum, ctx);
+    }
+
+    // Page of the handed frame is evicted like a victim of the strategy, so LFU counts hits of the new page from 0
+    int lfuHits = ft->lfuHits[frame];
+    ft->lfuHits[frame] = 0;
+
+    // Frame keeps its dirty page if it can't be written. It goes on to the next waiter, which may be luckier
+    RC rc = pinFreeFrame(bm, part, page, frame, pageNum);
+    if(rc != RC_OK) {
+        ft->lfuHits[frame] = lfuHits;
+        handOffFrame(part, frame);
+        printf("Operation Pin: Could not evict the page of the handed frame. Could not pin page %d.\n", pageNum);
+        return rc;
+    }
+
+    setFrameOwner(part, frame, ctx);
+
+    printf("Operation Pin: Page %d pinned to frame %d after waiting.\n", pageNum, part->firstFrame + frame);
+    return RC_OK;
+}
+
+// Function to pin a page which is not in the buffer, to an empty frame or a frame chosen by the replacement strategy
+static RC pinMissInPartition (BM_BufferPool *const bm, Partition *part, BM_PageHandle *const page, const PageNumber pageNum,
+        const BM_PinContext *ctx) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    FrameTable *ft = part->table;
+    bool tenantRules = __atomic_load_n(&pool->tenantRules, __ATOMIC_RELAXED);
+    int frame = -1;
+
+    // If page is not pinned to any frame, look for an empty frame. A tenant at its quota replaces a page of its own instead
+    if(!tenantRules || !tenantAtQuota(pool->tenants, ctx->tenant, ft->owners, ft->pageNos, part->numFrames, bm->numPages)) {
+        frame = findValue(ft->pageNos, 0, part->numFrames, NO_PAGE);
+    }
+
+    // If there is an empty frame (Meaning buffer is not full). Pin page to 1st unpinned frame
+    if(frame != -1) {
+        RC rc = pinFreeFrame(bm, part, page, frame, pageNum);
+        if(rc != RC_OK) {
+            return rc;
+        }
+
+        setFrameOwner(part, frame, ctx);
+
+        printf("Operation Pin: Buffer is not full. Page %d pinned to frame %d.\n", pageNum, part->firstFrame + frame);
+
+        return RC_OK;
+    }
+
+    // All frames are pinned. If the pool allows it, wait for one to be unpinned instead of failing. Batched pins
+    // hold several latches and never wait
+    if(pool->pinWaitMillis != 0 && part->batch == NULL && findValue(ft->pinCnts, 0, part->numFrames, 0) == -1) {
+        return pinAfterWait(bm, part, page, pageNum, ctx);
+    }
+
+    // Frames the tenant may not evict, and frames of higher priority classes than the lowest one left, are shown to
+    // the strategy as pinned
+    part->victimPins = ft->pinCnts;
+    if(tenantRules) {
+        if(markTenantVictims(pool->tenants, ctx->tenant, ft->pinCnts, ft->pageNos, ft->owners, ft->priorities,
+                part->numFrames, bm->numPages, ft->victimPins) == 0 && findValue(ft->pinCnts, 0, part->numFrames, 0) != -1) {
+            printf("Operation Pin: Tenant %d may not evict any unpinned frame. Could not pin page %d.\n", ctx->tenant, pageNum);
+            addMetric(pool->metrics, METRIC_PIN_FAILURES, 1);
+            return RC_TENANT_QUOTA;
+        }
+
+        part->victimPins = ft->victimPins;
+    }
+
+    RC rc;
+
+    // Buffer is full. Implement page replacement strategy
+    switch(bm->strategy) {
+        case RS_FIFO:
+            rc = firstInFirstOutRS(bm, page, pageNum, part);
+            break;
+
+        case RS_LRU:
+            rc = leastRecentlyUsedRS(bm, page, pageNum, part);
+            break;
+
+	    case RS_CLOCK:
+            rc = clockRS(bm, page, pageNum, part);
+            break;
+
+	    case RS_LFU:
+            rc = leastFrequentlyUsedRS(bm, page, pageNum, part);
+            break;
+
+	    case RS_LRU_K:
+            rc = kLeastRecentlyUsedRS(bm, page, pageNum, part);
+            break;
+
+        default:
+            printf("Page Replacement Strategy doesn't exist.\n");
+            return RC_IM_KEY_NOT_FOUND;
+    }
+
+    if(rc == RC_OK) {
+        setFrameOwner(part, page->frameNum - part->firstFrame, ctx);
+    }
+
+    return rc;
+}
+
+static RC pinPageInPartition (BM_BufferPool *const bm, Partition *part, BM_PageHandle *const page, const int fileId, const PageNumber pageNum,
+        const BM_PinContext *ctx) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    uint64_t start = metricsNow();
+
+    sampleAccess(pool->mrc, fileId, pageNum);
+
+    // Check if page is already pinned to a frame. Handles pinned to this page before find their frame without a search
+    int frame = lookupFrame(part, page, fileId, pageNum);
+
+    // Frame chosen for a miss takes the file from the handle
+    page->fileId = fileId;
+
+    // If it is, inecrease fix count by 1
+    if(frame != -1) {
+        // A page hit by a higher priority class is kept like one it loaded
+        if((int) ctx->priority > part->table->priorities[frame]) {
+            part->table->priorities[frame] = ctx->priority;
+        }
+
+        RC rc = pinResidentPage(bm, part, page, frame, pageNum);
+        if(rc != RC_OK) {
+            return rc;
+        }
+
+        addMetric(pool->metrics, METRIC_HITS, 1);
+        countTenantPin(pool->tenants, ctx->tenant, true);
+        recordLatency(pool->metrics, LATENCY_PIN_HIT, metricsNow() - start);
+        tracePageAccess(pool->trace, TRACE_PIN, fileId, pageNum);
+        return RC_OK;
+    }
+
+    addMetric(pool->metrics, METRIC_MISSES, 1);
+    countTenantPin(pool->tenants, ctx->tenant, false);
+
+    RC rc = pinMissInPartition(bm, part, page, pageNum, ctx);
+
+    // Page is read without the latch once its frame is set up
+    if(rc == RC_OK && part->startedRead != NULL) {
+        rc = finishStartedRead(bm, part, page);
+    }
+
+    // Reads of a batched pin happen later and are not part of the pin's latency
+    if(rc == RC_OK && part->batch == NULL) {
+        recordLatency(pool->metrics, LATENCY_PIN_MISS, metricsNow() - start);
+    }
+
+    if(rc == RC_OK) {
+        tracePageAccess(pool->trace, TRACE_PIN, fileId, pageNum);
+    }
+
+    return rc;
+}
+
+// Function to count a pin for the calling thread's client before the page is pinned. Fails if the client already
+// holds as many pins as it may
+static RC trackPins (PoolMgmt *pool, const int fileId, const PageNumber *pageNums, const int numPages, const void *site) {
+    if(pool->pins == NULL || addPins(pool->pins, fileId, pageNums, numPages, site) == RC_OK) {
+        return RC_OK;
+    }
+
+    printf("Operation Pin: Client %d holds too many pins. Could not pin %d page(s).\n", getTrackedClient(), numPages);
+    addMetric(pool->metrics, METRIC_PIN_FAILURES, 1);
+    return RC_PIN_LIMIT;
+}
+
+static void untrackPins (PoolMgmt *pool, const int fileId, const PageNumber *pageNums, const int numPages) {
+    for(int i = 0; pool->pins != NULL && i < numPages; i++) {
+        removePin(pool->pins, fileId, pageNums[i]);
+    }
+}
+
+// Function to pin a page for a caller at the given call site
+static RC pinFilePageAt (BM_BufferPool *const bm, BM_PageHandle *const page, const int fileId, const PageNumber pageNum,
+        const BM_PinContext *ctx, const void *site) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    // Shared pools only hold the pool's own page file
+    if(pool->shared != NULL ? fileId != MAIN_FILE_ID : !isOpenFile(pool, fileId)) {
+        printf("Operation Pin: File %d is not registered.\n", fileId);
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    RC rc = trackPins(pool, fileId, &pageNum, 1, site);
+    if(rc != RC_OK) {
+        return rc;
+    }
+
+    if(pool->shared != NULL) {
+        rc = pinSharedPage(pool->shared, page, pageNum);
+    } else {
+        Partition *part = partitionOf(pool, fileId, pageNum);
+
+        pthread_mutex_lock(&part->latch);
+        rc = pinPageInPartition(bm, part, page, fileId, pageNum, ctx);
+        pthread_mutex_unlock(&part->latch);
+    }
+
+    if(rc != RC_OK) {
+        untrackPins(pool, fileId, &pageNum, 1);
+    }
+
+    return rc;
+}
+
+// Function to pin a page of a registered page file. Done either directly or through a page replacement strategy
+RC pinFilePage (BM_BufferPool *const bm, BM_PageHandle *const page, const int fileId, const PageNumber pageNum) {
+    return pinFilePageAt(bm, page, fileId, pageNum, &defaultPinContext, PIN_CALL_SITE());
+}
+
+// Function to pin page of the pool's page file to frame
+RC pinPage (BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum) {
+    return pinFilePageAt(bm, page, MAIN_FILE_ID, pageNum, &defaultPinContext, PIN_CALL_SITE());
+}
+
+// Function to pin the page of a handle again after it was unpinned. Uses the frame remembered in the handle if the
+// page is still there, otherwise the page is looked up or read like in pinFilePage()
+RC repinPage (BM_BufferPool *const bm, BM_PageHandle *const page) {
+    return pinFilePageAt(bm, page, page->fileId, page->pageNum, &defaultPinContext, PIN_CALL_SITE());
+}
+
+// Function to pin a page of a registered page file for a tenant and priority class. Misses only evict frames the
+// tenant's quota and the other tenants' reservations allow, lowest priority class first
+RC pinPageWithContext (BM_BufferPool *const bm, BM_PageHandle *const page, const int fileId, const PageNumber pageNum,
+        const BM_PinContext *ctx) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    if(ctx == NULL) {
+        return pinFilePageAt(bm, page, fileId, pageNum, &defaultPinContext, PIN_CALL_SITE());
+    }
+
+    if(ctx->tenant < 0 || ctx->tenant >= MAX_TENANTS || ctx->priority < PRIORITY_LOW || ctx->priority > PRIORITY_HIGH) {
+        printf("Operation Pin: Tenant %d or priority %d doesn't exist.\n", ctx->tenant, (int) ctx->priority);
+        return RC_BAD_TENANT;
+    }
+
+    // Misses of pins without a context skip the tenant rules until they matter
+    if(ctx->tenant != DEFAULT_TENANT || ctx->priority != PRIORITY_NORMAL) {
+        __atomic_store_n(&pool->tenantRules, true, __ATOMIC_RELAXED);
+    }
+
+    return pinFilePageAt(bm, page, fileId, pageNum, ctx, PIN_CALL_SITE());
+}
+
+// Pin Tracking
+
+// Function to make the calling thread's pins count for the given client, e.g. a query running on several threads
+void setPinClient (const int clientId) {
+    setTrackedClient(clientId);
+}
+
+// Function to print the pins each client still holds, with the call site of the first pin of every page in debug
+// builds. Meant for finding pins which are never unpinned
+RC reportLeakedPins (BM_BufferPool *const bm, int *numPins) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    if(pool->pins == NULL) {
+        printf("Leaked Pins: Pin tracking is not enabled for this pool.\n");
+        return RC_NOT_ENABLED;
+    }
+
+    int held = reportPins(pool->pins);
+    if(held == 0) {
+        printf("Leaked Pins: No pins are held.\n");
+    }
+
+    if(numPins != NULL) {
+        *numPins = held;
+    }
+
+    return RC_OK;
+}
+
+// Tenants
+
+// Function to set the frames of the pool a tenant keeps at least and may use at most. Each partition enforces its share
+// of both, rounded up. Pages of a tenant below its reservation are only evicted by misses of the tenant itself
+RC setTenantQuota (BM_BufferPool *const bm, const int tenant, const int reservedFrames, const int maxFrames) {
+    if(isSharedPool(bm, "Operation Tenant Quota")) {
+        return RC_NOT_ENABLED;
+    }
+
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    if(tenant < 0 || tenant >= MAX_TENANTS || reservedFrames < 0 || maxFrames < 0) {
+        printf("Operation Tenant Quota: Tenant %d or its limits are invalid.\n", tenant);
+        return RC_BAD_TENANT;
+    }
+
+    setTenantLimits(pool->tenants, tenant, reservedFrames, maxFrames);
+    __atomic_store_n(&pool->tenantRules, true, __ATOMIC_RELAXED);
+
+    printf("Operation Tenant Quota: Tenant %d keeps %d frame(s) and may use %d (0 = no limit).\n", tenant, reservedFrames, maxFrames);
+    return RC_OK;
+}
+
+// Function to get the hits and misses of a tenant's pins and the number of frames holding pages it loaded
+RC getTenantStats (BM_BufferPool *const bm, const int tenant, BM_TenantStats *const stats) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    if(tenant < 0 || tenant >= MAX_TENANTS) {
+        return RC_BAD_TENANT;
+    }
+
+    readTenantCounts(pool->tenants, tenant, &stats->hits, &stats->misses);
+    stats->numFrames = 0;
+
+    for(int p = 0; p < pool->numParts; p++) {
+        Partition *part = pool->parts[p];
+
+        pthread_mutex_lock(&part->latch);
+        for(int frame = 0; frame < part->numFrames; frame++) {
+            if(part->table->pageNos[frame] != NO_PAGE && part->table->owners[frame] == tenant) {
+                stats->numFrames++;
+            }
+        }
+        pthread_mutex_unlock(&part->latch);
+    }
+
+    return RC_OK;
+}
+
+// Snapshot Reads
+
+// Function to pin a page of the pool's page file for changing it. The caller changes a copy of the page, which other
+// pins don't see. Once the last update pin of the page is unpinned, a copy marked dirty replaces the page. Pins made
+// before that keep reading the old page until they are unpinned, so readers never see a change half done
+RC pinPageForUpdate (BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum) {
+    if(isSharedPool(bm, "Operation Update Pin")) {
+        return RC_NOT_ENABLED;
+    }
+
+    RC rc = pinFilePageAt(bm, page, MAIN_FILE_ID, pageNum, &defaultPinContext, PIN_CALL_SITE());
+    if(rc != RC_OK) {
+        return rc;
+    }
+
+    Partition *part = partitionOf((PoolMgmt*) bm->mgmtData, MAIN_FILE_ID, pageNum);
+
+    pthread_mutex_lock(&part->latch);
+    rc = beginPageUpdate(part, lookupFrame(part, page, MAIN_FILE_ID, pageNum), page);
+    pthread_mutex_unlock(&part->latch);
+
+    if(rc != RC_OK) {
+        unpinPage(bm, page);
+    }
+
+    return rc;
+}
+
+// Access Hints
+
+// Function to put a frame at the eviction end of every strategy. It gets the lowest priority class and a position
+// before all other frames, so the frame hinted last is evicted first. This gives scans MRU eviction of their own pages
+static void coolFrame(Partition *part, int frame) {
+    FrameTable *ft = part->table;
+
+    part->coldCounter--;
+
+    ft->lruPos[frame] = part->coldCounter;
+    ft->fifoPos[frame] = part->coldCounter;
+    ft->lfuPos[frame] = part->coldCounter;
+    ft->lfuHits[frame] = 0;
+    ft->clockChances[frame] = false;
+    ft->priorities[frame] = PRIORITY_LOW;
+}
+
+static bool batchFitsFrames(PoolMgmt *pool, const PageNumber *pageNums, int numPages);
+static void latchPartitions(PoolMgmt *pool, bool *touched, ReadBatch *batch);
+static void unlatchPartitions(PoolMgmt *pool, bool *touched);
+
+// Function to read the pages after a page pinned with HINT_SEQUENTIAL, when the next page isn't in the buffer yet. The
+// pages are pinned and unpinned as one batch, so runs of them are read with single calls. Pages past the end of the
+// file are not read ahead, and at most a quarter of the pool is. Read-ahead is skipped if the partitions don't have an
+// unpinned frame for each page, so it never fails a batch. Read-ahead is only an optimization, so a failed one is ignored
+static void readAhead(BM_BufferPool *const bm, const PageNumber pageNum) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    PageNumber first = pageNum + 1;
+    int numPages = pool->readAheadPages < bm->numPages / 4 ? pool->readAheadPages : bm->numPages / 4;
+
+    pthread_mutex_lock(&pool->ioLatch);
+    int fileSize = pool->files[MAIN_FILE_ID].fHandle.totalNumPages;
+    pthread_mutex_unlock(&pool->ioLatch);
+
+    if(first + numPages > fileSize) {
+        numPages = fileSize - first;
+    }
+
+    if(numPages <= 0) {
+        return;
+    }
+
+    PageNumber *pageNums = (PageNumber*)malloc(sizeof(PageNumber) * numPages);
+    bool *touched = (bool*)calloc(pool->numParts, sizeof(bool));
+
+    for(int i = 0; i < numPages; i++) {
+        pageNums[i] = first + i;
+        touched[partitionIndex(pool, MAIN_FILE_ID, pageNums[i])] = true;
+    }
+
+    latchPartitions(pool, touched, NULL);
+    bool resident = findFrame(partitionOf(pool, MAIN_FILE_ID, first), MAIN_FILE_ID, first) != -1;
+    bool fits = batchFitsFrames(pool, pageNums, numPages);
+    unlatchPartitions(pool, touched);
+
+    free(touched);
+
+    if(resident || !fits) {
+        if(!resident) {
+            printf("Operation Read Ahead: Not enough unpinned frames for pages %d to %d. Skipped.\n", first, first + numPages - 1);
+        }
+        free(pageNums);
+        return;
+    }
+
+    BM_PageHandle *pages = (BM_PageHandle*)calloc(numPages, sizeof(BM_PageHandle));
+
+    if(pinPages(bm, pages, pageNums, numPages) == RC_OK) {
+        unpinPages(bm, pages, numPages);
+        printf("Operation Read Ahead: Pages %d to %d read ahead.\n", first, first + numPages - 1);
+    }
+
+    free(pageNums);
+    free(pages);
+}
+
+// Function to pin a page of the pool's page file with a hint about how it will be used. KEEP pins at the high priority
+// class and DONTNEED at the low one, whose misses are evicted before all other pages. SEQUENTIAL also reads ahead
+RC pinPageWithHint (BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, const BM_PageHint hint) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    BM_PinContext ctx = defaultPinContext;
+
+    if(hint == HINT_KEEP) {
+        ctx.priority = PRIORITY_HIGH;
+    } else if(hint == HINT_DONTNEED) {
+        ctx.priority = PRIORITY_LOW;
+    }
+
+    if(ctx.priority != PRIORITY_NORMAL) {
+        __atomic_store_n(&pool->tenantRules, true, __ATOMIC_RELAXED);
+    }
+
+    RC rc = pinFilePageAt(bm, page, MAIN_FILE_ID, pageNum, &ctx, PIN_CALL_SITE());
+    if(rc != RC_OK || pool->shared != NULL) {
+        return rc;
+    }
+
+    // Page loaded for this pin, or only used by other DONTNEED pins, goes to the eviction end right away
+    if(hint == HINT_DONTNEED) {
+        Partition *part = partitionOf(pool, MAIN_FILE_ID, pageNum);
+
+        pthread_mutex_lock(&part->latch);
+        int frame = lookupFrame(part, page, MAIN_FILE_ID, pageNum);
+        if(frame != -1 && part->table->priorities[frame] == PRIORITY_LOW) {
+            coolFrame(part, frame);
+        }
+        pthread_mutex_unlock(&part->latch);
+    }
+
+    if(hint == HINT_SEQUENTIAL && pool->readAheadPages > 0) {
+        readAhead(bm, pageNum);
+    }
+
+    return RC_OK;
+}
+
+// Function to unpin a page with a hint about its further use. DONTNEED and SEQUENTIAL put the page at the eviction end
+// once no one else has it pinned, KEEP makes it resist eviction like a page pinned with HINT_KEEP
+RC unpinPageWithHint (BM_BufferPool *const bm, BM_PageHandle *const page, const BM_PageHint hint) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    // Shared pools keep no priority classes, so hints are ignored there
+    if(pool->shared != NULL) {
+        return unpinPage(bm, page);
+    }
+
+    RC rc = checkHandleFile(pool, page);
+    if(rc != RC_OK) {
+        return rc;
+    }
+    Partition *part = partitionOf(pool, page->fileId, page->pageNum);
+
+    if(hint != HINT_NONE) {
+        __atomic_store_n(&pool->tenantRules, true, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_lock(&part->latch);
+
+    rc = unpinPageInPartition(bm, part, page);
+
+    if(rc == RC_OK && hint != HINT_NONE) {
+        int frame = lookupFrame(part, page, page->fileId, page->pageNum);
+
+        if(hint == HINT_KEEP) {
+            part->table->priorities[frame] = PRIORITY_HIGH;
+        } else if(part->table->pinCnts[frame] == 0) {
+            coolFrame(part, frame);
+        }
+    }
+
+    pthread_mutex_unlock(&part->latch);
+
+    if(rc == RC_OK && pool->pins != NULL) {
+        removePin(pool->pins, page->fileId, page->pageNum);
+    }
+
+    return rc;
+}
+
+// Batched Page Access
+
+// Function to latch the flagged partitions. Always in partition order, so concurrent batches can't deadlock
+static void latchPartitions(PoolMgmt *pool, bool *touched, ReadBatch *batch) {
+    for(int p = 0; p < pool->numParts; p++) {
+        if(touched[p]) {
+            pthread_mutex_lock(&pool->parts[p]->latch);
+            pool->parts[p]->batch = batch;
+        }
+    }
+}
+
+static void unlatchPartitions(PoolMgmt *pool, bool *touched) {
+    for(int p = 0; p < pool->numParts; p++) {
+        if(touched[p]) {
+            pool->parts[p]->batch = NULL;
+            pthread_mutex_unlock(&pool->parts[p]->latch);
+        }
+    }
+}
+
+static int compareBatchReads(const void *a, const void *b) {
+    return ((BatchRead*) a)->pageNo - ((BatchRead*) b)->pageNo;
+}
+
+// Function to read all pages missed by a batched pin. Pages are sorted, so runs of consecutive pages are read with one call
+static RC readBatchPages(BM_BufferPool *const bm, ReadBatch *batch) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    BatchRead *reads = batch->reads;
+    int numReads = batch->numReads;
+
+    if(numReads == 0) {
+        return RC_OK;
+    }
+
+    qsort(reads, numReads, sizeof(BatchRead), compareBatchReads);
+
+    int *pageNums = (int*)malloc(sizeof(int) * numReads);
+    SM_PageHandle *memPages = (SM_PageHandle*)malloc(sizeof(SM_PageHandle) * numReads);
+
+    for(int i = 0; i < numReads; i++) {
+        pageNums[i] = reads[i].pageNo;
+        memPages[i] = reads[i].part->table->frames[reads[i].frame].pageData;
+    }
+
+    pthread_mutex_lock(&pool->ioLatch);
+
+    // Batches only pin pages of the pool's own page file
+    SM_FileHandle *fHandle = &pool->files[MAIN_FILE_ID].fHandle;
+
+    ensureCapacity(pageNums[numReads - 1] + 1, fHandle);
+    int success = readBlocks(pageNums, numReads, fHandle, memPages);
+
+    if(success == RC_OK) {
+        pool->readCnt += numReads;
+        addMetric(pool->metrics, METRIC_READS, numReads);
+    }
+
+    pthread_mutex_unlock(&pool->ioLatch);
+
+    free(pageNums);
+    free(memPages);
+
+    if(success != RC_OK) {
+        printf("Operation Pin Pages: Could not read %d missed pages.\n", numReads);
+        return success;
+    }
+
+    for(int i = 0; i < numReads; i++) {
+        endFrameChange(&reads[i].part->table->frames[reads[i].frame]);
+    }
+
+    return RC_OK;
+}
+
+// Function to undo a failed batched pin. Frames still waiting for their read are emptied and the other pages are unpinned
+static void undoPinPages(BM_BufferPool *const bm, ReadBatch *batch, BM_PageHandle *const pages, int numPinned) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    for(int i = 0; i < batch->numReads; i++) {
+        FrameTable *ft = batch->reads[i].part->table;
+        int frame = batch->reads[i].frame;
+
+        ft->pinCnts[frame] = 0;
+        __atomic_store_n(&ft->pageNos[frame], NO_PAGE, __ATOMIC_RELAXED);
+        ft->frames[frame].generation++;
+        endFrameChange(&ft->frames[frame]);
+
+        handOffFrame(batch->reads[i].part, frame);
+    }
+
+    // Pins waiting for reads of other pins are unpinned below like the others
+    for(int i = 0; i < batch->numWaits; i++) {
+        batch->waits[i].read->numWaiters--;
+    }
+
+    for(int i = 0; i < numPinned; i++) {
+        Partition *part = partitionOf(pool, pages[i].fileId, pages[i].pageNum);
+
+        if(lookupFrame(part, &pages[i], pages[i].fileId, pages[i].pageNum) != -1) {
+            unpinPageInPartition(bm, part, &pages[i]);
+        }
+    }
+}
+
+// Function to wait for the pages of a batched pin which other pins were still reading. Each partition is latched on its
+// own, so the reads can finish. If one of them failed, all other pages are unpinned again
+static RC awaitBatchReads(BM_BufferPool *const bm, ReadBatch *batch, BM_PageHandle *const pages, int numPages) {
+    bool *failed = (bool*)calloc(numPages, sizeof(bool));
+    RC rc = RC_OK;
+
+    for(int i = 0; i < batch->numWaits; i++) {
+        BatchWait *wait = &batch->waits[i];
+
+        pthread_mutex_lock(&wait->part->latch);
+        RC success = waitForRead(wait->part, wait->page, wait->read);
+        pthread_mutex_unlock(&wait->part->latch);
+
+        // Pin of a failed read was already dropped with its frame
+        if(success != RC_OK) {
+            failed[wait->page - pages] = true;
+            rc = success;
+        }
+    }
+
+    if(rc != RC_OK) {
+        for(int i = 0; i < numPages; i++) {
+            if(!failed[i]) {
+                Partition *part = partitionOf((PoolMgmt*) bm->mgmtData, pages[i].fileId, pages[i].pageNum);
+
+                pthread_mutex_lock(&part->latch);
+                unpinPageInPartition(bm, part, &pages[i]);
+                pthread_mutex_unlock(&part->latch);
+            }
+        }
+    }
+
+    free(failed);
+    return rc;
+}
+
+// Function to check that every partition a batch touches has an unpinned frame for each page the batch misses there.
+// An unpinned page the batch hits takes one of those frames as well, since the batch pins it. Caller holds the latches
+// of the partitions, so the frames are still unpinned when the batch chooses its victims
+static bool batchFitsFrames(PoolMgmt *pool, const PageNumber *pageNums, int numPages) {
+    int *needed = (int*)calloc(pool->numParts, sizeof(int));
+    bool fits = true;
+
+    for(int i = 0; i < numPages; i++) {
+        int p = partitionIndex(pool, MAIN_FILE_ID, pageNums[i]);
+        Partition *part = pool->parts[p];
+        bool repeated = false;
+
+        // Page listed twice only needs one frame
+        for(int j = 0; j < i && !repeated; j++) {
+            repeated = pageNums[j] == pageNums[i];
+        }
+
+        int frame = findFrame(part, MAIN_FILE_ID, pageNums[i]);
+        if(!repeated && (frame == -1 || part->table->pinCnts[frame] == 0)) {
+            needed[p]++;
+        }
+    }
+
+    for(int p = 0; p < pool->numParts && fits; p++) {
+        Partition *part = pool->parts[p];
+        int unpinned = 0;
+
+        for(int frame = 0; frame < part->numFrames && needed[p] > 0; frame++) {
+            unpinned += part->table->pinCnts[frame] == 0 ? 1 : 0;
+        }
+
+        fits = unpinned >= needed[p];
+    }
+
+    free(needed);
+    return fits;
+}
+
+// Function to pin several pages at once. Hits are pinned right away and frames for all misses are chosen before any
+// page is read, then all missed pages are read together. Either all pages get pinned or none of them. A batch which
+// doesn't fit the unpinned frames fails before any page is evicted
+RC pinPages (BM_BufferPool *const bm, BM_PageHandle *const pages, const PageNumber *pageNums, const int numPages) {
+    if(isSharedPool(bm, "Operation Pin Pages")) {
+        return RC_NOT_ENABLED;
+    }
+
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    bool *touched = (bool*)calloc(pool->numParts, sizeof(bool));
+    ReadBatch batch;
+
+    batch.reads = (BatchRead*)malloc(sizeof(BatchRead) * (numPages > 0 ? numPages : 1));
+    batch.numReads = 0;
+    batch.waits = (BatchWait*)malloc(sizeof(BatchWait) * (numPages > 0 ? numPages : 1));
+    batch.numWaits = 0;
+
+    RC rc = trackPins(pool, MAIN_FILE_ID, pageNums, numPages, PIN_CALL_SITE());
+    if(rc != RC_OK) {
+        free(batch.reads);
+        free(batch.waits);
+        free(touched);
+        return rc;
+    }
+
+    for(int i = 0; i < numPages; i++) {
+        touched[partitionIndex(pool, MAIN_FILE_ID, pageNums[i])] = true;
+    }
+
+    latchPartitions(pool, touched, &batch);
+
+    if(!batchFitsFrames(pool, pageNums, numPages)) {
+        printf("Operation Pin Pages: Not enough unpinned frames for %d pages. No page was evicted.\n", numPages);
+        addMetric(pool->metrics, METRIC_PIN_FAILURES, 1);
+        rc = RC_WRITE_FAILED;
+    }
+
+    int numPinned = 0;
+
+    while(rc == RC_OK && numPinned < numPages) {
+        rc = pinPageInPartition(bm, partitionOf(pool, MAIN_FILE_ID, pageNums[numPinned]), &pages[numPinned], MAIN_FILE_ID,
+                pageNums[numPinned], &defaultPinContext);
+        if(rc != RC_OK) {
+            break;
+        }
+
+        numPinned++;
+    }
+
+    if(rc == RC_OK) {
+        rc = readBatchPages(bm, &batch);
+    }
+
+    if(rc != RC_OK) {
+        undoPinPages(bm, &batch, pages, numPinned);
+        printf("Operation Pin Pages: Could not pin all %d pages.\n", numPages);
+    } else {
+        printf("Operation Pin Pages: %d pages pinned, %d of them read from disk.\n", numPages, batch.numReads);
+    }
+
+    unlatchPartitions(pool, touched);
+
+    if(rc == RC_OK && batch.numWaits > 0) {
+        rc = awaitBatchReads(bm, &batch, pages, numPages);
+        if(rc != RC_OK) {
+            printf("Operation Pin Pages: Could not pin all %d pages.\n", numPages);
+        }
+    }
+
+    if(rc != RC_OK) {
+        untrackPins(pool, MAIN_FILE_ID, pageNums, numPages);
+    }
+
+    free(batch.reads);
+    free(batch.waits);
+    free(touched);
+
+    return rc;
+}
+
+// Function to unpin several pages at once, latching each partition only once
+RC unpinPages (BM_BufferPool *const bm, BM_PageHandle *const pages, const int numPages) {
+    if(isSharedPool(bm, "Operation Unpin Pages")) {
+        return RC_NOT_ENABLED;
+    }
+
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    bool *touched = (bool*)calloc(pool->numParts, sizeof(bool));
+
+    for(int i = 0; i < numPages; i++) {
+        RC rc = checkHandleFile(pool, &pages[i]);
+        if(rc != RC_OK) {
+            free(touched);
+            return rc;
+        }
+        touched[partitionIndex(pool, pages[i].fileId, pages[i].pageNum)] = true;
+    }
+
+    latchPartitions(pool, touched, NULL);
+
+    RC rc = RC_OK;
+    for(int i = 0; i < numPages; i++) {
+        int success = unpinPageInPartition(bm, partitionOf(pool, pages[i].fileId, pages[i].pageNum), &pages[i]);
+        if(success != RC_OK) {
+            rc = success;
+        } else if(pool->pins != NULL) {
+            removePin(pool->pins, pages[i].fileId, pages[i].pageNum);
+        }
+    }
+
+    unlatchPartitions(pool, touched);
+
+    free(touched);
+
+    return rc;
+}
+
+// Warm Restart
+
+// Struct for a resident page and its rank while the hot page list is sorted
+typedef struct RankedPage {
+    int64_t rank;
+    HotPage page;
+} RankedPage;
+
+static int compareRankedPages(const void *a, const void *b) {
+    int64_t x = ((RankedPage*) a)->rank, y = ((RankedPage*) b)->rank;
+    return x > y ? -1 : (x < y ? 1 : 0);
+}
+
+// Function to write the resident pages of the pool's page file, the ones the strategy would keep longest first.
+// Caller holds the warm latch
+static RC writePoolHotPages(BM_BufferPool *const bm, const char *fileName) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    for(int p = 0; p < pool->numParts; p++) {
+        pthread_mutex_lock(&pool->parts[p]->latch);
+    }
+
+    int numPages = 0;
+    RankedPage *ranked = (RankedPage*)malloc(sizeof(RankedPage) * (bm->numPages > 0 ? bm->numPages : 1));
+
+    for(int p = 0; p < pool->numParts; p++) {
+        FrameTable *ft = pool->parts[p]->table;
+
+        for(int frame = 0; frame < pool->parts[p]->numFrames; frame++) {
+            if(ft->pageNos[frame] == NO_PAGE || ft->fileIds[frame] != MAIN_FILE_ID) {
+                continue;
+            }
+
+            RankedPage *rp = &ranked[numPages++];
+            rp->rank = keepRank(bm->strategy, ft, frame);
+            rp->page.pageNum = ft->pageNos[frame];
+            rp->page.lruPos = ft->lruPos[frame];
+            rp->page.fifoPos = ft->fifoPos[frame];
+            rp->page.lfuPos = ft->lfuPos[frame];
+            rp->page.lfuHit = ft->lfuHits[frame];
+            rp->page.clockChance = ft->clockChances[frame];
+        }
+    }
+
+    for(int p = pool->numParts - 1; p >= 0; p--) {
+        pthread_mutex_unlock(&pool->parts[p]->latch);
+    }
+
+    qsort(ranked, numPages, sizeof(RankedPage), compareRankedPages);
+
+    HotPage *pages = (HotPage*)malloc(sizeof(HotPage) * (numPages > 0 ? numPages : 1));
+    for(int i = 0; i < numPages; i++) {
+        pages[i] = ranked[i].page;
+    }
+
+    RC rc = writeHotPages(fileName, pages, numPages);
+
+    free(pages);
+    free(ranked);
+
+    return rc;
+}
+
+// Function to write the list of resident pages and their replacement bookkeeping to a hot page file
+RC saveHotPages (BM_BufferPool *const bm, const char *fileName) {
+    if(isSharedPool(bm, "Operation Save Hot Pages")) {
+        return RC_NOT_ENABLED;
+    }
+
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    pthread_mutex_lock(&pool->warmLatch);
+    RC rc = writePoolHotPages(bm, fileName);
+    pthread_mutex_unlock(&pool->warmLatch);
+
+    return rc;
+}
+
+// Function to read the pages of a hot page file into empty frames. Pages are placed hottest first until their partition
+// is full, then all of them are read with one sorted batch so runs of consecutive pages become single reads. Their
+// replacement bookkeeping is restored, so the strategy keeps preferring the same pages as before the restart
+RC loadHotPages (BM_BufferPool *const bm, const char *fileName) {
+    if(isSharedPool(bm, "Operation Load Hot Pages")) {
+        return RC_NOT_ENABLED;
+    }
+
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    HotPage *pages;
+    int numPages;
+
+    RC rc = readHotPages(fileName, &pages, &numPages);
+    if(rc != RC_OK) {
+        return rc;
+    }
+
+    bool *touched = (bool*)malloc(sizeof(bool) * pool->numParts);
+    int *nextFree = (int*)calloc(pool->numParts, sizeof(int));
+    ReadBatch batch;
+
+    memset(touched, true, sizeof(bool) * pool->numParts);
+    batch.reads = (BatchRead*)malloc(sizeof(BatchRead) * (numPages > 0 ? numPages : 1));
+    batch.numReads = 0;
+    batch.waits = NULL;
+    batch.numWaits = 0;
+
+    latchPartitions(pool, touched, &batch);
+
+    // Pages past the end of the file were dropped from it since the list was written
+    pthread_mutex_lock(&pool->ioLatch);
+    int fileSize = pool->files[MAIN_FILE_ID].fHandle.totalNumPages;
+    pthread_mutex_unlock(&pool->ioLatch);
+
+    for(int i = 0; i < numPages; i++) {
+        PageNumber pageNum = pages[i].pageNum;
+        if(pageNum < 0 || pageNum >= fileSize) {
+            continue;
+        }
+
+        int p = partitionIndex(pool, MAIN_FILE_ID, pageNum);
+        Partition *part = pool->parts[p];
+
+        if(findFrame(part, MAIN_FILE_ID, pageNum) != -1) {
+            continue;
+        }
+
+        while(nextFree[p] < part->numFrames && part->table->pageNos[nextFree[p]] != NO_PAGE) {
+            nextFree[p]++;
+        }
+        if(nextFree[p] == part->numFrames) {
+            continue;
+        }
+
+        FrameTable *ft = part->table;
+        int frame = nextFree[p];
+
+        beginFrameChange(&ft->frames[frame]);
+        __atomic_store_n(&ft->fileIds[frame], MAIN_FILE_ID, __ATOMIC_RELAXED);
+        __atomic_store_n(&ft->pageNos[frame], pageNum, __ATOMIC_RELAXED);
+        ft->frames[frame].generation++;
+        ft->dirtyFlags[frame] = false;
+
+        ft->lruPos[frame] = pages[i].lruPos;
+        ft->fifoPos[frame] = pages[i].fifoPos;
+        ft->lfuPos[frame] = pages[i].lfuPos;
+        ft->lfuHits[frame] = pages[i].lfuHit;
+        ft->clockChances[frame] = pages[i].clockChance != 0;
+        ft->owners[frame] = DEFAULT_TENANT;
+        ft->priorities[frame] = PRIORITY_NORMAL;
+
+        // Later pins continue after the restored positions. INT_MAX marks a position the strategy never set
+        part->lruCounter = ft->lruPos[frame] != INT_MAX && ft->lruPos[frame] >= part->lruCounter ? ft->lruPos[frame] + 1 : part->lruCounter;
+        part->fifoCounter = ft->fifoPos[frame] != INT_MAX && ft->fifoPos[frame] >= part->fifoCounter ? ft->fifoPos[frame] + 1 : part->fifoCounter;
+        part->lfuCounter = ft->lfuPos[frame] != INT_MAX && ft->lfuPos[frame] >= part->lfuCounter ? ft->lfuPos[frame] + 1 : part->lfuCounter;
+
+        BatchRead *read = &batch.reads[batch.numReads++];
+        read->part = part;
+        read->frame = frame;
+        read->pageNo = pageNum;
+    }
+
+    // Copies of the pages in the victim cache are dropped, since the pages are resident now
+    if(pool->victimCache != NULL) {
+        pthread_mutex_lock(&pool->ioLatch);
+        for(int i = 0; i < batch.numReads; i++) {
+            dropVictimPage(pool->victimCache, MAIN_FILE_ID, batch.reads[i].pageNo);
+        }
+        pthread_mutex_unlock(&pool->ioLatch);
+    }
+
+    rc = readBatchPages(bm, &batch);
+    if(rc != RC_OK) {
+        undoPinPages(bm, &batch, NULL, 0);
+    } else {
+        printf("Warm start: %d of %d hot pages reloaded from %s.\n", batch.numReads, numPages, fileName);
+    }
+
+    unlatchPartitions(pool, touched);
+
+    free(batch.reads);
+    free(nextFree);
+    free(touched);
+    free(pages);
+
+    return rc;
+}
+
+// Optimistic Page Access
+
+// Function to look up a resident page without pinning it. Nothing shared is written, so readers don't contend with
+// each other. The page may be evicted or changed at any time, so page->data is only valid if validatePage() says so
+// after the caller is done reading it
+RC pinPageOptimistic (BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum, unsigned int *version) {
+    if(isSharedPool(bm, "Operation Optimistic Pin")) {
+        return RC_NOT_ENABLED;
+    }
+
+    Partition *part = partitionOf((PoolMgmt*) bm->mgmtData, MAIN_FILE_ID, pageNum);
+
+    // Number of frames is loaded first. resizeBufferPool() publishes a larger frame array before its larger size
+    unsigned int tableSeq = __atomic_load_n(&part->tableSeq, __ATOMIC_ACQUIRE);
+    int numFrames = __atomic_load_n(&part->numFrames, __ATOMIC_ACQUIRE);
+    FrameTable *ft = __atomic_load_n(&part->table, __ATOMIC_ACQUIRE);
+
+    for(int frame = 0; frame < numFrames; frame++) {
+        unsigned int before = __atomic_load_n(&ft->frames[frame].version, __ATOMIC_ACQUIRE);
+
+        if(__atomic_load_n(&ft->pageNos[frame], __ATOMIC_RELAXED) != pageNum
+                || __atomic_load_n(&ft->fileIds[frame], __ATOMIC_RELAXED) != MAIN_FILE_ID) {
+            continue;
+        }
+
+        // Page number only belongs to the frame if no change was in progress or happened while reading it, and the
+        // table wasn't written by a resize meanwhile
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if((before & 1) != 0 || __atomic_load_n(&ft->frames[frame].version, __ATOMIC_RELAXED) != before
+                || (tableSeq & 1) != 0 || __atomic_load_n(&part->tableSeq, __ATOMIC_RELAXED) != tableSeq) {
+            break;
+        }
+
+        page->data = ft->frames[frame].pageData;
+        page->pageNum = pageNum;
+        page->fileId = MAIN_FILE_ID;
+        page->frameNum = part->firstFrame + frame;
+        page->frameGen = ft->frames[frame].generation;
+        *version = before;
+
+        return RC_OK;
+    }
+
+    // Page is not in the buffer or is being loaded. Caller has to use pinPage()
+    return RC_PAGE_NOT_RESIDENT;
+}
+
+// Function to check if a page returned by pinPageOptimistic() is unchanged since then
+bool validatePage (BM_BufferPool *const bm, BM_PageHandle *const page, unsigned int version) {
+    if(isSharedPool(bm, "Operation Validate")) {
+        return false;
+    }
+
+    Partition *part = partitionOf((PoolMgmt*) bm->mgmtData, page->fileId, page->pageNum);
+
+    // Frame is found from the handle without a search. If the pool was resized since, frames may have moved and the
+    // handle points to a frame with other page data, which fails the check
+    unsigned int tableSeq = __atomic_load_n(&part->tableSeq, __ATOMIC_ACQUIRE);
+    int numFrames = __atomic_load_n(&part->numFrames, __ATOMIC_ACQUIRE);
+    FrameTable *ft = __atomic_load_n(&part->table, __ATOMIC_ACQUIRE);
+    int frame = page->frameNum - part->firstFrame;
+    if(frame < 0 || frame >= numFrames || ft->frames[frame].pageData != page->data) {
+        return false;
+    }
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&ft->frames[frame].version, __ATOMIC_RELAXED) == version
+            && (tableSeq & 1) == 0 && __atomic_load_n(&part->tableSeq, __ATOMIC_RELAXED) == tableSeq;
+}
+
+// Statistics Interface
+
+// Function to fill caller owned arrays with the state of every frame in one pass. All partitions are latched for the
+// copy, so the snapshot is consistent even while other threads use the pool. Arrays set to NULL are skipped
+RC getPoolSnapshot (BM_BufferPool *const bm, BM_PoolSnapshot *const snapshot) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+    int numFrames = 0;
+
+    if(pool->shared != NULL) {
+        return readSharedPool(pool->shared, snapshot);
+    }
+
+    for(int p = 0; p < pool->numParts; p++) {
+        pthread_mutex_lock(&pool->parts[p]->latch);
+        numFrames += pool->parts[p]->numFrames;
+    }
+
+    // Pool size is counted under the latches, since resizeBufferPool() may change it
+    snapshot->numFrames = numFrames;
+    if(snapshot->capacity < numFrames) {
+        for(int p = pool->numParts - 1; p >= 0; p--) {
+            pthread_mutex_unlock(&pool->parts[p]->latch);
+        }
+
+        printf("Operation Snapshot: Snapshot holds %d frames but pool has %d.\n", snapshot->capacity, numFrames);
+        return RC_BUFFER_TOO_SMALL;
+    }
+
+    int pos = 0;
+    for(int p = 0; p < pool->numParts; p++) {
+        Partition *part = pool->parts[p];
+        FrameTable *ft = part->table;
+
+        for(int frame = 0; frame < part->numFrames; frame++, pos++) {
+
+            if(snapshot->pageNums != NULL) {
+                snapshot->pageNums[pos] = ft->pageNos[frame];
+            }
+            if(snapshot->dirtyFlags != NULL) {
+                snapshot->dirtyFlags[pos] = ft->dirtyFlags[frame];
+            }
+            if(snapshot->fixCounts != NULL) {
+                snapshot->fixCounts[pos] = ft->pinCnts[frame];
+            }
+            if(snapshot->fileIds != NULL) {
+                snapshot->fileIds[pos] = ft->fileIds[frame];
+            }
+        }
+    }
+
+    pthread_mutex_lock(&pool->ioLatch);
+    snapshot->numReadIO = pool->readCnt;
+    snapshot->numWriteIO = pool->writeCnt;
+    pthread_mutex_unlock(&pool->ioLatch);
+
+    for(int p = pool->numParts - 1; p >= 0; p--) {
+        pthread_mutex_unlock(&pool->parts[p]->latch);
+    }
+
+    return RC_OK;
+}
+
+// Function to set up a snapshot which fills the given arrays of capacity frames
+void initPoolSnapshot (BM_PoolSnapshot *const snapshot, PageNumber *pageNums, bool *dirtyFlags, int *fixCounts, int capacity) {
+    snapshot->capacity = capacity;
+    snapshot->numFrames = 0;
+    snapshot->pageNums = pageNums;
+    snapshot->dirtyFlags = dirtyFlags;
+    snapshot->fixCounts = fixCounts;
+    snapshot->fileIds = NULL;
+    snapshot->numReadIO = 0;
+    snapshot->numWriteIO = 0;
+}
+
+// Funtion to Get page numbers pinned to each frame
+PageNumber *getFrameContents (BM_BufferPool *const bm) {
+    PageNumber *pageNos = NULL;
+    BM_PoolSnapshot snapshot;
+    int capacity = bm->numPages;
+    RC rc;
+
+    // Pool may be resized between allocating and copying, so retry with the frame count the snapshot saw
+    do {
+        free(pageNos);
+        pageNos = (PageNumber*)malloc(sizeof(PageNumber)*capacity);
+        initPoolSnapshot(&snapshot, pageNos, NULL, NULL, capacity);
+        rc = getPoolSnapshot(bm, &snapshot);
+        capacity = snapshot.numFrames;
+    } while(rc == RC_BUFFER_TOO_SMALL);
+
+    if(rc != RC_OK) {
+        free(pageNos);
+        return NULL;
+    }
+
+    return pageNos;
+}
+
+// Funtion to Get dirty flags of pages pinned to each frame
+bool *getDirtyFlags (BM_BufferPool *const bm) {
+    bool *dirtyFlags = NULL;
+    BM_PoolSnapshot snapshot;
+    int capacity = bm->numPages;
+    RC rc;
+
+    do {
+        free(dirtyFlags);
+        dirtyFlags = (bool*)malloc(sizeof(bool)*capacity);
+        initPoolSnapshot(&snapshot, NULL, dirtyFlags, NULL, capacity);
+        rc = getPoolSnapshot(bm, &snapshot);
+        capacity = snapshot.numFrames;
+    } while(rc == RC_BUFFER_TOO_SMALL);
+
+    if(rc != RC_OK) {
+        free(dirtyFlags);
+        return NULL;
+    }
+
+    return dirtyFlags;
+}
+
+// Funtion to Get fix counts of pages pinned to each frame
+int *getFixCounts (BM_BufferPool *const bm) {
+    int *pinCnts = NULL;
+    BM_PoolSnapshot snapshot;
+    int capacity = bm->numPages;
+    RC rc;
+
+    do {
+        free(pinCnts);
+        pinCnts = (int*)malloc(sizeof(int)*capacity);
+        initPoolSnapshot(&snapshot, NULL, NULL, pinCnts, capacity);
+        rc = getPoolSnapshot(bm, &snapshot);
+        capacity = snapshot.numFrames;
+    } while(rc == RC_BUFFER_TOO_SMALL);
+
+    if(rc != RC_OK) {
+        free(pinCnts);
+        return NULL;
+    }
+
+    return pinCnts;
+}
+
+// Funtion to Get count of how many times page read has been done from disk
 int getNumReadIO (BM_BufferPool *const bm) {
-    return readCnt;
+    BM_PoolSnapshot snapshot;
+
+    if(((PoolMgmt*) bm->mgmtData)->shared != NULL) {
+        initPoolSnapshot(&snapshot, NULL, NULL, NULL, bm->numPages);
+        readSharedPool(((PoolMgmt*) bm->mgmtData)->shared, &snapshot);
+        return snapshot.numReadIO;
+    }
+
+    return ((PoolMgmt*) bm->mgmtData)->readCnt;
 }
 
 // Funtion to Get count of how many times page write has been done in disk
 int getNumWriteIO (BM_BufferPool *const bm) {
-    return writeCnt;
+    BM_PoolSnapshot snapshot;
+
+    if(((PoolMgmt*) bm->mgmtData)->shared != NULL) {
+        initPoolSnapshot(&snapshot, NULL, NULL, NULL, bm->numPages);
+        readSharedPool(((PoolMgmt*) bm->mgmtData)->shared, &snapshot);
+        return snapshot.numWriteIO;
+    }
+
+    return ((PoolMgmt*) bm->mgmtData)->writeCnt;
+}
+
+// Funtion to Get count of how many missed pages were restored from the victim cache instead of disk
+int getNumVictimHits (BM_BufferPool *const bm) {
+    return getVictimHits(((PoolMgmt*) bm->mgmtData)->victimCache);
+}
+
+// Funtion to Get count of how many missed pages were not found in the victim cache either
+int getNumVictimMisses (BM_BufferPool *const bm) {
+    return getVictimMisses(((PoolMgmt*) bm->mgmtData)->victimCache);
+}
+
+// Funtion to write the page accesses recorded by the tracer to a trace file (see trace_replay.c)
+RC dumpPageTrace (BM_BufferPool *const bm, const char *fileName) {
+    return writePageTrace(((PoolMgmt*) bm->mgmtData)->trace, fileName);
+}
+
+// Funtion to estimate the miss ratio the pool would have with each of the given numbers of frames (LRU replacement)
+RC getMissRatioCurve (BM_BufferPool *const bm, const int *sizes, double *missRatios, const int numSizes) {
+    PoolMgmt *pool = (PoolMgmt*) bm->mgmtData;
+
+    if(pool->mrc == NULL) {
+        printf("Operation Miss Ratio Curve: Estimation is not enabled for this pool.\n");
+        return RC_NOT_ENABLED;
+    }
+
+    estimateMissRatios(pool->mrc, sizes, missRatios, numSizes);
+    return RC_OK;
+}
+
+// Funtion to Get hit, miss, eviction and I/O counts and latency percentiles, summed up over all threads
+void getPoolMetrics (BM_BufferPool *const bm, BM_PoolMetrics *const metrics) {
+    readPoolMetrics(((PoolMgmt*) bm->mgmtData)->metrics, metrics);
 }
@@ -7,6 +7,8 @@
 // Include bool DT
 #include "dt.h"
 
+#include <stdint.h>
+
 // Replacement Strategies
 typedef enum ReplacementStrategy {
 	RS_FIFO = 0,
@@ -20,6 +22,10 @@ typedef enum ReplacementStrategy {
 typedef int PageNumber;
 #define NO_PAGE -1
 
+// Page files sharing a pool. File 0 is the file the pool was initialized with
+#define MAIN_FILE_ID 0
+#define MAX_POOL_FILES 1024
+
 typedef struct BM_BufferPool {
 	char *pageFile;
 	int numPages;
@@ -28,24 +34,154 @@ typedef struct BM_BufferPool {
 	// manager needs for a buffer pool
 } BM_BufferPool;
 
+// Page sizes for the memory holding page data
+typedef enum BM_HugePages {
+	HUGE_PAGES_NONE = 0, // normal 4 KB pages
+	HUGE_PAGES_TRANSPARENT = 1, // 2 MB transparent huge pages where the kernel can provide them
+	HUGE_PAGES_EXPLICIT = 2 // 2 MB pages from the reserved huge page pool, transparent huge pages if it is empty
+} BM_HugePages;
+
+// Optional pool features for initBufferPoolWithOptions. Use initPoolOptions to get the defaults
+typedef struct BM_PoolOptions {
+	int victimCacheBytes; // memory for compressed copies of evicted pages (0 = no victim cache)
+	int numPartitions; // frames are split into partitions with their own latch and replacement (0 = one per NUMA node)
+	int traceRecords; // size of the ring buffer recording pins, unpins and markDirty calls (0 = no tracing)
+	int mrcSampledPages; // most pages sampled to estimate the miss ratio curve (0 = no estimation)
+	const char *warmStartFile; // hot page file reloaded at init and written at shutdown (NULL = cold start)
+	int warmSaveSeconds; // also write the hot page file this often from a background thread (0 = only at shutdown)
+	BM_HugePages hugePages; // page size for page data
+	bool lockMemory; // mlock frames and page data so they are never swapped out
+	int pinWaitMillis; // time pinPage waits for a frame when all frames are pinned (0 = fail at once, -1 = no limit)
+	bool trackPins; // record which client holds each pin, for reportLeakedPins
+	int maxPinsPerClient; // most pins a client may hold at once (0 = no limit). Tracks pins as well
+	int readAheadPages; // pages read after a page pinned with HINT_SEQUENTIAL (0 = no read-ahead)
+	const char *sharedName; // POSIX shared memory name of a pool shared by all processes opening it (NULL = private pool)
+	const char *tierFileName; // local page file caching pages of the pool's page file below the pool (NULL = no tier)
+	int tierPages; // pages the tier holds
+	bool tierWriteBack; // write pages only to the tier until it evicts them (false = also write the page file)
+} BM_PoolOptions;
+
 typedef struct BM_PageHandle {
 	PageNumber pageNum;
 	char *data;
+	int fileId; // registered page file the page belongs to, set by pinPage and pinFilePage. MAKE_PAGE_HANDLE starts
+	            // it at MAIN_FILE_ID, unpinPage, markDirty and forcePage reject ids which aren't registered
+	int frameNum; // frame the page was pinned to, set by pinPage
+	unsigned int frameGen; // generation of that frame, tells if the page was evicted since
 } BM_PageHandle;
 
+// Tenants sharing a pool. Pins without a context belong to the default tenant
+#define DEFAULT_TENANT 0
+#define MAX_TENANTS 64
+
+// Priority classes of pins. Unpinned pages loaded or hit by a higher class are only evicted once no page of a lower
+// class is left to evict
+typedef enum BM_Priority {
+	PRIORITY_LOW = 0,
+	PRIORITY_NORMAL = 1, // priority of pins without a context
+	PRIORITY_HIGH = 2
+} BM_Priority;
+
+// Tenant and priority class a pin is made for, passed to pinPageWithContext
+typedef struct BM_PinContext {
+	int tenant; // 0 to MAX_TENANTS - 1
+	BM_Priority priority;
+} BM_PinContext;
+
+// Access hints for pinPageWithHint and unpinPageWithHint
+typedef enum BM_PageHint {
+	HINT_NONE = 0,
+	HINT_DONTNEED = 1, // page won't be used again soon, evict it before all others
+	HINT_KEEP = 2, // page is hot, evict it only once no other page can be evicted
+	HINT_SEQUENTIAL = 3 // page is part of a scan: read the following pages ahead on pin, drop it like DONTNEED on unpin
+} BM_PageHint;
+
+// Pins and frames of a tenant, filled by getTenantStats
+typedef struct BM_TenantStats {
+	uint64_t hits;
+	uint64_t misses;
+	int numFrames; // frames holding a page the tenant loaded
+} BM_TenantStats;
+
+// State of all frames, filled by getPoolSnapshot into arrays owned by the caller (arrays left NULL are skipped)
+typedef struct BM_PoolSnapshot {
+	int capacity; // number of frames the arrays can hold
+	int numFrames; // number of frames in the pool
+	PageNumber *pageNums;
+	bool *dirtyFlags;
+	int *fixCounts;
+	int *fileIds;
+	int numReadIO;
+	int numWriteIO;
+} BM_PoolSnapshot;
+
+// Counters kept by the pool metrics. All counts are 64 bit, so they don't overflow on long running pools
+typedef enum BM_MetricCounter {
+	METRIC_HITS = 0, // pins of pages already in the buffer
+	METRIC_MISSES = 1, // pins which had to load the page
+	METRIC_CLEAN_EVICTIONS = 2, // pages dropped from a frame without a write
+	METRIC_DIRTY_EVICTIONS = 3, // pages written back before their frame was reused
+	METRIC_PIN_FAILURES = 4, // pins which failed because all frames were pinned
+	METRIC_FLUSHES = 5, // dirty pages written by forcePage or forceFlushPool
+	METRIC_READS = 6, // pages read from disk
+	METRIC_WRITES = 7, // pages written to disk
+	METRIC_PIN_WAITS = 8, // pins which waited for a frame because all frames were pinned
+	METRIC_READ_WAITS = 9, // pins which waited for another pin's read of the same page instead of reading it again
+	NUM_METRIC_COUNTERS = 10
+} BM_MetricCounter;
+
+// Operations whose latency is recorded in a histogram
+typedef enum BM_MetricLatency {
+	LATENCY_PIN_HIT = 0,
+	LATENCY_PIN_MISS = 1,
+	LATENCY_WRITE_BLOCK = 2,
+	NUM_METRIC_LATENCIES = 3
+} BM_MetricLatency;
+
+// Summary of a latency histogram. Percentiles are exact to within 12.5%
+typedef struct BM_LatencySummary {
+	uint64_t count;
+	uint64_t sumNanos;
+	uint64_t p50Nanos;
+	uint64_t p90Nanos;
+	uint64_t p99Nanos;
+	uint64_t p999Nanos;
+	uint64_t maxNanos;
+} BM_LatencySummary;
+
+// Metrics of a pool, filled by getPoolMetrics
+typedef struct BM_PoolMetrics {
+	uint64_t counters[NUM_METRIC_COUNTERS];
+	BM_LatencySummary latencies[NUM_METRIC_LATENCIES];
+} BM_PoolMetrics;
+
 // convenience macros
 #define MAKE_POOL()					\
 		((BM_BufferPool *) malloc (sizeof(BM_BufferPool)))
 
 #define MAKE_PAGE_HANDLE()				\
-		((BM_PageHandle *) malloc (sizeof(BM_PageHandle)))
+		((BM_PageHandle *) calloc (1, sizeof(BM_PageHandle)))
 
 // Buffer Manager Interface Pool Handling
 RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName, 
 		const int numPages, ReplacementStrategy strategy,
 		void *stratData);
+RC initBufferPoolWithOptions(BM_BufferPool *const bm, const char *const pageFileName,
+		const int numPages, ReplacementStrategy strategy,
+		void *stratData, const BM_PoolOptions *const opts);
+void initPoolOptions(BM_PoolOptions *const opts);
 RC shutdownBufferPool(BM_BufferPool *const bm);
 RC forceFlushPool(BM_BufferPool *const bm);
+RC resizeBufferPool(BM_BufferPool *const bm, const int newNumPages);
+
+// Buffer Manager Interface Warm Restart
+RC saveHotPages(BM_BufferPool *const bm, const char *fileName);
+RC loadHotPages(BM_BufferPool *const bm, const char *fileName);
+
+// Buffer Manager Interface Multiple Page Files
+RC registerPageFile(BM_BufferPool *const bm, char *fileName, int *fileId);
+RC unregisterPageFile(BM_BufferPool *const bm, const int fileId);
+RC flushPageFile(BM_BufferPool *const bm, const int fileId);
 
 // Buffer Manager Interface Access Pages
 RC markDirty (BM_BufferPool *const bm, BM_PageHandle *const page);
@@ -53,12 +189,60 @@ RC unpinPage (BM_BufferPool *const bm, BM_PageHandle *const page);
 RC forcePage (BM_BufferPool *const bm, BM_PageHandle *const page);
 RC pinPage (BM_BufferPool *const bm, BM_PageHandle *const page, 
 		const PageNumber pageNum);
+RC repinPage (BM_BufferPool *const bm, BM_PageHandle *const page);
+RC pinPageWithContext (BM_BufferPool *const bm, BM_PageHandle *const page,
+		const int fileId, const PageNumber pageNum, const BM_PinContext *ctx);
+RC pinPageWithHint (BM_BufferPool *const bm, BM_PageHandle *const page,
+		const PageNumber pageNum, const BM_PageHint hint);
+RC unpinPageWithHint (BM_BufferPool *const bm, BM_PageHandle *const page,
+		const BM_PageHint hint);
+RC pinFilePage (BM_BufferPool *const bm, BM_PageHandle *const page,
+		const int fileId, const PageNumber pageNum);
+
+// Buffer Manager Interface Snapshot Reads (changes are made on a copy, which replaces the page when
+// the last update pin of the page is unpinned. Pins made before keep the old page until they unpin)
+RC pinPageForUpdate (BM_BufferPool *const bm, BM_PageHandle *const page,
+		const PageNumber pageNum);
+
+// Buffer Manager Interface Batched Access (pages is an array of numPages handles)
+RC pinPages (BM_BufferPool *const bm, BM_PageHandle *const pages,
+		const PageNumber *pageNums, const int numPages);
+RC unpinPages (BM_BufferPool *const bm, BM_PageHandle *const pages,
+		const int numPages);
+
+// Buffer Manager Interface Pin Tracking (a client is a thread unless it sets a client id of its own)
+void setPinClient (const int clientId);
+RC reportLeakedPins (BM_BufferPool *const bm, int *numPins);
+
+// Buffer Manager Interface Tenants (frame limits are for the whole pool, maxFrames 0 = no limit)
+RC setTenantQuota (BM_BufferPool *const bm, const int tenant,
+		const int reservedFrames, const int maxFrames);
+RC getTenantStats (BM_BufferPool *const bm, const int tenant,
+		BM_TenantStats *const stats);
+
+// Buffer Manager Interface Optimistic Reads (no pin, check validatePage after reading)
+// validatePage fails if the page was evicted, reloaded, marked dirty or replaced by a published update copy since
+// pinPageOptimistic. It does not see a client writing page data in place before its markDirty, so such a read may be
+// half written and still validate. Writers racing optimistic readers have to use pinPageForUpdate
+RC pinPageOptimistic (BM_BufferPool *const bm, BM_PageHandle *const page,
+		const PageNumber pageNum, unsigned int *version);
+bool validatePage (BM_BufferPool *const bm, BM_PageHandle *const page,
+		unsigned int version);
 
 // Statistics Interface
+RC getPoolSnapshot (BM_BufferPool *const bm, BM_PoolSnapshot *const snapshot);
+void initPoolSnapshot (BM_PoolSnapshot *const snapshot, PageNumber *pageNums,
+		bool *dirtyFlags, int *fixCounts, int capacity);
 PageNumber *getFrameContents (BM_BufferPool *const bm);
 bool *getDirtyFlags (BM_BufferPool *const bm);
 int *getFixCounts (BM_BufferPool *const bm);
 int getNumReadIO (BM_BufferPool *const bm);
 int getNumWriteIO (BM_BufferPool *const bm);
+int getNumVictimHits (BM_BufferPool *const bm);
+int getNumVictimMisses (BM_BufferPool *const bm);
+void getPoolMetrics (BM_BufferPool *const bm, BM_PoolMetrics *const metrics);
+RC dumpPageTrace (BM_BufferPool *const bm, const char *fileName);
+RC getMissRatioCurve (BM_BufferPool *const bm, const int *sizes,
+		double *missRatios, const int numSizes);
 
 #endif
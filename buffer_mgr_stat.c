@@ -4,53 +4,119 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+// names of the metrics in dumps
+static const char *counterNames[NUM_METRIC_COUNTERS] = {
+	"hits", "misses", "cleanEvictions", "dirtyEvictions", "pinFailures", "flushes", "reads", "writes", "pinWaits", "readWaits"
+};
+static const char *latencyNames[NUM_METRIC_LATENCIES] = {
+	"pinHit", "pinMiss", "writeBlock"
+};
+
 // local functions
+static double hitRatio (BM_PoolMetrics *metrics);
 static void printStrat (BM_BufferPool *const bm);
+static bool takeSnapshot (BM_BufferPool *const bm, BM_PoolSnapshot *snapshot);
+static void freeSnapshot (BM_PoolSnapshot *snapshot);
 
 // external functions
 void 
 printPoolContent (BM_BufferPool *const bm)
 {
-	PageNumber *frameContent;
-	bool *dirty;
-	int *fixCount;
+	BM_PoolSnapshot snapshot;
 	int i;
 
-	frameContent = getFrameContents(bm);
-	dirty = getDirtyFlags(bm);
-	fixCount = getFixCounts(bm);
+	if (!takeSnapshot(bm, &snapshot))
+		return;
 
 	printf("{");
 	printStrat(bm);
-	printf(" %i}: ", bm->numPages);
+	printf(" %i}: ", snapshot.numFrames);
 
-	for (i = 0; i < bm->numPages; i++)
-		printf("%s[%i%s%i]", ((i == 0) ? "" : ",") , frameContent[i], (dirty[i] ? "x": " "), fixCount[i]);
+	for (i = 0; i < snapshot.numFrames; i++)
+		printf("%s[%i%s%i]", ((i == 0) ? "" : ",") , snapshot.pageNums[i], (snapshot.dirtyFlags[i] ? "x": " "), snapshot.fixCounts[i]);
 	printf("\n");
+
+	freeSnapshot(&snapshot);
 }
 
 char *
 sprintPoolContent (BM_BufferPool *const bm)
 {
-	PageNumber *frameContent;
-	bool *dirty;
-	int *fixCount;
+	BM_PoolSnapshot snapshot;
 	int i;
 	char *message;
 	int pos = 0;
 
-	message = (char *) malloc(256 + (22 * bm->numPages));
-	frameContent = getFrameContents(bm);
-	dirty = getDirtyFlags(bm);
-	fixCount = getFixCounts(bm);
+	if (!takeSnapshot(bm, &snapshot))
+	{
+		message = (char *) malloc(1);
+		message[0] = '\0';
+		return message;
+	}
 
-	for (i = 0; i < bm->numPages; i++)
-		pos += sprintf(message + pos, "%s[%i%s%i]", ((i == 0) ? "" : ",") , frameContent[i], (dirty[i] ? "x": " "), fixCount[i]);
+	message = (char *) malloc(256 + (22 * snapshot.numFrames));
+	message[0] = '\0';
+	for (i = 0; i < snapshot.numFrames; i++)
+		pos += sprintf(message + pos, "%s[%i%s%i]", ((i == 0) ? "" : ",") , snapshot.pageNums[i], (snapshot.dirtyFlags[i] ? "x": " "), snapshot.fixCounts[i]);
 
+	freeSnapshot(&snapshot);
 	return message;
 }
 
 
+void
+printPoolMetrics (BM_BufferPool *const bm)
+{
+	BM_PoolMetrics metrics;
+	int i;
+
+	getPoolMetrics(bm, &metrics);
+
+	printf("{");
+	printStrat(bm);
+	printf(" %i} hit ratio: %.4f\n", bm->numPages, hitRatio(&metrics));
+
+	for (i = 0; i < NUM_METRIC_COUNTERS; i++)
+		printf("  %-16s %llu\n", counterNames[i], (unsigned long long) metrics.counters[i]);
+
+	for (i = 0; i < NUM_METRIC_LATENCIES; i++)
+	{
+		BM_LatencySummary *l = &metrics.latencies[i];
+		printf("  %-16s count %llu p50 %lluns p90 %lluns p99 %lluns p99.9 %lluns max %lluns\n", latencyNames[i],
+				(unsigned long long) l->count, (unsigned long long) l->p50Nanos, (unsigned long long) l->p90Nanos,
+				(unsigned long long) l->p99Nanos, (unsigned long long) l->p999Nanos, (unsigned long long) l->maxNanos);
+	}
+}
+
+char *
+sprintPoolMetricsJSON (BM_BufferPool *const bm)
+{
+	BM_PoolMetrics metrics;
+	int i;
+	char *message;
+	int pos = 0;
+
+	getPoolMetrics(bm, &metrics);
+	message = (char *) malloc(256 + (48 * NUM_METRIC_COUNTERS) + (256 * NUM_METRIC_LATENCIES));
+
+	pos += sprintf(message + pos, "{\"numPages\":%i,\"hitRatio\":%.4f,\"counters\":{", bm->numPages, hitRatio(&metrics));
+	for (i = 0; i < NUM_METRIC_COUNTERS; i++)
+		pos += sprintf(message + pos, "%s\"%s\":%llu", ((i == 0) ? "" : ","), counterNames[i], (unsigned long long) metrics.counters[i]);
+
+	pos += sprintf(message + pos, "},\"latencies\":{");
+	for (i = 0; i < NUM_METRIC_LATENCIES; i++)
+	{
+		BM_LatencySummary *l = &metrics.latencies[i];
+		pos += sprintf(message + pos, "%s\"%s\":{\"count\":%llu,\"sumNanos\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu}",
+				((i == 0) ? "" : ","), latencyNames[i], (unsigned long long) l->count, (unsigned long long) l->sumNanos,
+				(unsigned long long) l->p50Nanos, (unsigned long long) l->p90Nanos, (unsigned long long) l->p99Nanos,
+				(unsigned long long) l->p999Nanos, (unsigned long long) l->maxNanos);
+	}
+	sprintf(message + pos, "}}");
+
+	return message;
+}
+
 void
 printPageContent (BM_PageHandle *const page)
 {
@@ -78,6 +144,14 @@ sprintPageContent (BM_PageHandle *const page)
 	return message;
 }
 
+double
+hitRatio (BM_PoolMetrics *metrics)
+{
+	uint64_t pins = metrics->counters[METRIC_HITS] + metrics->counters[METRIC_MISSES];
+
+	return (pins == 0) ? 0.0 : (double) metrics->counters[METRIC_HITS] / pins;
+}
+
 void
 printStrat (BM_BufferPool *const bm)
 {
@@ -103,3 +177,36 @@ printStrat (BM_BufferPool *const bm)
 		break;
 	}
 }
+
+// take one consistent snapshot of all frames into arrays released by freeSnapshot
+bool
+takeSnapshot (BM_BufferPool *const bm, BM_PoolSnapshot *snapshot)
+{
+	int capacity = bm->numPages;
+	RC rc;
+
+	// the pool may be resized before the copy, then retry with the size the snapshot saw
+	do
+	{
+		initPoolSnapshot(snapshot,
+				(PageNumber *) malloc(sizeof(PageNumber) * capacity),
+				(bool *) malloc(sizeof(bool) * capacity),
+				(int *) malloc(sizeof(int) * capacity),
+				capacity);
+
+		rc = getPoolSnapshot(bm, snapshot);
+		capacity = snapshot->numFrames;
+		if (rc != RC_OK)
+			freeSnapshot(snapshot);
+	} while (rc == RC_BUFFER_TOO_SMALL);
+
+	return rc == RC_OK;
+}
+
+void
+freeSnapshot (BM_PoolSnapshot *snapshot)
+{
+	free(snapshot->pageNums);
+	free(snapshot->dirtyFlags);
+	free(snapshot->fixCounts);
+}
@@ -9,4 +9,8 @@ void printPageContent (BM_PageHandle *const page);
 char *sprintPoolContent (BM_BufferPool *const bm);
 char *sprintPageContent (BM_PageHandle *const page);
 
+// metrics dumps
+void printPoolMetrics (BM_BufferPool *const bm);
+char *sprintPoolMetricsJSON (BM_BufferPool *const bm);
+
 #endif
@@ -14,6 +14,20 @@ typedef int RC;
 #define RC_FILE_HANDLE_NOT_INIT 2
 #define RC_WRITE_FAILED 3
 #define RC_READ_NON_EXISTING_PAGE 4
+#define RC_OUT_OF_MEMORY 5
+#define RC_PAGE_NOT_RESIDENT 6
+#define RC_BUFFER_TOO_SMALL 7
+#define RC_BAD_TRACE_FILE 8
+#define RC_NOT_ENABLED 9
+#define RC_RESIZE_INCOMPLETE 10
+#define RC_BAD_HOT_PAGE_FILE 11
+#define RC_PIN_TIMEOUT 12
+#define RC_PIN_LIMIT 13
+#define RC_PAGE_NOT_PINNED 14
+#define RC_BAD_TENANT 15
+#define RC_TENANT_QUOTA 16
+#define RC_SHARED_POOL 17
+#define RC_TIER_FAILED 18
 
 #define RC_RM_COMPARE_VALUE_OF_DIFFERENT_DATATYPE 200
 #define RC_RM_EXPR_RESULT_IS_NOT_BOOLEAN 201
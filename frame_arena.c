@@ -0,0 +1,171 @@
+/*
+frame_arena.c
+Author: Pradyumna Deshpande
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#ifdef __linux__
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/syscall.h>
+#endif
+
+#include "frame_arena.h"
+
+// Memory policy for mbind (same value as in linux/mempolicy.h)
+#define ARENA_MPOL_BIND 2
+
+// Function to parse a node list like "0-1,3" and count the nodes in it
+static int countNodes(char *list) {
+    int count = 0;
+    char *range = strtok(list, ",\n");
+
+    while(range != NULL) {
+        int first, last;
+        int parsed = sscanf(range, "%d-%d", &first, &last);
+
+        if(parsed == 2 && last >= first) {
+            count += last - first + 1;
+        } else if(parsed >= 1) {
+            count++;
+        }
+
+        range = strtok(NULL, ",\n");
+    }
+
+    return count;
+}
+
+// Function to get the number of online NUMA nodes. Machines without NUMA information count as a single node
+int getNumNumaNodes(void) {
+    FILE *nodes = fopen("/sys/devices/system/node/online", "r");
+    if(nodes == NULL) {
+        return 1;
+    }
+
+    char list[256];
+    int count = 0;
+
+    if(fgets(list, sizeof(list), nodes) != NULL) {
+        count = countNodes(list);
+    }
+
+    fclose(nodes);
+
+    return count > 0 ? count : 1;
+}
+
+// Function to get the size an arena is mapped with. Huge page arenas are whole huge pages
+static size_t arenaMapSize(size_t size, int flags) {
+    if(flags & (ARENA_TRANSPARENT_HUGE | ARENA_EXPLICIT_HUGE)) {
+        return (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+    return size;
+}
+
+#ifdef __linux__
+// Function to map memory starting on a huge page boundary, so the kernel can back all of it with transparent huge pages
+static void *mapHugeAligned(size_t size) {
+    char *map = (char*) mmap(NULL, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(map == MAP_FAILED) {
+        return NULL;
+    }
+
+    // Unaligned head and the rest of the tail are unmapped again
+    size_t head = (HUGE_PAGE_SIZE - (size_t) map % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+    if(head > 0) {
+        munmap(map, head);
+    }
+    munmap(map + head + size, HUGE_PAGE_SIZE - head);
+
+#ifdef MADV_HUGEPAGE
+    if(madvise(map + head, size, MADV_HUGEPAGE) != 0) {
+        printf("Frame Arena: Transparent huge pages are not available. Using normal pages.\n");
+    }
+#endif
+
+    return map + head;
+}
+#endif
+
+// Function to allocate zeroed memory for frames. If numaNode is given, the memory is bound to that node before it is
+// touched. Flags ask for huge pages and for locking the memory. Both are hints: the arena is still returned if the
+// system can't provide them
+void *allocFrameArena(size_t size, int numaNode, int flags) {
+    size = arenaMapSize(size, flags);
+
+#ifdef __linux__
+    void *arena = NULL;
+
+#ifdef MAP_HUGETLB
+    if(flags & ARENA_EXPLICIT_HUGE) {
+        arena = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(arena == MAP_FAILED) {
+            arena = NULL;
+            printf("Frame Arena: No free huge pages for %zu bytes. Trying transparent huge pages.\n", size);
+        }
+    }
+#endif
+
+    if(arena == NULL && (flags & (ARENA_TRANSPARENT_HUGE | ARENA_EXPLICIT_HUGE))) {
+        arena = mapHugeAligned(size);
+    } else if(arena == NULL) {
+        arena = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        arena = arena == MAP_FAILED ? NULL : arena;
+    }
+
+    if(arena == NULL) {
+        return NULL;
+    }
+
+#ifdef SYS_mbind
+    if(numaNode != NO_NUMA_NODE && numaNode < (int) (8 * sizeof(unsigned long))) {
+        unsigned long nodeMask = 1UL << numaNode;
+
+        // Binding is only a placement hint. If it fails, the memory is still usable from any node
+        if(syscall(SYS_mbind, arena, size, ARENA_MPOL_BIND, &nodeMask, 8 * sizeof(unsigned long), 0) != 0) {
+            printf("Frame Arena: Could not bind memory to NUMA node %d. Using default placement.\n", numaNode);
+        }
+    }
+#endif
+
+    // Locking also faults in the whole arena, so it is done after binding
+    if((flags & ARENA_LOCKED) && mlock(arena, size) != 0) {
+        printf("Frame Arena: Could not lock %zu bytes in memory (check RLIMIT_MEMLOCK). Memory may be swapped.\n", size);
+    }
+
+    return arena;
+#else
+    return calloc(1, size);
+#endif
+}
+
+// Function to free memory allocated by allocFrameArena with the same size and flags
+void freeFrameArena(void *arena, size_t size, int flags) {
+    if(arena == NULL) {
+        return;
+    }
+
+#ifdef __linux__
+    munmap(arena, arenaMapSize(size, flags));
+#else
+    free(arena);
+#endif
+}
+
+// Function to give the physical memory of a page aligned range back to the system. The range stays mapped and reads
+// as zeros until it is written again. Locked and explicit huge page memory can't be given back this way, so it is
+// only cleared and reused by later grows
+void releaseFrameMemory(void *addr, size_t size) {
+#ifdef __linux__
+    if(madvise(addr, size, MADV_DONTNEED) != 0) {
+        memset(addr, 0, size);
+    }
+#else
+    memset(addr, 0, size);
+#endif
+}
@@ -0,0 +1,28 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <stddef.h>
+
+// Node value for memory that is not bound to a NUMA node
+#define NO_NUMA_NODE -1
+
+// Flags for allocFrameArena. Arenas with huge pages are rounded up to whole huge pages
+#define ARENA_TRANSPARENT_HUGE 1	// ask the kernel to back the arena with transparent huge pages
+#define ARENA_EXPLICIT_HUGE 2	// map the arena from the huge page pool, transparent huge pages if it is empty
+#define ARENA_LOCKED 4	// lock the arena in memory so it is never swapped out
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define CACHE_LINE_SIZE 64
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+/* NUMA topology */
+extern int getNumNumaNodes (void);
+
+/* page aligned memory for frames, optionally bound to a NUMA node */
+extern void *allocFrameArena (size_t size, int numaNode, int flags);
+extern void freeFrameArena (void *arena, size_t size, int flags);
+extern void releaseFrameMemory (void *addr, size_t size);
+
+#endif
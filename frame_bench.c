@@ -0,0 +1,113 @@
+/*
+frame_bench.c
+Author: Pradyumna Deshpande
+*/
+
+// Microbenchmark for the frame scans of the buffer manager. Hits measure the page lookup over all frames of a large
+// partition, misses add the search for an empty frame and the victim search of the replacement strategy.
+// Usage: frame_bench [frames] [operations]
+// Prints one CSV line per operation, strategy and frame search instruction set with the time per pin.
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<time.h>
+#include<unistd.h>
+
+#include "storage_mgr.h"
+#include "buffer_mgr.h"
+#include "frame_search.h"
+
+#define BENCH_PAGE_FILE "frame_bench.bin"
+#define NUM_STRATEGIES 4
+
+static const ReplacementStrategy strategies[NUM_STRATEGIES] = {RS_FIFO, RS_LRU, RS_CLOCK, RS_LFU};
+static const char *strategyNames[NUM_STRATEGIES] = {"FIFO", "LRU", "CLOCK", "LFU"};
+static const char *searchNames[] = {"scalar", "avx2", "avx512"};
+
+static double nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Function to time pins of random pages on a pool holding one partition of numFrames frames. Pages are drawn from
+// numFrames pages for hits and from twice as many pages, offset so none is resident, for misses
+static double timePins(ReplacementStrategy strategy, int numFrames, int numOps, bool misses) {
+    BM_BufferPool bm;
+    BM_PageHandle h;
+    BM_PoolOptions opts;
+    unsigned int seed = 42;
+
+    initPoolOptions(&opts);
+    if(initBufferPoolWithOptions(&bm, BENCH_PAGE_FILE, numFrames, strategy, NULL, &opts) != RC_OK) {
+        return -1;
+    }
+
+    for(int i = 0; i < numFrames; i++) {
+        pinPage(&bm, &h, i);
+        unpinPage(&bm, &h);
+    }
+
+    double start = nowNanos();
+
+    for(int i = 0; i < numOps; i++) {
+        PageNumber pageNum = misses ? numFrames + (i % (2 * numFrames)) : rand_r(&seed) % numFrames;
+
+        // Handle doesn't know the frame, so every pin searches the partition
+        h.frameNum = -1;
+        pinPage(&bm, &h, pageNum);
+        unpinPage(&bm, &h);
+    }
+
+    double elapsed = nowNanos() - start;
+
+    shutdownBufferPool(&bm);
+    return elapsed / numOps;
+}
+
+int main(int argc, char *argv[]) {
+    int numFrames = argc > 1 ? atoi(argv[1]) : 4096;
+    int numOps = argc > 2 ? atoi(argv[2]) : 200000;
+    SM_FileHandle fHandle;
+
+    if(numFrames <= 0 || numOps <= 0) {
+        fprintf(stderr, "Usage: %s [frames] [operations]\n", argv[0]);
+        return 1;
+    }
+
+    // Results go to the original stdout. The buffer manager's own logging is discarded while measuring
+    fflush(stdout);
+    FILE *results = fdopen(dup(STDOUT_FILENO), "w");
+    if(results == NULL || freopen("/dev/null", "w", stdout) == NULL) {
+        fprintf(stderr, "Could not redirect buffer manager output.\n");
+        return 1;
+    }
+
+    initStorageManager();
+    createPageFile(BENCH_PAGE_FILE);
+    openPageFile(BENCH_PAGE_FILE, &fHandle);
+    ensureCapacity(3 * numFrames, &fHandle);
+    closePageFile(&fHandle);
+
+    fprintf(results, "operation,strategy,search,frames,ops,nsPerPin\n");
+
+    // Every instruction set up to the best one of this CPU is measured
+    initFrameSearch();
+    SearchLevel best = getFrameSearchLevel();
+
+    for(int s = 0; s < NUM_STRATEGIES; s++) {
+        for(int level = SEARCH_SCALAR; level <= best; level++) {
+            setFrameSearchLevel(level);
+
+            fprintf(results, "hit,%s,%s,%d,%d,%.1f\n", strategyNames[s], searchNames[level], numFrames, numOps,
+                    timePins(strategies[s], numFrames, numOps, false));
+            fprintf(results, "miss,%s,%s,%d,%d,%.1f\n", strategyNames[s], searchNames[level], numFrames, numOps / 4,
+                    timePins(strategies[s], numFrames, numOps / 4, true));
+        }
+    }
+
+    destroyPageFile(BENCH_PAGE_FILE);
+    fclose(results);
+
+    return 0;
+}
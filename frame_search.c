@@ -0,0 +1,281 @@
+/*
+frame_search.c
+Author: Pradyumna Deshpande
+*/
+
+#include<limits.h>
+#include<pthread.h>
+
+#include "frame_search.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SEARCH
+#include<immintrin.h>
+#endif
+
+// Struct for the search functions of one instruction set
+typedef struct SearchKernels {
+    int (*findValue)(const int *values, int start, int numFrames, int value);
+    int (*findMinUnpinned)(const int *pinCnts, const int *keys, int numFrames);
+    int (*findMinUnpinnedPair)(const int *pinCnts, const int *firstKeys, const int *secondKeys, int numFrames);
+} SearchKernels;
+
+static pthread_once_t searchOnce = PTHREAD_ONCE_INIT;
+static SearchLevel bestLevel = SEARCH_SCALAR;
+static SearchLevel activeLevel = SEARCH_SCALAR;
+
+// Scalar Searches. Also used for the frames after the last full vector
+
+static int findValueScalar(const int *values, int start, int numFrames, int value) {
+    for(int frame = start; frame < numFrames; frame++) {
+        if(values[frame] == value) {
+            return frame;
+        }
+    }
+
+    return -1;
+}
+
+// Function to continue a pair search over frames start to numFrames. Best keys so far are passed in and updated. Only
+// strictly smaller keys replace them, so the first frame wins on ties
+static int findMinPairFrom(const int *pinCnts, const int *firstKeys, const int *secondKeys, int start, int numFrames,
+        int *bestFirst, int *bestSecond, int bestFrame) {
+    for(int frame = start; frame < numFrames; frame++) {
+        int second = secondKeys != NULL ? secondKeys[frame] : 0;
+
+        if(pinCnts[frame] == 0 && (firstKeys[frame] < *bestFirst || (firstKeys[frame] == *bestFirst && second < *bestSecond))) {
+            *bestFirst = firstKeys[frame];
+            *bestSecond = second;
+            bestFrame = frame;
+        }
+    }
+
+    return bestFrame;
+}
+
+static int findMinUnpinnedScalar(const int *pinCnts, const int *keys, int numFrames) {
+    int bestKey = INT_MAX;
+    int bestSecond = 0;
+
+    return findMinPairFrom(pinCnts, keys, NULL, 0, numFrames, &bestKey, &bestSecond, -1);
+}
+
+static int findMinUnpinnedPairScalar(const int *pinCnts, const int *firstKeys, const int *secondKeys, int numFrames) {
+    int bestFirst = INT_MAX;
+    int bestSecond = INT_MAX;
+
+    return findMinPairFrom(pinCnts, firstKeys, secondKeys, 0, numFrames, &bestFirst, &bestSecond, -1);
+}
+
+#ifdef HAVE_X86_SEARCH
+
+// Function to combine the best frame of each vector lane. Lanes found their frames in increasing order, so ties between
+// lanes go to the lower frame number like in the scalar search
+static int reduceLanes(const int *firstKeys, const int *secondKeys, const int *frames, int numLanes, int *bestFirst, int *bestSecond) {
+    int bestFrame = -1;
+
+    for(int lane = 0; lane < numLanes; lane++) {
+        if(frames[lane] == -1) {
+            continue;
+        }
+
+        if(bestFrame == -1 || firstKeys[lane] < *bestFirst || (firstKeys[lane] == *bestFirst
+                && (secondKeys[lane] < *bestSecond || (secondKeys[lane] == *bestSecond && frames[lane] < bestFrame)))) {
+            *bestFirst = firstKeys[lane];
+            *bestSecond = secondKeys[lane];
+            bestFrame = frames[lane];
+        }
+    }
+
+    return bestFrame;
+}
+
+// AVX2 Searches (8 frames per vector)
+
+__attribute__((target("avx2")))
+static int findValueAvx2(const int *values, int start, int numFrames, int value) {
+    __m256i wanted = _mm256_set1_epi32(value);
+    int frame = start;
+
+    for(; frame + 8 <= numFrames; frame += 8) {
+        __m256i found = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*) (values + frame)), wanted);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(found));
+
+        if(mask != 0) {
+            return frame + __builtin_ctz(mask);
+        }
+    }
+
+    return findValueScalar(values, frame, numFrames, value);
+}
+
+// Function for the lane-wise pair search. Each lane keeps the smallest keys of the unpinned frames it saw. Without
+// second keys the second key of every frame is 0
+__attribute__((target("avx2")))
+static int findMinPairAvx2(const int *pinCnts, const int *firstKeys, const int *secondKeys, int numFrames, int bestSecondInit) {
+    __m256i bestFirst = _mm256_set1_epi32(INT_MAX);
+    __m256i bestSecond = _mm256_set1_epi32(bestSecondInit);
+    __m256i bestFrames = _mm256_set1_epi32(-1);
+    __m256i frames = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i step = _mm256_set1_epi32(8);
+    __m256i zero = _mm256_setzero_si256();
+    int frame = 0;
+
+    for(; frame + 8 <= numFrames; frame += 8) {
+        __m256i unpinned = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*) (pinCnts + frame)), zero);
+        __m256i first = _mm256_loadu_si256((const __m256i*) (firstKeys + frame));
+        __m256i second = secondKeys != NULL ? _mm256_loadu_si256((const __m256i*) (secondKeys + frame)) : zero;
+
+        __m256i smaller = _mm256_or_si256(_mm256_cmpgt_epi32(bestFirst, first),
+                _mm256_and_si256(_mm256_cmpeq_epi32(bestFirst, first), _mm256_cmpgt_epi32(bestSecond, second)));
+        __m256i take = _mm256_and_si256(unpinned, smaller);
+
+        bestFirst = _mm256_blendv_epi8(bestFirst, first, take);
+        bestSecond = _mm256_blendv_epi8(bestSecond, second, take);
+        bestFrames = _mm256_blendv_epi8(bestFrames, frames, take);
+        frames = _mm256_add_epi32(frames, step);
+    }
+
+    int laneFirst[8], laneSecond[8], laneFrames[8];
+    _mm256_storeu_si256((__m256i*) laneFirst, bestFirst);
+    _mm256_storeu_si256((__m256i*) laneSecond, bestSecond);
+    _mm256_storeu_si256((__m256i*) laneFrames, bestFrames);
+
+    int first = INT_MAX;
+    int second = bestSecondInit;
+    int best = reduceLanes(laneFirst, laneSecond, laneFrames, 8, &first, &second);
+
+    return findMinPairFrom(pinCnts, firstKeys, secondKeys, frame, numFrames, &first, &second, best);
+}
+
+static int findMinUnpinnedAvx2(const int *pinCnts, const int *keys, int numFrames) {
+    return findMinPairAvx2(pinCnts, keys, NULL, numFrames, 0);
+}
+
+static int findMinUnpinnedPairAvx2(const int *pinCnts, const int *firstKeys, const int *secondKeys, int numFrames) {
+    return findMinPairAvx2(pinCnts, firstKeys, secondKeys, numFrames, INT_MAX);
+}
+
+// AVX-512 Searches (16 frames per vector)
+
+__attribute__((target("avx512f")))
+static int findValueAvx512(const int *values, int start, int numFrames, int value) {
+    __m512i wanted = _mm512_set1_epi32(value);
+    int frame = start;
+
+    for(; frame + 16 <= numFrames; frame += 16) {
+        __mmask16 found = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const void*) (values + frame)), wanted);
+
+        if(found != 0) {
+            return frame + __builtin_ctz(found);
+        }
+    }
+
+    return findValueScalar(values, frame, numFrames, value);
+}
+
+__attribute__((target("avx512f")))
+static int findMinPairAvx512(const int *pinCnts, const int *firstKeys, const int *secondKeys, int numFrames, int bestSecondInit) {
+    __m512i bestFirst = _mm512_set1_epi32(INT_MAX);
+    __m512i bestSecond = _mm512_set1_epi32(bestSecondInit);
+    __m512i bestFrames = _mm512_set1_epi32(-1);
+    __m512i frames = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m512i step = _mm512_set1_epi32(16);
+    __m512i zero = _mm512_setzero_si512();
+    int frame = 0;
+
+    for(; frame + 16 <= numFrames; frame += 16) {
+        __mmask16 unpinned = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const void*) (pinCnts + frame)), zero);
+        __m512i first = _mm512_loadu_si512((const void*) (firstKeys + frame));
+        __m512i second = secondKeys != NULL ? _mm512_loadu_si512((const void*) (secondKeys + frame)) : zero;
+
+        __mmask16 smaller = _mm512_cmplt_epi32_mask(first, bestFirst)
+                | (_mm512_cmpeq_epi32_mask(first, bestFirst) & _mm512_cmplt_epi32_mask(second, bestSecond));
+        __mmask16 take = unpinned & smaller;
+
+        bestFirst = _mm512_mask_blend_epi32(take, bestFirst, first);
+        bestSecond = _mm512_mask_blend_epi32(take, bestSecond, second);
+        bestFrames = _mm512_mask_blend_epi32(take, bestFrames, frames);
+        frames = _mm512_add_epi32(frames, step);
+    }
+
+    int laneFirst[16], laneSecond[16], laneFrames[16];
+    _mm512_storeu_si512((void*) laneFirst, bestFirst);
+    _mm512_storeu_si512((void*) laneSecond, bestSecond);
+    _mm512_storeu_si512((void*) laneFrames, bestFrames);
+
+    int first = INT_MAX;
+    int second = bestSecondInit;
+    int best = reduceLanes(laneFirst, laneSecond, laneFrames, 16, &first, &second);
+
+    return findMinPairFrom(pinCnts, firstKeys, secondKeys, frame, numFrames, &first, &second, best);
+}
+
+static int findMinUnpinnedAvx512(const int *pinCnts, const int *keys, int numFrames) {
+    return findMinPairAvx512(pinCnts, keys, NULL, numFrames, 0);
+}
+
+static int findMinUnpinnedPairAvx512(const int *pinCnts, const int *firstKeys, const int *secondKeys, int numFrames) {
+    return findMinPairAvx512(pinCnts, firstKeys, secondKeys, numFrames, INT_MAX);
+}
+
+#endif
+
+static const SearchKernels kernels[] = {
+    {findValueScalar, findMinUnpinnedScalar, findMinUnpinnedPairScalar},
+#ifdef HAVE_X86_SEARCH
+    {findValueAvx2, findMinUnpinnedAvx2, findMinUnpinnedPairAvx2},
+    {findValueAvx512, findMinUnpinnedAvx512, findMinUnpinnedPairAvx512},
+#endif
+};
+
+// Function to find the best instruction set of this CPU
+static void detectSearchLevel(void) {
+#ifdef HAVE_X86_SEARCH
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx512f")) {
+        bestLevel = SEARCH_AVX512;
+    } else if(__builtin_cpu_supports("avx2")) {
+        bestLevel = SEARCH_AVX2;
+    }
+#endif
+
+    __atomic_store_n(&activeLevel, bestLevel, __ATOMIC_RELAXED);
+}
+
+// Function to pick the searches for this CPU. Called by every pool init, the detection only runs once
+void initFrameSearch(void) {
+    pthread_once(&searchOnce, detectSearchLevel);
+}
+
+SearchLevel getFrameSearchLevel(void) {
+    return __atomic_load_n(&activeLevel, __ATOMIC_RELAXED);
+}
+
+// Function to use a lower instruction set than the best one. Levels the CPU doesn't support are lowered to the best
+// one it does. Returns the level used from now on
+SearchLevel setFrameSearchLevel(SearchLevel level) {
+    initFrameSearch();
+
+    if(level > bestLevel) {
+        level = bestLevel;
+    } else if(level < SEARCH_SCALAR) {
+        level = SEARCH_SCALAR;
+    }
+
+    __atomic_store_n(&activeLevel, level, __ATOMIC_RELAXED);
+    return level;
+}
+
+int findValue(const int *values, int start, int numFrames, int value) {
+    return kernels[getFrameSearchLevel()].findValue(values, start, numFrames, value);
+}
+
+int findMinUnpinned(const int *pinCnts, const int *keys, int numFrames) {
+    return kernels[getFrameSearchLevel()].findMinUnpinned(pinCnts, keys, numFrames);
+}
+
+int findMinUnpinnedPair(const int *pinCnts, const int *firstKeys, const int *secondKeys, int numFrames) {
+    return kernels[getFrameSearchLevel()].findMinUnpinnedPair(pinCnts, firstKeys, secondKeys, numFrames);
+}
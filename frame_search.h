@@ -0,0 +1,31 @@
+#ifndef FRAME_SEARCH_H
+#define FRAME_SEARCH_H
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+// Instruction sets the frame searches can use. The best one the CPU supports is picked at runtime
+typedef enum SearchLevel {
+	SEARCH_SCALAR = 0,
+	SEARCH_AVX2 = 1,	// 8 frames per instruction
+	SEARCH_AVX512 = 2	// 16 frames per instruction
+} SearchLevel;
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+/* runtime dispatch (lowering the level is meant for tests and benchmarks) */
+extern void initFrameSearch (void);
+extern SearchLevel getFrameSearchLevel (void);
+extern SearchLevel setFrameSearchLevel (SearchLevel level);
+
+/* first frame from start on holding value, -1 if there is none */
+extern int findValue (const int *values, int start, int numFrames, int value);
+
+/* unpinned frame with the smallest key below INT_MAX, the first one on ties. -1 if there is none */
+extern int findMinUnpinned (const int *pinCnts, const int *keys, int numFrames);
+
+/* same with keys compared by first key, then second key */
+extern int findMinUnpinnedPair (const int *pinCnts, const int *firstKeys, const int *secondKeys, int numFrames);
+
+#endif
@@ -0,0 +1,81 @@
+/*
+hot_pages.c
+Author: Pradyumna Deshpande
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include "hot_pages.h"
+
+// Hot page files start with this tag followed by the number of pages
+#define HOT_PAGES_FILE_TAG "BMHOTPG1"
+#define HOT_PAGES_TAG_SIZE 8
+
+// Function to write a list of hot pages. The list goes to a temporary file which then replaces the old one, so a crash
+// while writing leaves the previous list intact
+RC writeHotPages(const char *fileName, HotPage *pages, int numPages) {
+    char *tmpName = (char*)malloc(strlen(fileName) + 5);
+    sprintf(tmpName, "%s.tmp", fileName);
+
+    FILE *out = fopen(tmpName, "wb");
+    if(out == NULL) {
+        printf("Hot Pages: Could not create file %s.\n", tmpName);
+        free(tmpName);
+        return RC_FILE_NOT_FOUND;
+    }
+
+    uint64_t count = numPages;
+    bool success = fwrite(HOT_PAGES_FILE_TAG, 1, HOT_PAGES_TAG_SIZE, out) == HOT_PAGES_TAG_SIZE
+            && fwrite(&count, sizeof(uint64_t), 1, out) == 1
+            && fwrite(pages, sizeof(HotPage), numPages, out) == (size_t) numPages;
+
+    success = fclose(out) == 0 && success;
+    success = success && rename(tmpName, fileName) == 0;
+
+    if(!success) {
+        remove(tmpName);
+        free(tmpName);
+        printf("Hot Pages: Could not write file %s.\n", fileName);
+        return RC_WRITE_FAILED;
+    }
+
+    free(tmpName);
+
+    printf("Hot Pages: %d pages written to %s.\n", numPages, fileName);
+    return RC_OK;
+}
+
+// Function to load a list of hot pages into an array allocated for the caller
+RC readHotPages(const char *fileName, HotPage **pages, int *numPages) {
+    FILE *in = fopen(fileName, "rb");
+    if(in == NULL) {
+        printf("Hot Pages: Could not open file %s.\n", fileName);
+        return RC_FILE_NOT_FOUND;
+    }
+
+    char tag[HOT_PAGES_TAG_SIZE];
+    uint64_t count;
+
+    if(fread(tag, 1, HOT_PAGES_TAG_SIZE, in) != HOT_PAGES_TAG_SIZE || memcmp(tag, HOT_PAGES_FILE_TAG, HOT_PAGES_TAG_SIZE) != 0
+            || fread(&count, sizeof(uint64_t), 1, in) != 1 || count > INT32_MAX) {
+        fclose(in);
+        printf("Hot Pages: %s is not a hot page file.\n", fileName);
+        return RC_BAD_HOT_PAGE_FILE;
+    }
+
+    *pages = (HotPage*)malloc(sizeof(HotPage) * (count > 0 ? count : 1));
+    *numPages = (int) fread(*pages, sizeof(HotPage), count, in);
+
+    fclose(in);
+
+    if(*numPages != (int) count) {
+        free(*pages);
+        *pages = NULL;
+        printf("Hot Pages: %s is truncated.\n", fileName);
+        return RC_BAD_HOT_PAGE_FILE;
+    }
+
+    return RC_OK;
+}
@@ -0,0 +1,29 @@
+#ifndef HOT_PAGES_H
+#define HOT_PAGES_H
+
+#include <stdint.h>
+
+#include "dberror.h"
+#include "buffer_mgr.h"
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+// One resident page of a pool with the replacement bookkeeping of its frame (24 bytes)
+typedef struct HotPage {
+	PageNumber pageNum;
+	int32_t lruPos;
+	int32_t fifoPos;
+	int32_t lfuPos;
+	int32_t lfuHit;
+	int32_t clockChance;
+} HotPage;
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+/* hot page files, pages in the order they were given */
+extern RC writeHotPages (const char *fileName, HotPage *pages, int numPages);
+extern RC readHotPages (const char *fileName, HotPage **pages, int *numPages);
+
+#endif
@@ -0,0 +1,200 @@
+/*
+metrics.c
+Author: Pradyumna Deshpande
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+
+#include "metrics.h"
+
+// Number of counter stripes. Threads are assigned a stripe round robin, so up to this many threads never share a cache line
+#define NUM_METRIC_STRIPES 16
+#define CACHE_LINE_SIZE 64
+
+// Histogram buckets are log-linear like HDR histograms: values below 8 get one bucket each, every power of two
+// above is split into 8 sub-buckets. The relative error of a bucket is at most 12.5%
+#define SUB_BUCKET_BITS 3
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+#define MAX_VALUE_BITS 40
+#define NUM_BUCKETS (SUB_BUCKETS + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * SUB_BUCKETS)
+#define MAX_VALUE ((UINT64_C(1) << MAX_VALUE_BITS) - 1)
+
+typedef struct LatencyHistogram {
+    uint64_t buckets[NUM_BUCKETS];
+    uint64_t sumNanos;
+    uint64_t maxNanos;
+} LatencyHistogram;
+
+// Struct for the counters written by the threads of one stripe. Aligned so stripes never share a cache line
+typedef struct MetricStripe {
+    uint64_t counters[NUM_METRIC_COUNTERS];
+    LatencyHistogram latencies[NUM_METRIC_LATENCIES];
+} __attribute__((aligned(CACHE_LINE_SIZE))) MetricStripe;
+
+struct PoolMetrics {
+    MetricStripe stripes[NUM_METRIC_STRIPES];
+};
+
+static int nextStripe = 0;
+static __thread int threadStripe = -1;
+
+// Function to get the stripe of the calling thread, assigning one on first use
+static MetricStripe *stripeOf(PoolMetrics *metrics) {
+    if(threadStripe == -1) {
+        threadStripe = __atomic_fetch_add(&nextStripe, 1, __ATOMIC_RELAXED) % NUM_METRIC_STRIPES;
+    }
+
+    return &metrics->stripes[threadStripe];
+}
+
+// Function to find the histogram bucket of a value
+static int bucketIndex(uint64_t value) {
+    if(value > MAX_VALUE) {
+        value = MAX_VALUE;
+    }
+
+    if(value < SUB_BUCKETS) {
+        return (int) value;
+    }
+
+    int exponent = 63 - __builtin_clzll(value);
+    int subBucket = (int) (value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+}
+
+// Function to get the highest value which falls into a bucket
+static uint64_t bucketLimit(int index) {
+    if(index < SUB_BUCKETS) {
+        return (uint64_t) index;
+    }
+
+    int exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t subBucket = (uint64_t) (index % SUB_BUCKETS);
+    uint64_t width = UINT64_C(1) << (exponent - SUB_BUCKET_BITS);
+
+    return ((SUB_BUCKETS + subBucket) << (exponent - SUB_BUCKET_BITS)) + width - 1;
+}
+
+// Function to find the value below which the given fraction of the recorded values lie
+static uint64_t percentile(uint64_t *buckets, uint64_t count, uint64_t maxNanos, double fraction) {
+    if(count == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t) (fraction * count);
+    if(rank >= count) {
+        rank = count - 1;
+    }
+
+    uint64_t seen = 0;
+    for(int index = 0; index < NUM_BUCKETS; index++) {
+        seen += buckets[index];
+        if(seen > rank) {
+            uint64_t limit = bucketLimit(index);
+            return limit < maxNanos ? limit : maxNanos;
+        }
+    }
+
+    return maxNanos;
+}
+
+// Function to allocate zeroed metrics for a pool
+PoolMetrics *createPoolMetrics(void) {
+    PoolMetrics *metrics = NULL;
+
+    if(posix_memalign((void**) &metrics, CACHE_LINE_SIZE, sizeof(PoolMetrics)) != 0) {
+        return NULL;
+    }
+
+    memset(metrics, 0, sizeof(PoolMetrics));
+    return metrics;
+}
+
+void destroyPoolMetrics(PoolMetrics *metrics) {
+    free(metrics);
+}
+
+// Function to increase a counter
+void addMetric(PoolMetrics *metrics, BM_MetricCounter counter, uint64_t amount) {
+    if(metrics == NULL) {
+        return;
+    }
+
+    __atomic_fetch_add(&stripeOf(metrics)->counters[counter], amount, __ATOMIC_RELAXED);
+}
+
+// Function to add one measured latency to a histogram
+void recordLatency(PoolMetrics *metrics, BM_MetricLatency latency, uint64_t nanos) {
+    if(metrics == NULL) {
+        return;
+    }
+
+    LatencyHistogram *hist = &stripeOf(metrics)->latencies[latency];
+
+    __atomic_fetch_add(&hist->buckets[bucketIndex(nanos)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&hist->sumNanos, nanos, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&hist->maxNanos, __ATOMIC_RELAXED);
+    while(nanos > max && !__atomic_compare_exchange_n(&hist->maxNanos, &max, nanos, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// Function to get a monotonic timestamp in nanoseconds for latency measurements
+uint64_t metricsNow(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+// Function to sum up all stripes and summarize the histograms. Updates running at the same time may or may not be included
+void readPoolMetrics(PoolMetrics *metrics, BM_PoolMetrics *out) {
+    memset(out, 0, sizeof(BM_PoolMetrics));
+    if(metrics == NULL) {
+        return;
+    }
+
+    for(int counter = 0; counter < NUM_METRIC_COUNTERS; counter++) {
+        for(int s = 0; s < NUM_METRIC_STRIPES; s++) {
+            out->counters[counter] += __atomic_load_n(&metrics->stripes[s].counters[counter], __ATOMIC_RELAXED);
+        }
+    }
+
+    uint64_t *buckets = (uint64_t*)malloc(sizeof(uint64_t) * NUM_BUCKETS);
+
+    for(int latency = 0; latency < NUM_METRIC_LATENCIES; latency++) {
+        BM_LatencySummary *summary = &out->latencies[latency];
+        memset(buckets, 0, sizeof(uint64_t) * NUM_BUCKETS);
+
+        for(int s = 0; s < NUM_METRIC_STRIPES; s++) {
+            LatencyHistogram *hist = &metrics->stripes[s].latencies[latency];
+
+            for(int index = 0; index < NUM_BUCKETS; index++) {
+                buckets[index] += __atomic_load_n(&hist->buckets[index], __ATOMIC_RELAXED);
+            }
+
+            summary->sumNanos += __atomic_load_n(&hist->sumNanos, __ATOMIC_RELAXED);
+
+            uint64_t max = __atomic_load_n(&hist->maxNanos, __ATOMIC_RELAXED);
+            if(max > summary->maxNanos) {
+                summary->maxNanos = max;
+            }
+        }
+
+        // Count from the buckets, so the percentiles match the values they are computed from
+        for(int index = 0; index < NUM_BUCKETS; index++) {
+            summary->count += buckets[index];
+        }
+
+        summary->p50Nanos = percentile(buckets, summary->count, summary->maxNanos, 0.50);
+        summary->p90Nanos = percentile(buckets, summary->count, summary->maxNanos, 0.90);
+        summary->p99Nanos = percentile(buckets, summary->count, summary->maxNanos, 0.99);
+        summary->p999Nanos = percentile(buckets, summary->count, summary->maxNanos, 0.999);
+    }
+
+    free(buckets);
+}
@@ -0,0 +1,28 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+
+#include "buffer_mgr.h"
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+// Counters and latency histograms of one buffer pool. Updates go to a per-thread stripe and are summed up on read
+typedef struct PoolMetrics PoolMetrics;
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+extern PoolMetrics *createPoolMetrics (void);
+extern void destroyPoolMetrics (PoolMetrics *metrics);
+
+/* updates (safe to call from any thread, no latch needed) */
+extern void addMetric (PoolMetrics *metrics, BM_MetricCounter counter, uint64_t amount);
+extern void recordLatency (PoolMetrics *metrics, BM_MetricLatency latency, uint64_t nanos);
+extern uint64_t metricsNow (void);
+
+/* aggregation of all stripes */
+extern void readPoolMetrics (PoolMetrics *metrics, BM_PoolMetrics *out);
+
+#endif
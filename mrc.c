@@ -0,0 +1,298 @@
+/*
+mrc.c
+Author: Pradyumna Deshpande
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<string.h>
+#include<pthread.h>
+
+#include "mrc.h"
+
+// Pages are sampled if their hash is below the threshold. Hashes range over [0, SAMPLE_MODULUS)
+#define SAMPLE_MODULUS (1u << 24)
+
+// Reuse distances are counted in linear bins covering up to MRC_RANGE times the pool size. Longer distances go to the
+// last bin and count as misses for all sizes
+#define NUM_MRC_BINS 256
+#define MRC_RANGE 4
+
+// Access times run up to this many times the page budget before they are numbered again from 1
+#define TIME_RANGE 4
+
+// Struct for a sampled page and the sampled time of its last access
+typedef struct SampledPage {
+    int fileId;
+    PageNumber pageNo;
+    uint32_t hash;
+    int lastAccess;
+} SampledPage;
+
+struct MrcSampler {
+    pthread_mutex_t latch;  // Only taken for sampled accesses
+    uint32_t threshold;     // Sampling rate is threshold / SAMPLE_MODULUS. Lowered whenever the page budget is exceeded
+    SampledPage *pages;
+    int numPages;
+    int maxPages;
+    int *buckets;           // Hash table from page to its index in pages. Chained through nextPages, -1 ends a chain
+    int *nextPages;
+    int bucketBits;
+    int *accessTree;        // Fenwick tree over access times, 1 at the last access time of each sampled page
+    int numTimes;
+    int clock;              // Last access time handed out
+    int binWidth;
+    uint64_t bins[NUM_MRC_BINS];
+    uint64_t coldMisses;
+    uint64_t numSamples;
+};
+
+// Function to hash a page (murmur3 finalizer), so consecutive pages and files are sampled independently
+static uint32_t hashPage(int fileId, PageNumber pageNum) {
+    uint32_t h = (uint32_t) pageNum ^ ((uint32_t) fileId * 0x9e3779b1u);
+
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+
+    return h & (SAMPLE_MODULUS - 1);
+}
+
+// Function to pick the bucket of a sampled page. Sampled hashes are all below the threshold, so their high bits are
+// spread over the buckets first
+static int bucketOf(MrcSampler *sampler, uint32_t hash) {
+    return (int) ((hash * 2654435761u) >> (32 - sampler->bucketBits));
+}
+
+// Function to find the index of a sampled page, -1 if it isn't sampled
+static int findSampledPage(MrcSampler *sampler, int fileId, PageNumber pageNum, uint32_t hash) {
+    for(int i = sampler->buckets[bucketOf(sampler, hash)]; i != -1; i = sampler->nextPages[i]) {
+        if(sampler->pages[i].pageNo == pageNum && sampler->pages[i].fileId == fileId) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void linkSampledPage(MrcSampler *sampler, int i) {
+    int bucket = bucketOf(sampler, sampler->pages[i].hash);
+
+    sampler->nextPages[i] = sampler->buckets[bucket];
+    sampler->buckets[bucket] = i;
+}
+
+// Function to add delta at an access time of the Fenwick tree
+static void markTime(MrcSampler *sampler, int time, int delta) {
+    for(; time <= sampler->numTimes; time += time & -time) {
+        sampler->accessTree[time] += delta;
+    }
+}
+
+// Function to count the sampled pages whose last access was at the given time or before
+static int countUpTo(MrcSampler *sampler, int time) {
+    int count = 0;
+    for(; time > 0; time -= time & -time) {
+        count += sampler->accessTree[time];
+    }
+
+    return count;
+}
+
+static int compareLastAccess(const void *a, const void *b) {
+    return (*(SampledPage* const*) a)->lastAccess - (*(SampledPage* const*) b)->lastAccess;
+}
+
+// Function to number the last accesses of the sampled pages from 1 again, in the same order, once all access times
+// were handed out
+static void renumberTimes(MrcSampler *sampler) {
+    SampledPage **order = (SampledPage**)malloc(sizeof(SampledPage*) * sampler->numPages);
+    for(int i = 0; i < sampler->numPages; i++) {
+        order[i] = &sampler->pages[i];
+    }
+
+    qsort(order, sampler->numPages, sizeof(SampledPage*), compareLastAccess);
+
+    memset(sampler->accessTree, 0, sizeof(int) * (sampler->numTimes + 1));
+    for(int i = 0; i < sampler->numPages; i++) {
+        order[i]->lastAccess = i + 1;
+        markTime(sampler, i + 1, 1);
+    }
+
+    sampler->clock = sampler->numPages;
+    free(order);
+}
+
+// Function to give a sampled page the next access time. A new page has no time yet (0)
+static void touchSampledPage(MrcSampler *sampler, SampledPage *page) {
+    if(sampler->clock == sampler->numTimes) {
+        renumberTimes(sampler);
+    }
+
+    if(page->lastAccess > 0) {
+        markTime(sampler, page->lastAccess, -1);
+    }
+
+    sampler->clock++;
+    page->lastAccess = sampler->clock;
+    markTime(sampler, page->lastAccess, 1);
+}
+
+// Function to create a sampler tracking at most maxSampledPages pages. Starts by sampling every page and lowers the
+// rate as more pages show up, so memory stays fixed. Returns NULL if the memory can't be allocated
+MrcSampler *createMrcSampler(int maxSampledPages, int poolSize) {
+    MrcSampler *sampler = (MrcSampler*)calloc(1, sizeof(MrcSampler));
+    if(sampler == NULL) {
+        return NULL;
+    }
+
+    sampler->bucketBits = 1;
+    while((1 << sampler->bucketBits) < 2 * (maxSampledPages + 1)) {
+        sampler->bucketBits++;
+    }
+
+    sampler->numTimes = TIME_RANGE * (maxSampledPages + 1);
+    sampler->pages = (SampledPage*)malloc(sizeof(SampledPage) * (maxSampledPages + 1));
+    sampler->nextPages = (int*)malloc(sizeof(int) * (maxSampledPages + 1));
+    sampler->buckets = (int*)malloc(sizeof(int) << sampler->bucketBits);
+    sampler->accessTree = (int*)calloc(sampler->numTimes + 1, sizeof(int));
+    if(sampler->pages == NULL || sampler->nextPages == NULL || sampler->buckets == NULL || sampler->accessTree == NULL) {
+        free(sampler->pages);
+        free(sampler->nextPages);
+        free(sampler->buckets);
+        free(sampler->accessTree);
+        free(sampler);
+        return NULL;
+    }
+
+    memset(sampler->buckets, -1, sizeof(int) << sampler->bucketBits);
+    sampler->maxPages = maxSampledPages;
+    sampler->threshold = SAMPLE_MODULUS;
+    sampler->binWidth = (poolSize * MRC_RANGE + NUM_MRC_BINS - 1) / NUM_MRC_BINS;
+    if(sampler->binWidth < 1) {
+        sampler->binWidth = 1;
+    }
+
+    pthread_mutex_init(&sampler->latch, NULL);
+
+    return sampler;
+}
+
+void destroyMrcSampler(MrcSampler *sampler) {
+    if(sampler == NULL) {
+        return;
+    }
+
+    pthread_mutex_destroy(&sampler->latch);
+    free(sampler->pages);
+    free(sampler->nextPages);
+    free(sampler->buckets);
+    free(sampler->accessTree);
+    free(sampler);
+}
+
+// Function to drop the sampled page with the largest hash and stop sampling hashes from there on
+static void lowerThreshold(MrcSampler *sampler) {
+    uint32_t maxHash = 0;
+    for(int i = 0; i < sampler->numPages; i++) {
+        if(sampler->pages[i].hash > maxHash) {
+            maxHash = sampler->pages[i].hash;
+        }
+    }
+
+    // Pages move, so the index is built again
+    memset(sampler->buckets, -1, sizeof(int) << sampler->bucketBits);
+
+    int kept = 0;
+    for(int i = 0; i < sampler->numPages; i++) {
+        if(sampler->pages[i].hash < maxHash) {
+            sampler->pages[kept] = sampler->pages[i];
+            linkSampledPage(sampler, kept++);
+        } else {
+            markTime(sampler, sampler->pages[i].lastAccess, -1);
+        }
+    }
+
+    sampler->numPages = kept;
+    __atomic_store_n(&sampler->threshold, maxHash, __ATOMIC_RELAXED);
+}
+
+// Function to record a page access. Pages outside the sample return right away without taking the latch
+void sampleAccess(MrcSampler *sampler, int fileId, PageNumber pageNum) {
+    if(sampler == NULL) {
+        return;
+    }
+
+    uint32_t hash = hashPage(fileId, pageNum);
+    if(hash >= __atomic_load_n(&sampler->threshold, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    pthread_mutex_lock(&sampler->latch);
+
+    // Threshold may have been lowered while waiting for the latch
+    if(hash >= sampler->threshold) {
+        pthread_mutex_unlock(&sampler->latch);
+        return;
+    }
+
+    // Find the page and count the sampled pages used since its last access, i.e. its LRU stack distance in the sample
+    int found = findSampledPage(sampler, fileId, pageNum, hash);
+
+    sampler->numSamples++;
+
+    if(found != -1) {
+        int lastAccess = sampler->pages[found].lastAccess;
+        uint64_t distance = sampler->numPages - countUpTo(sampler, lastAccess);
+
+        // Scale up by the sampling rate to estimate the distance among all pages
+        double scaled = (double) distance * SAMPLE_MODULUS / sampler->threshold;
+        uint64_t bin = (uint64_t) (scaled / sampler->binWidth);
+        sampler->bins[bin < NUM_MRC_BINS ? bin : NUM_MRC_BINS - 1]++;
+
+        touchSampledPage(sampler, &sampler->pages[found]);
+    } else {
+        sampler->coldMisses++;
+
+        SampledPage *page = &sampler->pages[sampler->numPages];
+        page->fileId = fileId;
+        page->pageNo = pageNum;
+        page->hash = hash;
+        page->lastAccess = 0;
+        linkSampledPage(sampler, sampler->numPages);
+        sampler->numPages++;
+        touchSampledPage(sampler, page);
+
+        if(sampler->numPages > sampler->maxPages) {
+            lowerThreshold(sampler);
+        }
+    }
+
+    pthread_mutex_unlock(&sampler->latch);
+}
+
+// Function to estimate the miss ratio of an LRU pool of each size. A sampled access hits in a pool of size frames if
+// fewer than size other pages were used since the page's last access
+void estimateMissRatios(MrcSampler *sampler, const int *sizes, double *missRatios, int numSizes) {
+    pthread_mutex_lock(&sampler->latch);
+
+    for(int s = 0; s < numSizes; s++) {
+        if(sampler->numSamples == 0) {
+            missRatios[s] = 0.0;
+            continue;
+        }
+
+        // Bins whose whole range lies below the size are hits. The last bin also holds longer distances
+        uint64_t hits = 0;
+        for(int bin = 0; bin < NUM_MRC_BINS - 1 && (uint64_t) (bin + 1) * sampler->binWidth <= (uint64_t) sizes[s]; bin++) {
+            hits += sampler->bins[bin];
+        }
+
+        missRatios[s] = (double) (sampler->numSamples - hits) / sampler->numSamples;
+    }
+
+    pthread_mutex_unlock(&sampler->latch);
+}
@@ -0,0 +1,25 @@
+#ifndef MRC_H
+#define MRC_H
+
+#include "dberror.h"
+#include "buffer_mgr.h"
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+// Online miss ratio curve estimator. Tracks reuse distances of a hash-sampled subset of the pages (SHARDS)
+typedef struct MrcSampler MrcSampler;
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+extern MrcSampler *createMrcSampler (int maxSampledPages, int poolSize);
+extern void destroyMrcSampler (MrcSampler *sampler);
+
+/* recording (safe to call from any thread) */
+extern void sampleAccess (MrcSampler *sampler, int fileId, PageNumber pageNum);
+
+/* estimated LRU miss ratio for each of numSizes pool sizes */
+extern void estimateMissRatios (MrcSampler *sampler, const int *sizes, double *missRatios, int numSizes);
+
+#endif
@@ -0,0 +1,280 @@
+/*
+page_tier.c
+Author: Pradyumna Deshpande
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+#include<pthread.h>
+
+#include "page_tier.h"
+
+// Slot of the tier file without a page
+#define EMPTY_SLOT -1
+
+struct PageTier {
+    pthread_mutex_t latch;  // Guards the slots. Reads of the slow file run without it, so misses don't wait for each other
+    FILE *file;
+    char *fileName;
+    SM_TierMode mode;
+    int numSlots;
+    int *slotPages;     // Page of the slow file in each slot of the tier file
+    bool *dirtyFlags;   // Set for pages written to the tier but not to the slow file yet (write-back only)
+    bool *referenced;   // CLOCK reference bits
+    int clockHand;
+    int *buckets;       // Hash table from page to slot. Chained through nextSlots, -1 ends a chain
+    int *nextSlots;
+    int numBuckets;
+    unsigned int writeSeq;  // Increased by every write, so a miss can tell if its page was written while it read it
+    int hits;
+    int misses;
+};
+
+static int hashTierPage(PageTier *tier, int pageNum) {
+    return (int) (((unsigned int) pageNum * 2654435761u) % (unsigned int) tier->numBuckets);
+}
+
+// Function to find the slot holding a page, -1 if the tier doesn't have it
+static int findSlot(PageTier *tier, int pageNum) {
+    for(int slot = tier->buckets[hashTierPage(tier, pageNum)]; slot != -1; slot = tier->nextSlots[slot]) {
+        if(tier->slotPages[slot] == pageNum) {
+            return slot;
+        }
+    }
+
+    return -1;
+}
+
+static void unlinkSlot(PageTier *tier, int slot) {
+    int *link = &tier->buckets[hashTierPage(tier, tier->slotPages[slot])];
+
+    while(*link != slot) {
+        link = &tier->nextSlots[*link];
+    }
+
+    *link = tier->nextSlots[slot];
+}
+
+static void linkSlot(PageTier *tier, int slot, int pageNum) {
+    int bucket = hashTierPage(tier, pageNum);
+
+    tier->slotPages[slot] = pageNum;
+    tier->nextSlots[slot] = tier->buckets[bucket];
+    tier->buckets[bucket] = slot;
+}
+
+// Function to write a page of the tier to the slow file. Buffered writes of the slow file's stream go first, so they
+// can't overwrite the page later
+static RC writeBackSlot(PageTier *tier, int slot, FILE *slowFile) {
+    char page[PAGE_SIZE];
+    off_t offset = (off_t) tier->slotPages[slot] * PAGE_SIZE;
+
+    if(pread(fileno(tier->file), page, PAGE_SIZE, (off_t) slot * PAGE_SIZE) != PAGE_SIZE
+            || fflush(slowFile) != 0 || pwrite(fileno(slowFile), page, PAGE_SIZE, offset) != PAGE_SIZE) {
+        printf("Operation Tier: Could not write page %d back to the page file.\n", tier->slotPages[slot]);
+        return RC_TIER_FAILED;
+    }
+
+    tier->dirtyFlags[slot] = false;
+    return RC_OK;
+}
+
+// Function to choose the slot for a new page by CLOCK. Empty slots are taken first. A dirty page is written to the
+// slow file before its slot is reused
+static RC evictSlot(PageTier *tier, FILE *slowFile, int *slot) {
+    while(true) {
+        int candidate = tier->clockHand;
+        tier->clockHand = (tier->clockHand + 1) % tier->numSlots;
+
+        if(tier->slotPages[candidate] == EMPTY_SLOT) {
+            *slot = candidate;
+            return RC_OK;
+        }
+
+        if(tier->referenced[candidate]) {
+            tier->referenced[candidate] = false;
+            continue;
+        }
+
+        if(tier->dirtyFlags[candidate]) {
+            RC rc = writeBackSlot(tier, candidate, slowFile);
+            if(rc != RC_OK) {
+                return rc;
+            }
+        }
+
+        unlinkSlot(tier, candidate);
+        tier->slotPages[candidate] = EMPTY_SLOT;
+
+        *slot = candidate;
+        return RC_OK;
+    }
+}
+
+// Function to put a page into the tier, into its slot if the tier has it already. Caller holds the latch
+static RC storeTierPage(PageTier *tier, int pageNum, char *memPage, bool dirty, FILE *slowFile) {
+    int slot = findSlot(tier, pageNum);
+
+    if(slot == -1) {
+        RC rc = evictSlot(tier, slowFile, &slot);
+        if(rc != RC_OK) {
+            return rc;
+        }
+
+        linkSlot(tier, slot, pageNum);
+        tier->dirtyFlags[slot] = false;
+    }
+
+    if(pwrite(fileno(tier->file), memPage, PAGE_SIZE, (off_t) slot * PAGE_SIZE) != PAGE_SIZE) {
+        printf("Operation Tier: Could not write page %d to '%s'.\n", pageNum, tier->fileName);
+        unlinkSlot(tier, slot);
+        tier->slotPages[slot] = EMPTY_SLOT;
+        return RC_TIER_FAILED;
+    }
+
+    tier->dirtyFlags[slot] = tier->dirtyFlags[slot] || dirty;
+    tier->referenced[slot] = true;
+
+    return RC_OK;
+}
+
+// Function to create an empty tier of numPages slots in a new local file. An existing file is overwritten, since the
+// pages it held aren't known any more
+RC createPageTier(char *tierFileName, int numPages, SM_TierMode mode, PageTier **tier) {
+    FILE *file = fopen(tierFileName, "w+");
+
+    if(file == NULL || numPages <= 0 || ftruncate(fileno(file), (off_t) numPages * PAGE_SIZE) != 0) {
+        if(file != NULL) {
+            fclose(file);
+        }
+        printf("Operation Tier: Could not create tier file '%s'.\n", tierFileName);
+        return RC_TIER_FAILED;
+    }
+
+    PageTier *t = (PageTier*)malloc(sizeof(PageTier));
+
+    pthread_mutex_init(&t->latch, NULL);
+    t->file = file;
+    t->fileName = strdup(tierFileName);
+    t->mode = mode;
+    t->numSlots = numPages;
+    t->slotPages = (int*)malloc(sizeof(int) * numPages);
+    t->dirtyFlags = (bool*)calloc(numPages, sizeof(bool));
+    t->referenced = (bool*)calloc(numPages, sizeof(bool));
+    t->clockHand = 0;
+    t->numBuckets = numPages;
+    t->buckets = (int*)malloc(sizeof(int) * numPages);
+    t->nextSlots = (int*)malloc(sizeof(int) * numPages);
+    t->writeSeq = 0;
+    t->hits = 0;
+    t->misses = 0;
+
+    for(int slot = 0; slot < numPages; slot++) {
+        t->slotPages[slot] = EMPTY_SLOT;
+        t->buckets[slot] = -1;
+        t->nextSlots[slot] = -1;
+    }
+
+    *tier = t;
+
+    printf("Operation Tier: Created tier '%s' with %d pages.\n", tierFileName, numPages);
+    return RC_OK;
+}
+
+RC destroyPageTier(PageTier *tier, FILE *slowFile) {
+    RC rc = flushTier(tier, slowFile);
+
+    fclose(tier->file);
+    pthread_mutex_destroy(&tier->latch);
+    free(tier->fileName);
+    free(tier->slotPages);
+    free(tier->dirtyFlags);
+    free(tier->referenced);
+    free(tier->buckets);
+    free(tier->nextSlots);
+    free(tier);
+
+    return rc;
+}
+
+// Function to read a page from the tier. On a miss the caller reads the slow file and hands the page to fillTierPage()
+// with the write count returned here
+bool readTierPage(PageTier *tier, int pageNum, char *memPage, unsigned int *writeSeq) {
+    pthread_mutex_lock(&tier->latch);
+
+    int slot = findSlot(tier, pageNum);
+    if(slot == -1) {
+        tier->misses++;
+        *writeSeq = tier->writeSeq;
+        pthread_mutex_unlock(&tier->latch);
+        return false;
+    }
+
+    bool success = pread(fileno(tier->file), memPage, PAGE_SIZE, (off_t) slot * PAGE_SIZE) == PAGE_SIZE;
+    if(success) {
+        tier->referenced[slot] = true;
+        tier->hits++;
+    } else {
+        tier->misses++;
+        *writeSeq = tier->writeSeq;
+    }
+
+    pthread_mutex_unlock(&tier->latch);
+    return success;
+}
+
+// Function to add a page read from the slow file after a miss. Skipped if the tier got the page meanwhile or a write
+// happened since the miss, since the page read may be older than the one written
+RC fillTierPage(PageTier *tier, int pageNum, char *memPage, unsigned int writeSeq, FILE *slowFile) {
+    RC rc = RC_OK;
+
+    pthread_mutex_lock(&tier->latch);
+
+    if(tier->writeSeq == writeSeq && findSlot(tier, pageNum) == -1) {
+        rc = storeTierPage(tier, pageNum, memPage, false, slowFile);
+    }
+
+    pthread_mutex_unlock(&tier->latch);
+    return rc;
+}
+
+bool isWriteBack(PageTier *tier) {
+    return tier->mode == TIER_WRITE_BACK;
+}
+
+// Function to write a page to the tier. In write-back mode the page is only written to the slow file once it is
+// evicted from the tier or the tier is flushed, in write-through mode the caller writes the slow file as well
+RC writeTierPage(PageTier *tier, int pageNum, char *memPage, FILE *slowFile) {
+    pthread_mutex_lock(&tier->latch);
+
+    tier->writeSeq++;
+    RC rc = storeTierPage(tier, pageNum, memPage, tier->mode == TIER_WRITE_BACK, slowFile);
+
+    pthread_mutex_unlock(&tier->latch);
+    return rc;
+}
+
+// Function to write every page only the tier has to the slow file
+RC flushTier(PageTier *tier, FILE *slowFile) {
+    RC rc = RC_OK;
+
+    pthread_mutex_lock(&tier->latch);
+
+    for(int slot = 0; slot < tier->numSlots && rc == RC_OK; slot++) {
+        if(tier->dirtyFlags[slot]) {
+            rc = writeBackSlot(tier, slot, slowFile);
+        }
+    }
+
+    pthread_mutex_unlock(&tier->latch);
+    return rc;
+}
+
+void readTierStats(PageTier *tier, int *hits, int *misses) {
+    pthread_mutex_lock(&tier->latch);
+    *hits = tier->hits;
+    *misses = tier->misses;
+    pthread_mutex_unlock(&tier->latch);
+}
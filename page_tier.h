@@ -0,0 +1,35 @@
+#ifndef PAGE_TIER_H
+#define PAGE_TIER_H
+
+#include <stdio.h>
+
+#include "storage_mgr.h"
+#include "dt.h"
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+// A local page file caching pages of a slower page file. Slots of the tier file hold pages of the slow file and are
+// replaced by CLOCK, independent of the buffer pool above
+typedef struct PageTier PageTier;
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+extern RC createPageTier (char *tierFileName, int numPages, SM_TierMode mode, PageTier **tier);
+/* writes the pages only the tier has to the slow file first */
+extern RC destroyPageTier (PageTier *tier, FILE *slowFile);
+
+/* reading. A miss returns false and the tier's write count, which fillTierPage checks before adding the page */
+extern bool readTierPage (PageTier *tier, int pageNum, char *memPage, unsigned int *writeSeq);
+extern RC fillTierPage (PageTier *tier, int pageNum, char *memPage, unsigned int writeSeq, FILE *slowFile);
+
+/* writing */
+extern bool isWriteBack (PageTier *tier);
+extern RC writeTierPage (PageTier *tier, int pageNum, char *memPage, FILE *slowFile);
+extern RC flushTier (PageTier *tier, FILE *slowFile);
+
+/* statistics */
+extern void readTierStats (PageTier *tier, int *hits, int *misses);
+
+#endif
@@ -0,0 +1,268 @@
+/*
+pin_tracker.c
+Author: Pradyumna Deshpande
+*/
+
+#define _GNU_SOURCE
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<pthread.h>
+#include<dlfcn.h>
+
+#include "pin_tracker.h"
+
+#define NUM_PIN_BUCKETS 1024
+
+// Struct for the pins one client holds on one page. Chained in its hash bucket and in the bucket of its page
+typedef struct PinEntry {
+    int client;
+    int fileId;
+    PageNumber pageNum;
+    int count;
+    const void *site;   // Return address of the first of these pins, NULL if call sites aren't recorded
+    struct PinEntry *hashNext;
+    struct PinEntry *pageNext;  // Entries of all clients pinning the page are in the same page bucket
+} PinEntry;
+
+// Struct for the number of pins a client holds. Pools have few clients, so they are kept in a plain array
+typedef struct ClientPins {
+    int client;
+    int numPins;
+} ClientPins;
+
+struct PinTracker {
+    pthread_mutex_t latch;
+    int maxPinsPerClient;   // 0 = no limit
+    PinEntry **buckets;     // Keyed by client and page
+    PinEntry **pageBuckets; // Keyed by page only, for unpins by another client than the one which pinned the page
+    ClientPins *clients;
+    int numClients;
+    int clientCapacity;
+};
+
+static int nextClient = 1;
+static __thread bool hasClient = false;
+static __thread int trackedClient;
+
+// Function to create a tracker. Clients may hold at most maxPinsPerClient pins at once (0 = no limit)
+PinTracker *createPinTracker(int maxPinsPerClient) {
+    PinTracker *tracker = (PinTracker*)malloc(sizeof(PinTracker));
+
+    pthread_mutex_init(&tracker->latch, NULL);
+    tracker->maxPinsPerClient = maxPinsPerClient;
+    tracker->buckets = (PinEntry**)calloc(NUM_PIN_BUCKETS, sizeof(PinEntry*));
+    tracker->pageBuckets = (PinEntry**)calloc(NUM_PIN_BUCKETS, sizeof(PinEntry*));
+    tracker->clients = NULL;
+    tracker->numClients = 0;
+    tracker->clientCapacity = 0;
+
+    return tracker;
+}
+
+void destroyPinTracker(PinTracker *tracker) {
+    if(tracker == NULL) {
+        return;
+    }
+
+    for(int bucket = 0; bucket < NUM_PIN_BUCKETS; bucket++) {
+        while(tracker->buckets[bucket] != NULL) {
+            PinEntry *entry = tracker->buckets[bucket];
+            tracker->buckets[bucket] = entry->hashNext;
+            free(entry);
+        }
+    }
+
+    pthread_mutex_destroy(&tracker->latch);
+    free(tracker->buckets);
+    free(tracker->pageBuckets);
+    free(tracker->clients);
+    free(tracker);
+}
+
+// Function to make the calling thread's pins count for the given client from now on
+void setTrackedClient(int client) {
+    trackedClient = client;
+    hasClient = true;
+}
+
+int getTrackedClient(void) {
+    if(!hasClient) {
+        setTrackedClient(__atomic_fetch_add(&nextClient, 1, __ATOMIC_RELAXED));
+    }
+
+    return trackedClient;
+}
+
+static int hashPin(int client, int fileId, PageNumber pageNum) {
+    return (int) ((((unsigned int) pageNum + (unsigned int) fileId * 40503u + (unsigned int) client * 69069u) * 2654435761u)
+            & (NUM_PIN_BUCKETS - 1));
+}
+
+static int hashPinPage(int fileId, PageNumber pageNum) {
+    return (int) ((((unsigned int) pageNum + (unsigned int) fileId * 40503u) * 2654435761u) & (NUM_PIN_BUCKETS - 1));
+}
+
+// Function to find the pin count of a client. A missing client is added if add is set, NULL is returned otherwise
+static ClientPins *findClient(PinTracker *tracker, int client, bool add) {
+    for(int i = 0; i < tracker->numClients; i++) {
+        if(tracker->clients[i].client == client) {
+            return &tracker->clients[i];
+        }
+    }
+
+    if(!add) {
+        return NULL;
+    }
+
+    if(tracker->numClients == tracker->clientCapacity) {
+        tracker->clientCapacity = tracker->clientCapacity > 0 ? tracker->clientCapacity * 2 : 8;
+        tracker->clients = (ClientPins*)realloc(tracker->clients, sizeof(ClientPins) * tracker->clientCapacity);
+    }
+
+    ClientPins *pins = &tracker->clients[tracker->numClients++];
+    pins->client = client;
+    pins->numPins = 0;
+
+    return pins;
+}
+
+// Function to find the link pointing to the entry of a client's pins on a page, or to the NULL ending its bucket
+static PinEntry **findEntry(PinTracker *tracker, int client, int fileId, PageNumber pageNum) {
+    PinEntry **link = &tracker->buckets[hashPin(client, fileId, pageNum)];
+
+    while(*link != NULL && ((*link)->client != client || (*link)->pageNum != pageNum || (*link)->fileId != fileId)) {
+        link = &(*link)->hashNext;
+    }
+
+    return link;
+}
+
+// Function to find the link in a page bucket pointing to the given entry, or to the first entry of any client for the
+// page if entry is NULL. Points to the NULL ending the bucket if there is none
+static PinEntry **findPageEntry(PinTracker *tracker, int fileId, PageNumber pageNum, PinEntry *entry) {
+    PinEntry **link = &tracker->pageBuckets[hashPinPage(fileId, pageNum)];
+
+    while(*link != NULL && (entry != NULL ? *link != entry : ((*link)->pageNum != pageNum || (*link)->fileId != fileId))) {
+        link = &(*link)->pageNext;
+    }
+
+    return link;
+}
+
+// Function to record pins of the calling thread's client. Either all pins are added or, if the client would hold more
+// than its limit, none of them
+RC addPins(PinTracker *tracker, int fileId, const PageNumber *pageNums, int numPages, const void *site) {
+    int client = getTrackedClient();
+
+    pthread_mutex_lock(&tracker->latch);
+
+    ClientPins *pins = findClient(tracker, client, true);
+    if(tracker->maxPinsPerClient > 0 && pins->numPins + numPages > tracker->maxPinsPerClient) {
+        pthread_mutex_unlock(&tracker->latch);
+        return RC_PIN_LIMIT;
+    }
+
+    pins->numPins += numPages;
+
+    for(int i = 0; i < numPages; i++) {
+        PinEntry **link = findEntry(tracker, client, fileId, pageNums[i]);
+
+        if(*link == NULL) {
+            PinEntry *entry = (PinEntry*)malloc(sizeof(PinEntry));
+            entry->client = client;
+            entry->fileId = fileId;
+            entry->pageNum = pageNums[i];
+            entry->count = 0;
+            entry->site = site;
+            entry->hashNext = NULL;
+            *link = entry;
+
+            PinEntry **pageBucket = &tracker->pageBuckets[hashPinPage(fileId, pageNums[i])];
+            entry->pageNext = *pageBucket;
+            *pageBucket = entry;
+        }
+
+        (*link)->count++;
+    }
+
+    pthread_mutex_unlock(&tracker->latch);
+    return RC_OK;
+}
+
+// Function to remove one pin of a page. Pins are taken from the calling thread's client first. A page may be unpinned
+// by another client than the one which pinned it, so any other client's pin of the page is taken otherwise
+void removePin(PinTracker *tracker, int fileId, PageNumber pageNum) {
+    int client = getTrackedClient();
+
+    pthread_mutex_lock(&tracker->latch);
+
+    PinEntry **link = findEntry(tracker, client, fileId, pageNum);
+
+    // Pin of another client is found through the page's bucket
+    if(*link == NULL) {
+        PinEntry *other = *findPageEntry(tracker, fileId, pageNum, NULL);
+        if(other == NULL) {
+            pthread_mutex_unlock(&tracker->latch);
+            return;
+        }
+
+        link = findEntry(tracker, other->client, fileId, pageNum);
+    }
+
+    PinEntry *entry = *link;
+    findClient(tracker, entry->client, false)->numPins--;
+
+    entry->count--;
+    if(entry->count == 0) {
+        *link = entry->hashNext;
+
+        PinEntry **pageLink = findPageEntry(tracker, fileId, pageNum, entry);
+        *pageLink = entry->pageNext;
+
+        free(entry);
+    }
+
+    pthread_mutex_unlock(&tracker->latch);
+}
+
+// Function to print every page each client still holds pins of. Returns the number of pins held
+int reportPins(PinTracker *tracker) {
+    int numPins = 0;
+
+    pthread_mutex_lock(&tracker->latch);
+
+    for(int i = 0; i < tracker->numClients; i++) {
+        ClientPins *pins = &tracker->clients[i];
+        if(pins->numPins == 0) {
+            continue;
+        }
+
+        printf("Leaked Pins: Client %d holds %d pin(s).\n", pins->client, pins->numPins);
+        numPins += pins->numPins;
+
+        for(int bucket = 0; bucket < NUM_PIN_BUCKETS; bucket++) {
+            for(PinEntry *entry = tracker->buckets[bucket]; entry != NULL; entry = entry->hashNext) {
+                if(entry->client != pins->client) {
+                    continue;
+                }
+
+                // Call sites are printed as binary and offset, which addr2line -e can turn into a source line
+                Dl_info info;
+                if(entry->site != NULL && dladdr(entry->site, &info) != 0 && info.dli_fname != NULL) {
+                    printf("Leaked Pins:   Page %d of file %d pinned %d time(s), first at %s+%#lx.\n", entry->pageNum,
+                            entry->fileId, entry->count, info.dli_fname, (unsigned long) ((const char*) entry->site - (const char*) info.dli_fbase));
+                } else if(entry->site != NULL) {
+                    printf("Leaked Pins:   Page %d of file %d pinned %d time(s), first at %p.\n", entry->pageNum,
+                            entry->fileId, entry->count, entry->site);
+                } else {
+                    printf("Leaked Pins:   Page %d of file %d pinned %d time(s).\n", entry->pageNum, entry->fileId,
+                            entry->count);
+                }
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&tracker->latch);
+    return numPins;
+}
@@ -0,0 +1,31 @@
+#ifndef PIN_TRACKER_H
+#define PIN_TRACKER_H
+
+#include "dberror.h"
+#include "buffer_mgr.h"
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+// Pins held by each client of a pool, with the call site of the first pin of every page. A client is a thread unless
+// the thread chose a client id of its own
+typedef struct PinTracker PinTracker;
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+extern PinTracker *createPinTracker (int maxPinsPerClient);
+extern void destroyPinTracker (PinTracker *tracker);
+
+/* client of the calling thread. Threads which never set one are numbered 1, 2, ... in the order they first pin */
+extern void setTrackedClient (int client);
+extern int getTrackedClient (void);
+
+/* recording (safe to call from any thread). addPins adds all pins or none, RC_PIN_LIMIT if the client would go over its limit */
+extern RC addPins (PinTracker *tracker, int fileId, const PageNumber *pageNums, int numPages, const void *site);
+extern void removePin (PinTracker *tracker, int fileId, PageNumber pageNum);
+
+/* prints the pins still held per client, returns their number */
+extern int reportPins (PinTracker *tracker);
+
+#endif
@@ -0,0 +1,679 @@
+/*
+shared_pool.c
+Author: Pradyumna Deshpande
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+#include<errno.h>
+#include<time.h>
+#include<signal.h>
+#include<unistd.h>
+#include<fcntl.h>
+#include<pthread.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+
+#include "shared_pool.h"
+#include "storage_mgr.h"
+#include "frame_search.h"
+
+#define SHARED_CACHE_LINE 64
+#define SHARED_FILE_NAME_LEN 256
+
+// States of a shared pool. The creator sets it to SHARED_POOL_READY once everything else is set up
+#define SHARED_POOL_INITIALIZING 0u
+#define SHARED_POOL_READY 0x53504f4cu
+#define SHARED_POOL_REMOVED 0x5350ded0u
+
+// Result of attaching to a pool the last process removed meanwhile. It is then created again
+#define SHARED_POOL_GONE -1
+
+// Time an attaching process waits for the creator to set the pool up
+#define SHARED_ATTACH_MILLIS 2000
+#define SHARED_ATTACH_TRIES 5
+
+// Struct at the start of the shared memory. Everything in shared memory is found by offsets from its start, since
+// each process maps it at a different address, so no pointers are kept in it
+typedef struct SharedHeader {
+    unsigned int state;
+    int numFrames;
+    int strategy;
+    char pageFile[SHARED_FILE_NAME_LEN];
+    pthread_mutex_t latch;  // Process shared and robust, so a process dying while holding it doesn't block the others
+    int readCnt;
+    int writeCnt;
+    int lruCounter;
+    int fifoCounter;
+    int lfuCounter;
+    int clockCounter;
+    pid_t procs[MAX_SHARED_PROCESSES];  // Attached processes, 0 for a free slot
+} SharedHeader;
+
+// Struct for a process's view of a shared pool. The arrays point into this process's mapping of the shared memory.
+// Fix counts are kept per process as well (procPins, one row of numFrames per slot), so pins of a process which died
+// can be given back
+struct SharedPool {
+    char *name;
+    char *base;
+    size_t size;
+    int slot;
+    SM_FileHandle fHandle;
+    SharedHeader *header;
+    PageNumber *pageNos;
+    int *pinCnts;
+    bool *dirtyFlags;
+    int *lruPos;
+    int *fifoPos;
+    int *lfuPos;
+    int *lfuHits;
+    bool *clockChances;
+    int *procPins;
+    char *pageData;
+};
+
+static size_t alignShared(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+// Function to take the next aligned piece of the shared memory. Only the offset is computed if there is no mapping yet
+static void *carveShared(char *base, size_t *offset, size_t size, size_t alignment) {
+    *offset = alignShared(*offset, alignment);
+    void *piece = base != NULL ? base + *offset : NULL;
+    *offset += size;
+    return piece;
+}
+
+// Function to lay out a shared pool of numFrames frames in a mapping at base. Every process computes the same offsets
+// from numFrames. Returns the size of the shared memory
+static size_t layoutSharedPool(SharedPool *pool, char *base, int numFrames) {
+    size_t offset = 0;
+    size_t ints = sizeof(int) * numFrames;
+    size_t bools = sizeof(bool) * numFrames;
+
+    SharedHeader *header = (SharedHeader*) carveShared(base, &offset, sizeof(SharedHeader), SHARED_CACHE_LINE);
+    PageNumber *pageNos = (PageNumber*) carveShared(base, &offset, ints, SHARED_CACHE_LINE);
+    int *pinCnts = (int*) carveShared(base, &offset, ints, SHARED_CACHE_LINE);
+    bool *dirtyFlags = (bool*) carveShared(base, &offset, bools, SHARED_CACHE_LINE);
+    int *lruPos = (int*) carveShared(base, &offset, ints, SHARED_CACHE_LINE);
+    int *fifoPos = (int*) carveShared(base, &offset, ints, SHARED_CACHE_LINE);
+    int *lfuPos = (int*) carveShared(base, &offset, ints, SHARED_CACHE_LINE);
+    int *lfuHits = (int*) carveShared(base, &offset, ints, SHARED_CACHE_LINE);
+    bool *clockChances = (bool*) carveShared(base, &offset, bools, SHARED_CACHE_LINE);
+    int *procPins = (int*) carveShared(base, &offset, ints * MAX_SHARED_PROCESSES, SHARED_CACHE_LINE);
+    char *pageData = (char*) carveShared(base, &offset, (size_t) PAGE_SIZE * numFrames, PAGE_SIZE);
+
+    if(pool != NULL) {
+        pool->base = base;
+        pool->header = header;
+        pool->pageNos = pageNos;
+        pool->pinCnts = pinCnts;
+        pool->dirtyFlags = dirtyFlags;
+        pool->lruPos = lruPos;
+        pool->fifoPos = fifoPos;
+        pool->lfuPos = lfuPos;
+        pool->lfuHits = lfuHits;
+        pool->clockChances = clockChances;
+        pool->procPins = procPins;
+        pool->pageData = pageData;
+    }
+
+    return alignShared(offset, PAGE_SIZE);
+}
+
+static int *pinsOf(SharedPool *pool, int slot) {
+    return pool->procPins + (size_t) slot * pool->header->numFrames;
+}
+
+// Function to give back the pins of attached processes which no longer exist. Fix counts are then summed up again from
+// the pins of the live processes, so they are right even if a process died in the middle of changing them
+static void reapDeadProcesses(SharedPool *pool) {
+    SharedHeader *header = pool->header;
+
+    for(int slot = 0; slot < MAX_SHARED_PROCESSES; slot++) {
+        pid_t pid = header->procs[slot];
+        if(pid == 0 || kill(pid, 0) == 0 || errno != ESRCH) {
+            continue;
+        }
+
+        int *pins = pinsOf(pool, slot);
+        int held = 0;
+        for(int frame = 0; frame < header->numFrames; frame++) {
+            held += pins[frame];
+            pins[frame] = 0;
+        }
+
+        header->procs[slot] = 0;
+        printf("Shared Pool: Process %d ended while attached, holding %d pin(s). Released them.\n", (int) pid, held);
+    }
+
+    for(int frame = 0; frame < header->numFrames; frame++) {
+        int pinCnt = 0;
+        for(int slot = 0; slot < MAX_SHARED_PROCESSES; slot++) {
+            pinCnt += header->procs[slot] != 0 ? pinsOf(pool, slot)[frame] : 0;
+        }
+        pool->pinCnts[frame] = pinCnt;
+    }
+}
+
+// Function to latch the shared pool. If the last holder died while holding it, its pins are given back first
+static void lockShared(SharedPool *pool) {
+    if(pthread_mutex_lock(&pool->header->latch) == EOWNERDEAD) {
+        printf("Shared Pool: A process died while holding the pool latch. Recovering.\n");
+        pthread_mutex_consistent(&pool->header->latch);
+        reapDeadProcesses(pool);
+    }
+}
+
+static void unlockShared(SharedPool *pool) {
+    pthread_mutex_unlock(&pool->header->latch);
+}
+
+// Function to set up a pool just created. Other processes wait until the state says it is ready
+static void initSharedHeader(SharedPool *pool, int numFrames, ReplacementStrategy strategy, const char *pageFileName) {
+    SharedHeader *header = pool->header;
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&header->latch, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    header->numFrames = numFrames;
+    header->strategy = strategy;
+    strcpy(header->pageFile, pageFileName);
+    header->readCnt = 0;
+    header->writeCnt = 0;
+    header->lruCounter = 0;
+    header->fifoCounter = 0;
+    header->lfuCounter = 0;
+    header->clockCounter = 0;
+    memset(header->procs, 0, sizeof(header->procs));
+
+    // Fresh shared memory is zeroed, so only fields which don't start at 0 are set
+    for(int frame = 0; frame < numFrames; frame++) {
+        pool->pageNos[frame] = NO_PAGE;
+        pool->lruPos[frame] = INT_MAX;
+        pool->fifoPos[frame] = INT_MAX;
+        pool->lfuPos[frame] = INT_MAX;
+    }
+
+    __atomic_store_n(&header->state, SHARED_POOL_READY, __ATOMIC_RELEASE);
+}
+
+// Function to wait until the creator of a pool has sized its shared memory. Returns the size, 0 on timeout
+static size_t waitForSharedSize(int fd) {
+    struct stat st;
+
+    for(int waited = 0; waited < SHARED_ATTACH_MILLIS; waited++) {
+        if(fstat(fd, &st) == 0 && st.st_size > 0) {
+            return (size_t) st.st_size;
+        }
+        usleep(1000);
+    }
+
+    return 0;
+}
+
+// Function to wait until the creator of a pool has set it up. Returns the pool's state, SHARED_POOL_INITIALIZING on timeout
+static unsigned int waitForSharedPool(SharedPool *pool) {
+    for(int waited = 0; waited < SHARED_ATTACH_MILLIS; waited++) {
+        unsigned int state = __atomic_load_n(&pool->header->state, __ATOMIC_ACQUIRE);
+        if(state != SHARED_POOL_INITIALIZING) {
+            return state;
+        }
+        usleep(1000);
+    }
+
+    return SHARED_POOL_INITIALIZING;
+}
+
+// Function to take a process slot of a ready pool. Returns SHARED_POOL_GONE if the last process removed it meanwhile
+static RC registerProcess(SharedPool *pool, int numFrames, ReplacementStrategy strategy, const char *pageFileName) {
+    SharedHeader *header = pool->header;
+
+    lockShared(pool);
+
+    if(header->state != SHARED_POOL_READY) {
+        unlockShared(pool);
+        return SHARED_POOL_GONE;
+    }
+
+    if(header->numFrames != numFrames || header->strategy != (int) strategy || strcmp(header->pageFile, pageFileName) != 0) {
+        unlockShared(pool);
+        printf("Shared Pool: Pool '%s' has %d frames of '%s', which doesn't match this pool.\n", pool->name,
+                header->numFrames, header->pageFile);
+        return RC_SHARED_POOL;
+    }
+
+    reapDeadProcesses(pool);
+
+    pool->slot = -1;
+    for(int slot = 0; slot < MAX_SHARED_PROCESSES && pool->slot == -1; slot++) {
+        if(header->procs[slot] == 0) {
+            header->procs[slot] = getpid();
+            pool->slot = slot;
+        }
+    }
+
+    unlockShared(pool);
+
+    if(pool->slot == -1) {
+        printf("Shared Pool: Pool '%s' already has %d processes attached.\n", pool->name, MAX_SHARED_PROCESSES);
+        return RC_SHARED_POOL;
+    }
+
+    return RC_OK;
+}
+
+// Function to map the shared memory of a pool, creating it if no process has it. Returns SHARED_POOL_GONE if the pool
+// went away before it could be mapped
+static RC mapSharedPool(SharedPool *pool, int numFrames, ReplacementStrategy strategy, const char *pageFileName) {
+    bool created = true;
+    int fd = shm_open(pool->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if(fd != -1) {
+        if(ftruncate(fd, pool->size) != 0) {
+            close(fd);
+            shm_unlink(pool->name);
+            printf("Shared Pool: Could not size pool '%s'.\n", pool->name);
+            return RC_OUT_OF_MEMORY;
+        }
+    } else if(errno == EEXIST) {
+        created = false;
+
+        fd = shm_open(pool->name, O_RDWR, 0600);
+        if(fd == -1) {
+            return SHARED_POOL_GONE;
+        }
+
+        size_t size = waitForSharedSize(fd);
+        if(size != pool->size) {
+            close(fd);
+            printf("Shared Pool: Pool '%s' has a size which doesn't match this pool.\n", pool->name);
+            return RC_SHARED_POOL;
+        }
+    } else {
+        printf("Shared Pool: Could not open pool '%s'.\n", pool->name);
+        return RC_SHARED_POOL;
+    }
+
+    char *base = (char*) mmap(NULL, pool->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if(base == MAP_FAILED) {
+        if(created) {
+            shm_unlink(pool->name);
+        }
+        printf("Shared Pool: Could not map pool '%s'.\n", pool->name);
+        return RC_OUT_OF_MEMORY;
+    }
+
+    layoutSharedPool(pool, base, numFrames);
+
+    if(created) {
+        initSharedHeader(pool, numFrames, strategy, pageFileName);
+        printf("Shared Pool: Created pool '%s' with %d frames.\n", pool->name, numFrames);
+        return RC_OK;
+    }
+
+    unsigned int state = waitForSharedPool(pool);
+    if(state == SHARED_POOL_READY) {
+        return RC_OK;
+    }
+
+    munmap(base, pool->size);
+    if(state == SHARED_POOL_REMOVED) {
+        return SHARED_POOL_GONE;
+    }
+
+    printf("Shared Pool: Pool '%s' was never set up by the process which created it.\n", pool->name);
+    return RC_SHARED_POOL;
+}
+
+// Function to create a shared pool of numFrames frames over a page file, or to attach to it if another process already
+// created it. All processes must use the same frames, strategy and page file
+RC attachSharedPool(const char *name, const char *pageFileName, int numFrames, ReplacementStrategy strategy, SharedPool **out) {
+    if(strlen(pageFileName) >= SHARED_FILE_NAME_LEN || numFrames <= 0) {
+        printf("Shared Pool: Page file name or number of frames is invalid.\n");
+        return RC_SHARED_POOL;
+    }
+
+    SharedPool *pool = (SharedPool*)calloc(1, sizeof(SharedPool));
+
+    if(openPageFile((char*) pageFileName, &pool->fHandle) != RC_OK) {
+        free(pool);
+        return RC_FILE_NOT_FOUND;
+    }
+
+    pool->name = strdup(name);
+    pool->size = layoutSharedPool(NULL, NULL, numFrames);
+
+    // The last process may remove the pool while this one attaches. It is then created again
+    RC rc = SHARED_POOL_GONE;
+    for(int attempt = 0; attempt < SHARED_ATTACH_TRIES && rc == SHARED_POOL_GONE; attempt++) {
+        rc = mapSharedPool(pool, numFrames, strategy, pageFileName);
+        if(rc != RC_OK) {
+            continue;
+        }
+
+        rc = registerProcess(pool, numFrames, strategy, pageFileName);
+        if(rc != RC_OK) {
+            munmap(pool->base, pool->size);
+        }
+    }
+
+    if(rc != RC_OK) {
+        closePageFile(&pool->fHandle);
+        free(pool->name);
+        free(pool);
+        return rc == SHARED_POOL_GONE ? RC_SHARED_POOL : rc;
+    }
+
+    *out = pool;
+    return RC_OK;
+}
+
+// Function to write the dirty page of a frame. Other processes may have grown the file, so its size is read first
+static RC writeSharedFrame(SharedPool *pool, int frame) {
+    refreshPageCount(&pool->fHandle);
+
+    if(writeBlock(pool->pageNos[frame], &pool->fHandle, pool->pageData + (size_t) PAGE_SIZE * frame) != RC_OK
+            || flushBlockWrites(&pool->fHandle) != RC_OK) {
+        printf("Shared Pool: Could not write page %d to disk.\n", pool->pageNos[frame]);
+        return RC_WRITE_FAILED;
+    }
+
+    pool->dirtyFlags[frame] = false;
+    pool->header->writeCnt++;
+    return RC_OK;
+}
+
+// Function to choose the unpinned frame the pool's strategy evicts next. Returns -1 if all frames are pinned
+static int chooseSharedVictim(SharedPool *pool) {
+    SharedHeader *header = pool->header;
+    int numFrames = header->numFrames;
+
+    switch(header->strategy) {
+        case RS_FIFO:
+            return findMinUnpinned(pool->pinCnts, pool->fifoPos, numFrames);
+
+        case RS_LFU:
+            return findMinUnpinnedPair(pool->pinCnts, pool->lfuHits, pool->lfuPos, numFrames);
+
+        case RS_CLOCK:
+            if(findValue(pool->pinCnts, 0, numFrames, 0) == -1) {
+                return -1;
+            }
+
+            // Frames get a second chance until the hand comes by again
+            while(pool->pinCnts[header->clockCounter] > 0 || pool->clockChances[header->clockCounter]) {
+                pool->clockChances[header->clockCounter] = false;
+                header->clockCounter = (header->clockCounter + 1) % numFrames;
+            }
+            return header->clockCounter;
+
+        default:
+            return findMinUnpinned(pool->pinCnts, pool->lruPos, numFrames);
+    }
+}
+
+// Function to read a page into a frame, writing the page it held first if it is dirty. The frame is empty while the
+// page is read, so a process dying meanwhile leaves no half read page behind
+static RC loadSharedFrame(SharedPool *pool, int frame, const PageNumber pageNum) {
+    SharedHeader *header = pool->header;
+
+    if(pool->dirtyFlags[frame] && writeSharedFrame(pool, frame) != RC_OK) {
+        return RC_WRITE_FAILED;
+    }
+
+    pool->pageNos[frame] = NO_PAGE;
+
+    refreshPageCount(&pool->fHandle);
+    if(pageNum >= pool->fHandle.totalNumPages) {
+        ensureCapacity(pageNum + 1, &pool->fHandle);
+        flushBlockWrites(&pool->fHandle);
+    }
+
+    RC rc = readBlockDirect(pageNum, &pool->fHandle, pool->pageData + (size_t) PAGE_SIZE * frame);
+    if(rc != RC_OK) {
+        return rc;
+    }
+
+    header->readCnt++;
+    pool->pageNos[frame] = pageNum;
+    pool->dirtyFlags[frame] = false;
+
+    pool->fifoPos[frame] = header->fifoCounter++;
+    pool->lruPos[frame] = header->lruCounter++;
+    pool->lfuPos[frame] = header->lfuCounter++;
+    pool->lfuHits[frame] = 0;
+    pool->clockChances[frame] = true;
+
+    return RC_OK;
+}
+
+// Function to find the frame of a page handle. Uses the frame remembered in the handle if it still holds the page
+static int findSharedFrame(SharedPool *pool, BM_PageHandle *const page) {
+    int frame = page->frameNum;
+
+    if(frame >= 0 && frame < pool->header->numFrames && pool->pageNos[frame] == page->pageNum) {
+        return frame;
+    }
+
+    return findValue(pool->pageNos, 0, pool->header->numFrames, page->pageNum);
+}
+
+// Function to pin a page for this process. A page another process read is a hit, so hot pages are cached once
+RC pinSharedPage(SharedPool *pool, BM_PageHandle *const page, const PageNumber pageNum) {
+    SharedHeader *header = pool->header;
+
+    if(pageNum < 0) {
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+
+    lockShared(pool);
+
+    int frame = findValue(pool->pageNos, 0, header->numFrames, pageNum);
+
+    if(frame != -1) {
+        pool->lruPos[frame] = header->lruCounter++;
+        pool->clockChances[frame] = true;
+        printf("Shared Pool: Page %d is already in frame %d.\n", pageNum, frame);
+    } else {
+        frame = findValue(pool->pageNos, 0, header->numFrames, NO_PAGE);
+
+        // Pins of processes which ended without unpinning may be all that keeps the frames in use
+        if(frame == -1) {
+            frame = chooseSharedVictim(pool);
+        }
+        if(frame == -1) {
+            reapDeadProcesses(pool);
+            frame = chooseSharedVictim(pool);
+        }
+
+        if(frame == -1) {
+            unlockShared(pool);
+            printf("Shared Pool: Could not pin page. All Pages are in use.\n");
+            return RC_WRITE_FAILED;
+        }
+
+        RC rc = loadSharedFrame(pool, frame, pageNum);
+        if(rc != RC_OK) {
+            unlockShared(pool);
+            return rc;
+        }
+
+        printf("Shared Pool: Page %d pinned to frame %d.\n", pageNum, frame);
+    }
+
+    // This process's pin is counted before the total, so a recount after it died never misses a pin
+    pinsOf(pool, pool->slot)[frame]++;
+    pool->pinCnts[frame]++;
+    pool->lfuHits[frame]++;
+
+    page->data = pool->pageData + (size_t) PAGE_SIZE * frame;
+    page->pageNum = pageNum;
+    page->fileId = MAIN_FILE_ID;
+    page->frameNum = frame;
+    page->frameGen = 0;
+
+    unlockShared(pool);
+    return RC_OK;
+}
+
+RC unpinSharedPage(SharedPool *pool, BM_PageHandle *const page) {
+    lockShared(pool);
+
+    int frame = findSharedFrame(pool, page);
+    if(frame == -1) {
+        unlockShared(pool);
+        printf("Shared Pool: Page %d does not exist in the buffer.\n", page->pageNum);
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+
+    int *pins = pinsOf(pool, pool->slot);
+    if(pins[frame] == 0) {
+        unlockShared(pool);
+        printf("Shared Pool: Page %d is not pinned by this process.\n", page->pageNum);
+        return RC_PAGE_NOT_PINNED;
+    }
+
+    pins[frame]--;
+    pool->pinCnts[frame]--;
+
+    if(pool->header->strategy == RS_LRU) {
+        pool->lruPos[frame] = pool->header->lruCounter++;
+    }
+
+    unlockShared(pool);
+    return RC_OK;
+}
+
+RC markSharedDirty(SharedPool *pool, BM_PageHandle *const page) {
+    lockShared(pool);
+
+    int frame = findSharedFrame(pool, page);
+    if(frame != -1) {
+        pool->dirtyFlags[frame] = true;
+    }
+
+    unlockShared(pool);
+    return frame != -1 ? RC_OK : RC_READ_NON_EXISTING_PAGE;
+}
+
+RC forceSharedPage(SharedPool *pool, BM_PageHandle *const page) {
+    RC rc = RC_OK;
+
+    lockShared(pool);
+
+    int frame = findSharedFrame(pool, page);
+    if(frame == -1) {
+        rc = RC_READ_NON_EXISTING_PAGE;
+    } else if(pool->dirtyFlags[frame]) {
+        rc = writeSharedFrame(pool, frame);
+    }
+
+    unlockShared(pool);
+    return rc;
+}
+
+static RC flushSharedFrames(SharedPool *pool) {
+    for(int frame = 0; frame < pool->header->numFrames; frame++) {
+        if(pool->dirtyFlags[frame] && pool->pinCnts[frame] == 0 && writeSharedFrame(pool, frame) != RC_OK) {
+            return RC_WRITE_FAILED;
+        }
+    }
+
+    return RC_OK;
+}
+
+// Function to write the dirty unpinned pages of the pool, whichever process changed them
+RC flushSharedPool(SharedPool *pool) {
+    lockShared(pool);
+    RC rc = flushSharedFrames(pool);
+    unlockShared(pool);
+
+    return rc;
+}
+
+// Function to detach this process from the pool. The last process attached writes the dirty pages and removes the pool,
+// so the next one creates it again
+RC detachSharedPool(SharedPool *pool) {
+    SharedHeader *header = pool->header;
+
+    lockShared(pool);
+    reapDeadProcesses(pool);
+
+    int *pins = pinsOf(pool, pool->slot);
+    for(int frame = 0; frame < header->numFrames; frame++) {
+        if(pins[frame] > 0) {
+            unlockShared(pool);
+            printf("Shared Pool: This process still has page(s) pinned.\n");
+            return RC_IM_KEY_ALREADY_EXISTS;
+        }
+    }
+
+    bool last = true;
+    for(int slot = 0; slot < MAX_SHARED_PROCESSES; slot++) {
+        last = last && (slot == pool->slot || header->procs[slot] == 0);
+    }
+
+    if(last) {
+        if(flushSharedFrames(pool) != RC_OK) {
+            unlockShared(pool);
+            return RC_WRITE_FAILED;
+        }
+
+        __atomic_store_n(&header->state, SHARED_POOL_REMOVED, __ATOMIC_RELEASE);
+        shm_unlink(pool->name);
+        printf("Shared Pool: Last process detached. Removed pool '%s'.\n", pool->name);
+    }
+
+    header->procs[pool->slot] = 0;
+    unlockShared(pool);
+
+    munmap(pool->base, pool->size);
+    closePageFile(&pool->fHandle);
+    free(pool->name);
+    free(pool);
+
+    return RC_OK;
+}
+
+// Function to fill a snapshot with the frames and I/O counts of the pool, counted over all processes
+RC readSharedPool(SharedPool *pool, BM_PoolSnapshot *const snapshot) {
+    SharedHeader *header = pool->header;
+
+    lockShared(pool);
+
+    snapshot->numFrames = header->numFrames;
+    if(snapshot->capacity < header->numFrames) {
+        unlockShared(pool);
+        return RC_BUFFER_TOO_SMALL;
+    }
+
+    for(int frame = 0; frame < header->numFrames; frame++) {
+        if(snapshot->pageNums != NULL) {
+            snapshot->pageNums[frame] = pool->pageNos[frame];
+        }
+        if(snapshot->dirtyFlags != NULL) {
+            snapshot->dirtyFlags[frame] = pool->dirtyFlags[frame];
+        }
+        if(snapshot->fixCounts != NULL) {
+            snapshot->fixCounts[frame] = pool->pinCnts[frame];
+        }
+        if(snapshot->fileIds != NULL) {
+            snapshot->fileIds[frame] = MAIN_FILE_ID;
+        }
+    }
+
+    snapshot->numReadIO = header->readCnt;
+    snapshot->numWriteIO = header->writeCnt;
+
+    unlockShared(pool);
+    return RC_OK;
+}
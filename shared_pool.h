@@ -0,0 +1,35 @@
+#ifndef SHARED_POOL_H
+#define SHARED_POOL_H
+
+#include "buffer_mgr.h"
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+// A process's attachment to a buffer pool in POSIX shared memory. The pool holds frames, page table and replacement
+// state, is latched by a process shared robust mutex and is used by every process attached to the same name
+typedef struct SharedPool SharedPool;
+
+// Most processes attached to one shared pool at once
+#define MAX_SHARED_PROCESSES 64
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+/* creates the pool if no process has it yet, otherwise attaches to it */
+extern RC attachSharedPool (const char *name, const char *pageFileName, int numFrames, ReplacementStrategy strategy,
+		SharedPool **pool);
+/* fails while the process holds pins. The last process flushes the pool and removes it */
+extern RC detachSharedPool (SharedPool *pool);
+
+/* page access */
+extern RC pinSharedPage (SharedPool *pool, BM_PageHandle *const page, const PageNumber pageNum);
+extern RC unpinSharedPage (SharedPool *pool, BM_PageHandle *const page);
+extern RC markSharedDirty (SharedPool *pool, BM_PageHandle *const page);
+extern RC forceSharedPage (SharedPool *pool, BM_PageHandle *const page);
+extern RC flushSharedPool (SharedPool *pool);
+
+/* statistics */
+extern RC readSharedPool (SharedPool *pool, BM_PoolSnapshot *const snapshot);
+
+#endif
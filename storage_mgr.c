@@ -6,8 +6,11 @@ Author: Pradyumna Deshpande
 // Imports
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include "storage_mgr.h"
 #include "dberror.h"
+#include "page_tier.h"
 
 FILE *file;            //File pointer (will be reused throughout the code)
 
@@ -50,6 +53,7 @@ RC openPageFile(char *fileName, SM_FileHandle *fHandle) {
     fHandle->fileName = fileName;
     fHandle->curPagePos = 0;
     fHandle->mgmtInfo = file;
+    fHandle->tierInfo = NULL;
 
     fseek(file, 0, SEEK_END);                                                       // Traverse to the end of file
     fHandle->totalNumPages = ftell(file) / PAGE_SIZE;
@@ -67,6 +71,13 @@ RC closePageFile(SM_FileHandle *fHandle) {
     }
 
     file = fHandle->mgmtInfo;
+    RC tierRC = RC_OK;
+
+    // Pages only the tier has are written to the file before it is closed
+    if(fHandle->tierInfo != NULL) {
+        tierRC = destroyPageTier(fHandle->tierInfo, file);
+        fHandle->tierInfo = NULL;
+    }
 
     // In case file is already closed or doesn't exist
     if(fclose(file) != 0) {
@@ -75,6 +86,13 @@ RC closePageFile(SM_FileHandle *fHandle) {
         return RC_FILE_NOT_FOUND;
     }
 
+    // File is closed anyway. Pages which couldn't be written are only left in the tier file
+    if(tierRC != RC_OK) {
+        printf("Operation Close: Not all pages of the tier could be written to '%s'.\n", fHandle->fileName);
+        RC_message = "Unable to write the pages of the tier to the file. They are only in the tier file.";
+        return tierRC;
+    }
+
     printf("Operation: File '%s' closed successfully.\n", fHandle->fileName);
     return RC_OK;
 }
@@ -108,9 +126,149 @@ RC readBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage) {
     }
 
     file = fHandle->mgmtInfo;
+    fHandle->curPagePos = pageNum;
+
+    // Pages in the local tier aren't read from the file
+    unsigned int writeSeq;
+    if(fHandle->tierInfo != NULL && readTierPage(fHandle->tierInfo, pageNum, memPage, &writeSeq)) {
+        printf("Operation: Read complete from page %d in the tier of '%s'.\n", pageNum, fHandle->fileName);
+        return RC_OK;
+    }
+
     fseek(file, pageNum*PAGE_SIZE, SEEK_SET);                                       // Seek to start of the file and traverse to the required page
     fread(memPage, sizeof(char), PAGE_SIZE, file);                                  // Read contents of the page
-    fHandle->curPagePos = pageNum;
+
+    if(fHandle->tierInfo != NULL) {
+        fillTierPage(fHandle->tierInfo, pageNum, memPage, writeSeq, file);
+    }
+
+    printf("Operation: Read complete from page %d in '%s'.\n", pageNum, fHandle->fileName);
+    return RC_OK;
+}
+
+// Read several pages from the file itself. Every run of consecutive page numbers is read with one vectored read
+static RC readBlockRuns(int *pageNums, int numPages, SM_FileHandle *fHandle, SM_PageHandle *memPages) {
+    int fd = fileno((FILE*) fHandle->mgmtInfo);
+
+    struct iovec iov[MAX_BLOCKS_PER_READ];
+    int i = 0;
+
+    while(i < numPages) {
+        int run = 0;
+
+        // Collect the run of consecutive pages starting at pageNums[i]
+        while(i + run < numPages && run < MAX_BLOCKS_PER_READ && pageNums[i + run] == pageNums[i] + run) {
+            iov[run].iov_base = memPages[i + run];
+            iov[run].iov_len = PAGE_SIZE;
+            run++;
+        }
+
+        ssize_t bytesRead = preadv(fd, iov, run, (off_t) pageNums[i] * PAGE_SIZE);   // Read the whole run at its offset
+        if(bytesRead != (ssize_t) run * PAGE_SIZE) {
+            printf("Operation Read: Could not read pages %d to %d in '%s'.\n", pageNums[i], pageNums[i] + run - 1, fHandle->fileName);
+            return RC_READ_NON_EXISTING_PAGE;
+        }
+
+        i += run;
+    }
+
+    return RC_OK;
+}
+
+// Read several pages from the local tier where it has them and the rest from the file. Pages read from the file are
+// added to the tier
+static RC readTieredBlocks(int *pageNums, int numPages, SM_FileHandle *fHandle, SM_PageHandle *memPages) {
+    int *missedPages = (int*)malloc(sizeof(int) * numPages);
+    SM_PageHandle *missedMem = (SM_PageHandle*)malloc(sizeof(SM_PageHandle) * numPages);
+    unsigned int *writeSeqs = (unsigned int*)malloc(sizeof(unsigned int) * numPages);
+    int numMissed = 0;
+
+    for(int i = 0; i < numPages; i++) {
+        if(!readTierPage(fHandle->tierInfo, pageNums[i], memPages[i], &writeSeqs[numMissed])) {
+            missedPages[numMissed] = pageNums[i];
+            missedMem[numMissed] = memPages[i];
+            numMissed++;
+        }
+    }
+
+    RC rc = readBlockRuns(missedPages, numMissed, fHandle, missedMem);
+
+    for(int i = 0; rc == RC_OK && i < numMissed; i++) {
+        fillTierPage(fHandle->tierInfo, missedPages[i], missedMem[i], writeSeqs[i], fHandle->mgmtInfo);
+    }
+
+    free(missedPages);
+    free(missedMem);
+    free(writeSeqs);
+
+    return rc;
+}
+
+// Read several pages. Every run of consecutive page numbers is read with one vectored read (pageNums must be sorted)
+RC readBlocks(int *pageNums, int numPages, SM_FileHandle *fHandle, SM_PageHandle *memPages) {
+
+    // Check if given file handle is valid
+    if(fHandle == NULL) {
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    // Invalid page number. Page doesn't exist
+    for(int i = 0; i < numPages; i++) {
+        if(pageNums[i] >= fHandle->totalNumPages || pageNums[i] < 0) {
+            printf("Operation Read: Page %d in '%s' doesn't exist.\n", pageNums[i], fHandle->fileName);
+            return RC_READ_NON_EXISTING_PAGE;
+        }
+    }
+
+    file = fHandle->mgmtInfo;
+    fflush(file);                                                                   // Buffered writes of the stream must reach the file first
+
+    RC rc = fHandle->tierInfo != NULL ? readTieredBlocks(pageNums, numPages, fHandle, memPages)
+            : readBlockRuns(pageNums, numPages, fHandle, memPages);
+    if(rc != RC_OK) {
+        return rc;
+    }
+
+    if(numPages > 0) {
+        fHandle->curPagePos = pageNums[numPages - 1];
+    }
+
+    printf("Operation: Read complete from %d pages in '%s'.\n", numPages, fHandle->fileName);
+    return RC_OK;
+}
+
+// Read the given page straight into memPage with one system call. The stream and its buffer are not used, so several
+// threads can read the same file at once. Buffered writes of the file have to be flushed with flushBlockWrites first
+RC readBlockDirect(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage) {
+
+    // Check if given file handle is valid
+    if(fHandle == NULL) {
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    // Pages past the end of the file give a short read below
+    if(pageNum < 0) {
+        printf("Operation Read: Page %d in '%s' doesn't exist.\n", pageNum, fHandle->fileName);
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+
+    // Pages in the local tier aren't read from the file
+    unsigned int writeSeq;
+    if(fHandle->tierInfo != NULL && readTierPage(fHandle->tierInfo, pageNum, memPage, &writeSeq)) {
+        printf("Operation: Read complete from page %d in the tier of '%s'.\n", pageNum, fHandle->fileName);
+        return RC_OK;
+    }
+
+    int fd = fileno((FILE*) fHandle->mgmtInfo);
+    ssize_t bytesRead = pread(fd, memPage, PAGE_SIZE, (off_t) pageNum * PAGE_SIZE);   // Read the page at its offset
+    if(bytesRead != PAGE_SIZE) {
+        printf("Operation Read: Page %d in '%s' doesn't exist.\n", pageNum, fHandle->fileName);
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+
+    if(fHandle->tierInfo != NULL) {
+        fillTierPage(fHandle->tierInfo, pageNum, memPage, writeSeq, fHandle->mgmtInfo);
+    }
 
     printf("Operation: Read complete from page %d in '%s'.\n", pageNum, fHandle->fileName);
     return RC_OK;
@@ -191,9 +349,22 @@ RC writeBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage) {
     }
 
     file = fHandle->mgmtInfo;
+    fHandle->curPagePos = pageNum;
+
+    if(fHandle->tierInfo != NULL) {
+        if(writeTierPage(fHandle->tierInfo, pageNum, memPage, file) != RC_OK) {
+            return RC_WRITE_FAILED;
+        }
+
+        // Page file gets the page once the tier evicts it or is flushed
+        if(isWriteBack(fHandle->tierInfo)) {
+            printf("Operation: Write complete to page %d in the tier of '%s'.\n", pageNum, fHandle->fileName);
+            return RC_OK;
+        }
+    }
+
     fseek(file, pageNum*PAGE_SIZE, SEEK_SET);                                       // Seek to start of file and traverse to the required page
     fwrite(memPage, sizeof(char), PAGE_SIZE, file);                                 // Write to the page
-    fHandle->curPagePos = pageNum;
 
     printf("Operation: Write complete to page %d in '%s'.\n", pageNum, fHandle->fileName);
     return RC_OK;
@@ -232,6 +403,22 @@ RC appendEmptyBlock(SM_FileHandle *fHandle) {
     return RC_OK;
 }
 
+// Write buffered writes of the file to it, so reads which don't use the stream see them
+RC flushBlockWrites(SM_FileHandle *fHandle) {
+
+    // Check if given file handle is valid
+    if(fHandle == NULL) {
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    if(fflush((FILE*) fHandle->mgmtInfo) != 0) {
+        printf("Operation Write: Could not flush writes to '%s'.\n", fHandle->fileName);
+        return RC_WRITE_FAILED;
+    }
+
+    return RC_OK;
+}
+
 // Change page count by adding pages to the file if given_page_count > current_page_count
 RC ensureCapacity(int numberOfPages, SM_FileHandle *fHandle) {
 
@@ -248,3 +435,66 @@ RC ensureCapacity(int numberOfPages, SM_FileHandle *fHandle) {
     return RC_OK;
 }
 
+// Read the page count of the file again, since other processes sharing the file may have added pages to it
+RC refreshPageCount(SM_FileHandle *fHandle) {
+
+    // Check if given file handle is valid
+    if(fHandle == NULL) {
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    file = fHandle->mgmtInfo;
+    fseek(file, 0, SEEK_END);                                                       // Traverse to the end of file
+    fHandle->totalNumPages = ftell(file) / PAGE_SIZE;
+
+    return RC_OK;
+}
+
+// Put a local page file of numPages pages in front of the file. Reads check it before the file and pages read from the
+// file are added to it, replacing others by CLOCK. Writes go to it as well (and only to it in write-back mode)
+RC attachPageTier(SM_FileHandle *fHandle, char *tierFileName, int numPages, SM_TierMode mode) {
+
+    // Check if given file handle is valid
+    if(fHandle == NULL) {
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    if(fHandle->tierInfo != NULL) {
+        printf("Operation Tier: '%s' already has a tier.\n", fHandle->fileName);
+        return RC_TIER_FAILED;
+    }
+
+    PageTier *tier;
+    RC rc = createPageTier(tierFileName, numPages, mode, &tier);
+    if(rc != RC_OK) {
+        return rc;
+    }
+
+    fHandle->tierInfo = tier;
+
+    printf("Operation: Tier '%s' attached to '%s'.\n", tierFileName, fHandle->fileName);
+    return RC_OK;
+}
+
+// Write the pages only the tier has to the file
+RC flushPageTier(SM_FileHandle *fHandle) {
+
+    // Check if given file handle is valid
+    if(fHandle == NULL || fHandle->tierInfo == NULL) {
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    return flushTier(fHandle->tierInfo, fHandle->mgmtInfo);
+}
+
+// Get the reads the tier had the page for and the reads which went to the file
+RC getPageTierStats(SM_FileHandle *fHandle, int *hits, int *misses) {
+
+    // Check if given file handle is valid
+    if(fHandle == NULL || fHandle->tierInfo == NULL) {
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    readTierStats(fHandle->tierInfo, hits, misses);
+    return RC_OK;
+}
@@ -11,10 +11,20 @@ typedef struct SM_FileHandle {
 	int totalNumPages;
 	int curPagePos;
 	void *mgmtInfo;
+	void *tierInfo; // local tier caching the file's pages, NULL if it has none
 } SM_FileHandle;
 
 typedef char* SM_PageHandle;
 
+// Most pages readBlocks reads with a single system call
+#define MAX_BLOCKS_PER_READ 64
+
+// Write modes of a local tier in front of a page file
+typedef enum SM_TierMode {
+	TIER_WRITE_THROUGH = 0, // writes go to the tier and the page file
+	TIER_WRITE_BACK = 1 // writes only go to the tier. The page file gets them when the tier evicts the page or is flushed
+} SM_TierMode;
+
 /************************************************************
  *                    interface                             *
  ************************************************************/
@@ -27,6 +37,8 @@ extern RC destroyPageFile (char *fileName);
 
 /* reading blocks from disc */
 extern RC readBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage);
+extern RC readBlocks (int *pageNums, int numPages, SM_FileHandle *fHandle, SM_PageHandle *memPages);
+extern RC readBlockDirect (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern int getBlockPos (SM_FileHandle *fHandle);
 extern RC readFirstBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC readPreviousBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
@@ -39,5 +51,12 @@ extern RC writeBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage
 extern RC writeCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC appendEmptyBlock (SM_FileHandle *fHandle);
 extern RC ensureCapacity (int numberOfPages, SM_FileHandle *fHandle);
+extern RC flushBlockWrites (SM_FileHandle *fHandle);
+extern RC refreshPageCount (SM_FileHandle *fHandle);
+
+/* local tier of numPages pages in front of a slow page file. Closing the file flushes and removes the tier */
+extern RC attachPageTier (SM_FileHandle *fHandle, char *tierFileName, int numPages, SM_TierMode mode);
+extern RC flushPageTier (SM_FileHandle *fHandle);
+extern RC getPageTierStats (SM_FileHandle *fHandle, int *hits, int *misses);
 
 #endif
@@ -0,0 +1,172 @@
+/*
+tenant_quota.c
+Author: Pradyumna Deshpande
+*/
+
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+
+#include "tenant_quota.h"
+
+#define CACHE_LINE_SIZE 64
+
+// Struct for the counters of one tenant, on a cache line of its own so pins of different tenants don't contend
+typedef struct TenantCounts {
+    uint64_t hits;
+    uint64_t misses;
+    char padding[CACHE_LINE_SIZE - 2 * sizeof(uint64_t)];
+} TenantCounts;
+
+struct TenantQuotas {
+    TenantCounts counts[MAX_TENANTS];
+    int reservedFrames[MAX_TENANTS];
+    int maxFrames[MAX_TENANTS];     // 0 = no limit
+    bool hasLimits;
+};
+
+TenantQuotas *createTenantQuotas(void) {
+    TenantQuotas *quotas = NULL;
+
+    if(posix_memalign((void**) &quotas, CACHE_LINE_SIZE, sizeof(TenantQuotas)) != 0) {
+        return NULL;
+    }
+
+    memset(quotas, 0, sizeof(TenantQuotas));
+    return quotas;
+}
+
+void destroyTenantQuotas(TenantQuotas *quotas) {
+    free(quotas);
+}
+
+// Function to set the frames of the pool a tenant keeps at least (reservedFrames) and may use at most (maxFrames).
+// Limits are read by pins of other partitions without a latch, so they are stored atomically
+void setTenantLimits(TenantQuotas *quotas, int tenant, int reservedFrames, int maxFrames) {
+    if(quotas == NULL) {
+        return;
+    }
+
+    __atomic_store_n(&quotas->reservedFrames[tenant], reservedFrames, __ATOMIC_RELAXED);
+    __atomic_store_n(&quotas->maxFrames[tenant], maxFrames, __ATOMIC_RELAXED);
+    __atomic_store_n(&quotas->hasLimits, true, __ATOMIC_RELEASE);
+}
+
+bool hasTenantLimits(TenantQuotas *quotas) {
+    return quotas != NULL && __atomic_load_n(&quotas->hasLimits, __ATOMIC_ACQUIRE);
+}
+
+void countTenantPin(TenantQuotas *quotas, int tenant, bool hit) {
+    if(quotas == NULL) {
+        return;
+    }
+
+    __atomic_fetch_add(hit ? &quotas->counts[tenant].hits : &quotas->counts[tenant].misses, 1, __ATOMIC_RELAXED);
+}
+
+void readTenantCounts(TenantQuotas *quotas, int tenant, uint64_t *hits, uint64_t *misses) {
+    if(quotas == NULL) {
+        *hits = 0;
+        *misses = 0;
+        return;
+    }
+
+    *hits = __atomic_load_n(&quotas->counts[tenant].hits, __ATOMIC_RELAXED);
+    *misses = __atomic_load_n(&quotas->counts[tenant].misses, __ATOMIC_RELAXED);
+}
+
+static int loadMaxFrames(TenantQuotas *quotas, int tenant) {
+    return quotas != NULL ? __atomic_load_n(&quotas->maxFrames[tenant], __ATOMIC_RELAXED) : 0;
+}
+
+static int loadReservedFrames(TenantQuotas *quotas, int tenant) {
+    return quotas != NULL ? __atomic_load_n(&quotas->reservedFrames[tenant], __ATOMIC_RELAXED) : 0;
+}
+
+// Function to get a partition's share of a limit for the whole pool. Rounded up, so a limit of a few frames doesn't
+// become 0 in every partition
+static int partitionShare(int frames, int numFrames, int poolFrames) {
+    if(frames <= 0 || poolFrames <= 0) {
+        return 0;
+    }
+
+    return (int) (((int64_t) frames * numFrames + poolFrames - 1) / poolFrames);
+}
+
+static int countOwnedFrames(int tenant, const int *owners, const PageNumber *pageNos, int numFrames) {
+    int owned = 0;
+
+    for(int frame = 0; frame < numFrames; frame++) {
+        if(pageNos[frame] != NO_PAGE && owners[frame] == tenant) {
+            owned++;
+        }
+    }
+
+    return owned;
+}
+
+// Function to check if a tenant already uses as many frames of the partition as its quota allows. It may then only
+// replace pages of its own
+bool tenantAtQuota(TenantQuotas *quotas, int tenant, const int *owners, const PageNumber *pageNos, int numFrames, int poolFrames) {
+    int maxFrames = loadMaxFrames(quotas, tenant);
+
+    if(maxFrames == 0) {
+        return false;
+    }
+
+    return countOwnedFrames(tenant, owners, pageNos, numFrames) >= partitionShare(maxFrames, numFrames, poolFrames);
+}
+
+// Function to fill victimPins with the fix counts the replacement strategy should see for a miss of the tenant. Frames
+// the tenant may not evict are shown as pinned: frames of others if the tenant is at its quota, and frames of other
+// tenants which would drop below their reservation. Of the rest, only frames of the lowest priority are shown as
+// unpinned, so pages of higher priority pins stay as long as lower ones can be evicted. Returns the number of frames
+// shown as unpinned
+int markTenantVictims(TenantQuotas *quotas, int tenant, const int *pinCnts, const PageNumber *pageNos, const int *owners,
+        const int *priorities, int numFrames, int poolFrames, int *victimPins) {
+    int owned[MAX_TENANTS] = {0};
+    int reserved[MAX_TENANTS];
+
+    for(int frame = 0; frame < numFrames; frame++) {
+        if(pageNos[frame] != NO_PAGE) {
+            owned[owners[frame]]++;
+        }
+    }
+
+    for(int t = 0; t < MAX_TENANTS; t++) {
+        reserved[t] = partitionShare(loadReservedFrames(quotas, t), numFrames, poolFrames);
+    }
+
+    int maxFrames = loadMaxFrames(quotas, tenant);
+    bool atQuota = maxFrames > 0 && owned[tenant] >= partitionShare(maxFrames, numFrames, poolFrames);
+    int minPriority = INT_MAX;
+
+    for(int frame = 0; frame < numFrames; frame++) {
+        int owner = owners[frame];
+        bool eligible;
+
+        if(pinCnts[frame] > 0) {
+            eligible = false;
+        } else if(atQuota) {
+            eligible = pageNos[frame] != NO_PAGE && owner == tenant;
+        } else {
+            eligible = pageNos[frame] == NO_PAGE || owner == tenant || owned[owner] > reserved[owner];
+        }
+
+        victimPins[frame] = eligible ? 0 : 1;
+        if(eligible && priorities[frame] < minPriority) {
+            minPriority = priorities[frame];
+        }
+    }
+
+    int numVictims = 0;
+
+    for(int frame = 0; frame < numFrames; frame++) {
+        if(victimPins[frame] == 0 && priorities[frame] > minPriority) {
+            victimPins[frame] = 1;
+        }
+        numVictims += victimPins[frame] == 0 ? 1 : 0;
+    }
+
+    return numVictims;
+}
@@ -0,0 +1,34 @@
+#ifndef TENANT_QUOTA_H
+#define TENANT_QUOTA_H
+
+#include <stdint.h>
+
+#include "buffer_mgr.h"
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+// Frame quotas, reservations and hit/miss counts of the tenants sharing one buffer pool
+typedef struct TenantQuotas TenantQuotas;
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+extern TenantQuotas *createTenantQuotas (void);
+extern void destroyTenantQuotas (TenantQuotas *quotas);
+
+/* limits in frames of the whole pool (maxFrames 0 = no limit) */
+extern void setTenantLimits (TenantQuotas *quotas, int tenant, int reservedFrames, int maxFrames);
+extern bool hasTenantLimits (TenantQuotas *quotas);
+
+/* counters (safe to call from any thread, no latch needed) */
+extern void countTenantPin (TenantQuotas *quotas, int tenant, bool hit);
+extern void readTenantCounts (TenantQuotas *quotas, int tenant, uint64_t *hits, uint64_t *misses);
+
+/* victim selection in a partition holding numFrames of the pool's poolFrames frames */
+extern bool tenantAtQuota (TenantQuotas *quotas, int tenant, const int *owners, const PageNumber *pageNos,
+		int numFrames, int poolFrames);
+extern int markTenantVictims (TenantQuotas *quotas, int tenant, const int *pinCnts, const PageNumber *pageNos,
+		const int *owners, const int *priorities, int numFrames, int poolFrames, int *victimPins);
+
+#endif
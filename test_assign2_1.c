@@ -1,12 +1,20 @@
 #include "storage_mgr.h"
 #include "buffer_mgr_stat.h"
 #include "buffer_mgr.h"
+#include "trace.h"
+#include "frame_search.h"
 #include "dberror.h"
 #include "test_helper.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
 
 // var to store the current test's name
 char *testName;
@@ -37,6 +45,29 @@ static void testReadPage (void);
 
 static void testFIFO (void);
 static void testLRU (void);
+static void testVictimCache (void);
+static void testPartitionedPool (void);
+static void testOptimisticRead (void);
+static void testRepinHandle (void);
+static void testBatchPin (void);
+static void testPoolSnapshot (void);
+static void testPoolMetrics (void);
+static void testPageTrace (void);
+static void testMissRatioCurve (void);
+static void testResizePool (void);
+static void testMultiFilePool (void);
+static void testWarmRestart (void);
+static void testHugePagePool (void);
+static void testFrameSearch (void);
+static void testPageData (void);
+static void testPinWait (void);
+static void testConcurrentMisses (void);
+static void testPinTracking (void);
+static void testTenantQuotas (void);
+static void testPageHints (void);
+static void testSharedPool (void);
+static void testSnapshotReads (void);
+static void testPageTier (void);
 
 // main method
 int
@@ -49,6 +80,29 @@ main (void)
   testReadPage();
   testFIFO();
   testLRU();
+  testVictimCache();
+  testPartitionedPool();
+  testOptimisticRead();
+  testRepinHandle();
+  testBatchPin();
+  testPoolSnapshot();
+  testPoolMetrics();
+  testPageTrace();
+  testMissRatioCurve();
+  testResizePool();
+  testMultiFilePool();
+  testWarmRestart();
+  testHugePagePool();
+  testFrameSearch();
+  testPageData();
+  testPinWait();
+  testConcurrentMisses();
+  testPinTracking();
+  testTenantQuotas();
+  testPageHints();
+  testSharedPool();
+  testSnapshotReads();
+  testPageTier();
 }
 
 // create n pages with content "Page X" and read them back to check whether the content is right
@@ -301,3 +355,1726 @@ testLRU (void)
   free(h);
   TEST_DONE();
 }
+
+// test that evicted pages are restored from the victim cache without reading them from disk
+void
+testVictimCache (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions opts;
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing victim cache for evicted pages";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+
+  initPoolOptions(&opts);
+  opts.victimCacheBytes = 4 * PAGE_SIZE;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &opts));
+
+  // read six pages so that pages 0, 1 and 2 get evicted
+  for(i = 0; i < 6; i++)
+  {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+  }
+  ASSERT_EQUALS_POOL("[3 0],[4 0],[5 0]", bm, "check pool content after evictions");
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "check number of read I/Os");
+
+  // evicted pages come back from the victim cache
+  for(i = 0; i < 3; i++)
+  {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "Page", h->pageNum);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back page from victim cache");
+      CHECK(unpinPage(bm, h));
+  }
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[2 0]", bm, "check pool content after victim hits");
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "victim hits do not read from disk");
+  ASSERT_EQUALS_INT(3, getNumVictimHits(bm), "check number of victim cache hits");
+
+  // pages never read before still miss in the victim cache
+  CHECK(pinPage(bm, h, 50));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(7, getNumReadIO(bm), "check number of read I/Os");
+  ASSERT_EQUALS_INT(7, getNumVictimMisses(bm), "check number of victim cache misses");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test that pages are spread over partitions and each partition replaces its own frames
+void
+testPartitionedPool (void)
+{
+  // expected results
+  const char *poolContents[] = {
+    // even pages go to frames 0-1 and odd pages go to frames 2-3
+    "[0 0],[-1 0],[-1 0],[-1 0]",
+    "[0 0],[-1 0],[1 0],[-1 0]",
+    "[0 0],[2 0],[1 0],[-1 0]",
+    "[0 0],[2 0],[1 0],[3 0]",
+    // FIFO replacement within each partition
+    "[4 0],[2 0],[1 0],[3 0]",
+    "[4 0],[2 0],[5 0],[3 0]",
+    "[4 0],[6 0],[5 0],[3 0]"
+  };
+
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions opts;
+  testName = "Testing partitioned buffer pool";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+
+  initPoolOptions(&opts);
+  opts.numPartitions = 2;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 4, RS_FIFO, NULL, &opts));
+
+  for(i = 0; i < 7; i++)
+  {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+      ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content");
+  }
+
+  ASSERT_EQUALS_INT(7, getNumReadIO(bm), "check number of read I/Os");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test that optimistic reads find resident pages and fail validation once the page changes
+void
+testOptimisticRead (void)
+{
+  int i;
+  unsigned int version;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *reader = MAKE_PAGE_HANDLE();
+  testName = "Testing optimistic reads";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+
+  for(i = 0; i < 3; i++)
+  {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+  }
+
+  // resident page can be read without pinning it
+  CHECK(pinPageOptimistic(bm, reader, 1, &version));
+  ASSERT_EQUALS_STRING("Page-1", reader->data, "optimistic read of resident page");
+  ASSERT_TRUE(validatePage(bm, reader, version), "unchanged page validates");
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[2 0]", bm, "optimistic read does not pin");
+
+  // marking the page dirty invalidates the read
+  CHECK(pinPage(bm, h, 1));
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  ASSERT_TRUE(!validatePage(bm, reader, version), "dirtied page does not validate");
+
+  // a writer using an update pin leaves the page the reader sees alone until it publishes its copy
+  CHECK(pinPageOptimistic(bm, reader, 2, &version));
+  CHECK(pinPageForUpdate(bm, h, 2));
+  sprintf(h->data, "%s-%i", "Updated", 2);
+  CHECK(markDirty(bm, h));
+  ASSERT_EQUALS_STRING("Page-2", reader->data, "reader sees no half written page");
+  ASSERT_TRUE(validatePage(bm, reader, version), "read before the copy is published validates");
+  CHECK(unpinPage(bm, h));
+  ASSERT_TRUE(!validatePage(bm, reader, version), "published copy does not validate");
+  CHECK(pinPageOptimistic(bm, reader, 2, &version));
+  ASSERT_EQUALS_STRING("Updated-2", reader->data, "next read sees the published copy");
+
+  // evicting the page invalidates the read
+  CHECK(pinPageOptimistic(bm, reader, 0, &version));
+  CHECK(pinPage(bm, h, 3));
+  CHECK(unpinPage(bm, h));
+  ASSERT_TRUE(!validatePage(bm, reader, version), "evicted page does not validate");
+  ASSERT_ERROR(pinPageOptimistic(bm, reader, 0, &version), "page that is not resident");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  free(reader);
+  TEST_DONE();
+}
+
+// test that a page handle can be pinned again through the frame it remembers
+void
+testRepinHandle (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *child = MAKE_PAGE_HANDLE();
+  testName = "Testing re-pinning through page handles";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+
+  CHECK(pinPage(bm, child, 1));
+  ASSERT_EQUALS_INT(0, child->frameNum, "handle remembers frame");
+  CHECK(unpinPage(bm, child));
+
+  // page is still in its frame
+  CHECK(repinPage(bm, child));
+  ASSERT_EQUALS_STRING("Page-1", child->data, "re-pinned page content");
+  ASSERT_EQUALS_POOL("[1 1],[-1 0],[-1 0]", bm, "re-pin increases fix count");
+  CHECK(unpinPage(bm, child));
+  ASSERT_EQUALS_INT(1, getNumReadIO(bm), "re-pin of resident page does not read");
+
+  // evict the page so the handle is stale
+  for(i = 2; i < 5; i++)
+  {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+  }
+  ASSERT_EQUALS_POOL("[4 0],[2 0],[3 0]", bm, "page 1 is evicted");
+
+  CHECK(repinPage(bm, child));
+  ASSERT_EQUALS_STRING("Page-1", child->data, "stale handle falls back to reading the page");
+  ASSERT_EQUALS_POOL("[4 0],[1 1],[3 0]", bm, "page 1 is pinned again");
+  ASSERT_EQUALS_INT(1, child->frameNum, "handle points at the new frame");
+  CHECK(unpinPage(bm, child));
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  free(child);
+  TEST_DONE();
+}
+
+// test pinning and unpinning several pages with one call
+void
+testBatchPin (void)
+{
+  int i;
+  const PageNumber firstPages[] = {0,1,2,3,4};
+  const PageNumber mixedPages[] = {3,7,8,3};
+  const PageNumber tooManyPages[] = {10,11,12,13,14,15};
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *pages = (BM_PageHandle *) malloc(sizeof(BM_PageHandle) * 6);
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing batched pin and unpin";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 5, RS_FIFO, NULL));
+
+  // all misses are read together
+  CHECK(pinPages(bm, pages, firstPages, 5));
+  ASSERT_EQUALS_POOL("[0 1],[1 1],[2 1],[3 1],[4 1]", bm, "all pages pinned");
+  for(i = 0; i < 5; i++)
+  {
+      sprintf(expected, "%s-%i", "Page", pages[i].pageNum);
+      ASSERT_EQUALS_STRING(expected, pages[i].data, "batched read page content");
+  }
+  ASSERT_EQUALS_INT(5, getNumReadIO(bm), "check number of read I/Os");
+
+  CHECK(unpinPages(bm, pages, 5));
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[2 0],[3 0],[4 0]", bm, "all pages unpinned");
+
+  // hits, misses and the same page twice in one batch
+  CHECK(pinPages(bm, pages, mixedPages, 4));
+  ASSERT_EQUALS_POOL("[7 1],[8 1],[2 0],[3 2],[4 0]", bm, "mixed batch pinned");
+  sprintf(expected, "%s-%i", "Page", 8);
+  ASSERT_EQUALS_STRING(expected, pages[2].data, "batched read page content");
+  ASSERT_EQUALS_INT(7, getNumReadIO(bm), "check number of read I/Os");
+  CHECK(unpinPages(bm, pages, 4));
+
+  // batch which doesn't fit pins nothing and evicts nothing
+  ASSERT_ERROR(pinPages(bm, pages, tooManyPages, 6), "more pages than frames");
+  ASSERT_EQUALS_POOL("[7 0],[8 0],[2 0],[3 0],[4 0]", bm, "failed batch keeps the resident pages");
+  ASSERT_EQUALS_INT(7, getNumReadIO(bm), "failed batch reads nothing");
+
+  // pinned frames can't take misses of a batch
+  CHECK(pinPage(bm, &pages[5], 2));
+  ASSERT_ERROR(pinPages(bm, pages, &tooManyPages[1], 5), "more misses than unpinned frames");
+  ASSERT_EQUALS_POOL("[7 0],[8 0],[2 1],[3 0],[4 0]", bm, "resident pages kept");
+  CHECK(pinPages(bm, pages, &tooManyPages[1], 4));
+  ASSERT_EQUALS_POOL("[13 1],[14 1],[2 1],[11 1],[12 1]", bm, "batch fits the unpinned frames");
+  CHECK(unpinPages(bm, pages, 4));
+  CHECK(unpinPage(bm, &pages[5]));
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(pages);
+  TEST_DONE();
+}
+
+// test filling caller owned arrays with the state of all frames
+void
+testPoolSnapshot (void)
+{
+  PageNumber pageNums[4];
+  bool dirtyFlags[4];
+  int fixCounts[4];
+  BM_PoolSnapshot snapshot;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing pool snapshot";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 10);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 4, RS_FIFO, NULL));
+
+  CHECK(pinPage(bm, h, 5));
+  CHECK(markDirty(bm, h));
+  CHECK(pinPage(bm, h, 6));
+
+  // arrays which are too small are not filled
+  initPoolSnapshot(&snapshot, pageNums, dirtyFlags, fixCounts, 3);
+  ASSERT_ERROR(getPoolSnapshot(bm, &snapshot), "snapshot smaller than pool");
+  ASSERT_EQUALS_INT(4, snapshot.numFrames, "snapshot reports pool size");
+
+  initPoolSnapshot(&snapshot, pageNums, dirtyFlags, fixCounts, 4);
+  CHECK(getPoolSnapshot(bm, &snapshot));
+  ASSERT_EQUALS_INT(5, pageNums[0], "page in first frame");
+  ASSERT_EQUALS_INT(6, pageNums[1], "page in second frame");
+  ASSERT_EQUALS_INT(NO_PAGE, pageNums[2], "third frame empty");
+  ASSERT_TRUE(dirtyFlags[0] && !dirtyFlags[1], "dirty flags");
+  ASSERT_EQUALS_INT(1, fixCounts[0], "fix count of first frame");
+  ASSERT_EQUALS_INT(0, fixCounts[3], "fix count of empty frame");
+  ASSERT_EQUALS_INT(getNumReadIO(bm), snapshot.numReadIO, "read I/Os in snapshot");
+
+  // arrays left NULL are skipped
+  fixCounts[0] = -5;
+  initPoolSnapshot(&snapshot, NULL, NULL, fixCounts, 4);
+  CHECK(getPoolSnapshot(bm, &snapshot));
+  ASSERT_EQUALS_INT(1, fixCounts[0], "only fix counts filled");
+  ASSERT_EQUALS_POOL("[5x1],[6 1],[-1 0],[-1 0]", bm, "pool content from snapshot");
+
+  h->pageNum = 5;
+  CHECK(unpinPage(bm, h));
+  h->pageNum = 6;
+  CHECK(unpinPage(bm, h));
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test counters and latency histograms of the pool metrics
+void
+testPoolMetrics (void)
+{
+  int i;
+  BM_PoolMetrics metrics;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *other = MAKE_PAGE_HANDLE();
+  char *json;
+  testName = "Testing pool metrics";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 10);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 2, RS_FIFO, NULL));
+
+  // 3 misses filling both frames and evicting dirty page 0, then a hit on page 2
+  for (i = 0; i < 3; i++)
+  {
+      CHECK(pinPage(bm, h, i));
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+  }
+  CHECK(pinPage(bm, h, 2));
+
+  // all frames pinned, so the next pin fails
+  CHECK(pinPage(bm, other, 1));
+  ASSERT_ERROR(pinPage(bm, other, 5), "all frames pinned");
+  other->pageNum = 1;
+  CHECK(unpinPage(bm, other));
+
+  // after flushing, page 1 is clean and is evicted without a write
+  CHECK(forcePage(bm, h));
+  CHECK(unpinPage(bm, h));
+  CHECK(forceFlushPool(bm));
+  CHECK(pinPage(bm, h, 6));
+
+  getPoolMetrics(bm, &metrics);
+  ASSERT_EQUALS_INT(2, (int) metrics.counters[METRIC_HITS], "hits");
+  ASSERT_EQUALS_INT(5, (int) metrics.counters[METRIC_MISSES], "misses (including the failed pin)");
+  ASSERT_EQUALS_INT(1, (int) metrics.counters[METRIC_DIRTY_EVICTIONS], "dirty evictions");
+  ASSERT_EQUALS_INT(1, (int) metrics.counters[METRIC_CLEAN_EVICTIONS], "clean evictions");
+  ASSERT_EQUALS_INT(1, (int) metrics.counters[METRIC_PIN_FAILURES], "pin failures");
+  ASSERT_EQUALS_INT(2, (int) metrics.counters[METRIC_FLUSHES], "flushes");
+  ASSERT_EQUALS_INT(getNumReadIO(bm), (int) metrics.counters[METRIC_READS], "reads match getNumReadIO");
+  ASSERT_EQUALS_INT(getNumWriteIO(bm), (int) metrics.counters[METRIC_WRITES], "writes match getNumWriteIO");
+
+  // every successful pin and write is in a histogram
+  ASSERT_EQUALS_INT(2, (int) metrics.latencies[LATENCY_PIN_HIT].count, "pin hit latencies");
+  ASSERT_EQUALS_INT(4, (int) metrics.latencies[LATENCY_PIN_MISS].count, "pin miss latencies");
+  ASSERT_EQUALS_INT(getNumWriteIO(bm), (int) metrics.latencies[LATENCY_WRITE_BLOCK].count, "write latencies");
+  ASSERT_TRUE(metrics.latencies[LATENCY_PIN_MISS].p50Nanos <= metrics.latencies[LATENCY_PIN_MISS].p99Nanos
+      && metrics.latencies[LATENCY_PIN_MISS].p99Nanos <= metrics.latencies[LATENCY_PIN_MISS].maxNanos, "percentiles are ordered");
+
+  printPoolMetrics(bm);
+  json = sprintPoolMetricsJSON(bm);
+  ASSERT_TRUE(strstr(json, "\"dirtyEvictions\":1") != NULL, "JSON dump contains counters");
+  ASSERT_TRUE(strstr(json, "\"pinMiss\":{\"count\":4") != NULL, "JSON dump contains latencies");
+  free(json);
+
+  CHECK(unpinPage(bm, h));
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  free(other);
+  TEST_DONE();
+}
+
+// test recording page accesses and reading them back from a trace file
+void
+testPageTrace (void)
+{
+  int i;
+  int numRecords;
+  TraceRecord *records;
+  BM_PoolOptions opts;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing page access trace";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 10);
+
+  initPoolOptions(&opts);
+  opts.traceRecords = 8;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LRU, NULL, &opts));
+
+  CHECK(pinPage(bm, h, 4));
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  h->pageNum = 9;
+  ASSERT_ERROR(unpinPage(bm, h), "failed calls are not traced");
+
+  CHECK(dumpPageTrace(bm, "testtrace.bin"));
+  CHECK(readPageTrace("testtrace.bin", &records, &numRecords));
+  ASSERT_EQUALS_INT(3, numRecords, "three accesses recorded");
+  ASSERT_EQUALS_INT(TRACE_PIN, records[0].op, "pin recorded first");
+  ASSERT_EQUALS_INT(TRACE_DIRTY, records[1].op, "then markDirty");
+  ASSERT_EQUALS_INT(TRACE_UNPIN, records[2].op, "then unpin");
+  ASSERT_EQUALS_INT(4, records[2].pageNum, "page number recorded");
+  ASSERT_TRUE(records[0].nanos <= records[2].nanos, "timestamps are ordered");
+  free(records);
+
+  // ring keeps only the newest 8 records
+  for (i = 0; i < 5; i++)
+  {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+  }
+  CHECK(dumpPageTrace(bm, "testtrace.bin"));
+  CHECK(readPageTrace("testtrace.bin", &records, &numRecords));
+  ASSERT_EQUALS_INT(8, numRecords, "ring is full");
+  ASSERT_EQUALS_INT(1, records[0].pageNum, "oldest records overwritten");
+  ASSERT_EQUALS_INT(TRACE_UNPIN, records[7].op, "newest record last");
+  ASSERT_EQUALS_INT(4, records[7].pageNum, "newest record last");
+  free(records);
+
+  ASSERT_ERROR(readPageTrace("testbuffer.bin", &records, &numRecords), "page file is not a trace");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+  CHECK(destroyPageFile("testtrace.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test estimating the miss ratio curve from sampled reuse distances
+void
+testMissRatioCurve (void)
+{
+  int i, round;
+  const int sizes[] = {4, 8, 16, 200};
+  double missRatios[4];
+  BM_PoolOptions opts;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing miss ratio curve estimation";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 100);
+
+  // without the option there is no estimate
+  CHECK(initBufferPool(bm, "testbuffer.bin", 4, RS_LRU, NULL));
+  ASSERT_ERROR(getMissRatioCurve(bm, sizes, missRatios, 4), "estimation not enabled");
+  CHECK(shutdownBufferPool(bm));
+
+  // budget holds all pages, so every page is sampled and distances are exact
+  initPoolOptions(&opts);
+  opts.mrcSampledPages = 64;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 4, RS_LRU, NULL, &opts));
+  for (round = 0; round < 3; round++)
+    for (i = 0; i < 8; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+
+  // looping over 8 pages misses always with fewer than 8 frames, only the first round misses with 8 or more
+  CHECK(getMissRatioCurve(bm, sizes, missRatios, 4));
+  ASSERT_EQUALS_INT(1000, (int) (missRatios[0] * 1000 + 0.5), "loop larger than pool");
+  ASSERT_EQUALS_INT(333, (int) (missRatios[1] * 1000 + 0.5), "loop fits in pool");
+  ASSERT_EQUALS_INT(333, (int) (missRatios[2] * 1000 + 0.5), "loop fits in larger pool");
+  CHECK(shutdownBufferPool(bm));
+
+  // budget of 8 pages for a loop over 100 pages. Sampling rate drops, distances are scaled up
+  opts.mrcSampledPages = 8;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 4, RS_LRU, NULL, &opts));
+  for (round = 0; round < 2; round++)
+    for (i = 0; i < 100; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+
+  CHECK(getMissRatioCurve(bm, sizes, missRatios, 4));
+  ASSERT_EQUALS_INT(1000, (int) (missRatios[0] * 1000 + 0.5), "sampled loop larger than pool");
+  ASSERT_TRUE(missRatios[3] < missRatios[0], "more frames turn sampled misses into hits");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test growing and shrinking a pool while pages are pinned
+void
+testResizePool (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *pinned = MAKE_PAGE_HANDLE();
+  char *expected = malloc(sizeof(char) * 512);
+  unsigned int version;
+  testName = "Testing pool resizing";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 20);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 4, RS_FIFO, NULL));
+
+  // page 1 stays pinned throughout
+  for (i = 0; i < 4; i++)
+  {
+      CHECK(pinPage(bm, (i == 1) ? pinned : h, i));
+      if (i == 2)
+        CHECK(markDirty(bm, h));
+      if (i != 1)
+        CHECK(unpinPage(bm, h));
+  }
+
+  // new frames are empty, existing pages stay where they are
+  CHECK(resizeBufferPool(bm, 6));
+  ASSERT_EQUALS_INT(6, bm->numPages, "pool grown");
+  ASSERT_EQUALS_POOL("[0 0],[1 1],[2x0],[3 0],[-1 0],[-1 0]", bm, "frames added");
+  CHECK(pinPage(bm, h, 4));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 5));
+  sprintf(expected, "%s-%i", "Page", 5);
+  ASSERT_EQUALS_STRING(expected, h->data, "page read into new frame");
+  CHECK(unpinPage(bm, h));
+
+  // frames are dropped in FIFO order, the dirty page is written first and the pinned page stays
+  CHECK(resizeBufferPool(bm, 2));
+  ASSERT_EQUALS_INT(1, getNumWriteIO(bm), "dirty page written when its frame was dropped");
+  ASSERT_EQUALS_POOL("[1 1],[5 0]", bm, "pool shrunk");
+  sprintf(expected, "%s-%i", "Page", 1);
+  ASSERT_EQUALS_STRING(expected, pinned->data, "pinned page data kept");
+
+  // pinned frames can't be dropped yet
+  CHECK(pinPage(bm, h, 5));
+  ASSERT_EQUALS_INT(RC_RESIZE_INCOMPLETE, resizeBufferPool(bm, 1), "all frames pinned");
+  ASSERT_EQUALS_INT(2, bm->numPages, "pool size unchanged");
+  CHECK(unpinPage(bm, h));
+  CHECK(unpinPage(bm, pinned));
+  CHECK(resizeBufferPool(bm, 1));
+  ASSERT_EQUALS_POOL("[5 0]", bm, "shrink finished once pages were unpinned");
+
+  // growing again reuses the page memory given back before
+  CHECK(resizeBufferPool(bm, 3));
+  CHECK(pinPage(bm, h, 7));
+  sprintf(expected, "%s-%i", "Page", 7);
+  ASSERT_EQUALS_STRING(expected, h->data, "page read into reused frame");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[5 0],[7 0],[-1 0]", bm, "pool grown again");
+
+  // resizes reuse the partition's tables, and optimistic reads still find resident pages afterwards
+  for (i = 0; i < 50; i++)
+    {
+      CHECK(resizeBufferPool(bm, 8));
+      CHECK(resizeBufferPool(bm, 3));
+    }
+  ASSERT_EQUALS_POOL("[5 0],[7 0],[-1 0]", bm, "pages kept through the resizes");
+  CHECK(pinPageOptimistic(bm, h, 7, &version));
+  ASSERT_TRUE(validatePage(bm, h, version), "optimistic read after the resizes");
+
+  ASSERT_ERROR(resizeBufferPool(bm, 0), "pool needs a frame");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  free(pinned);
+  TEST_DONE();
+}
+
+// test two page files sharing the frames of one pool
+void
+testMultiFilePool (void)
+{
+  int fileId;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *other = MAKE_PAGE_HANDLE();
+  BM_PageHandle built;
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing pool shared by several page files";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  CHECK(createPageFile("testbuffer2.bin"));
+  createDummyPages(bm, 5);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(registerPageFile(bm, "testbuffer2.bin", &fileId));
+  ASSERT_TRUE(fileId != MAIN_FILE_ID, "second file gets its own id");
+
+  // page 0 of each file gets its own frame
+  CHECK(pinPage(bm, h, 0));
+  CHECK(pinFilePage(bm, other, fileId, 0));
+  ASSERT_EQUALS_INT(fileId, other->fileId, "handle remembers the file");
+  ASSERT_EQUALS_POOL("[0 1],[0 1],[-1 0]", bm, "same page number of two files");
+  sprintf(other->data, "%s-%i", "Other", 0);
+  CHECK(markDirty(bm, other));
+  sprintf(expected, "%s-%i", "Page", 0);
+  ASSERT_EQUALS_STRING(expected, h->data, "main file page unchanged");
+
+  // flushing a file only writes its own pages
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  CHECK(unpinPage(bm, other));
+  CHECK(flushPageFile(bm, fileId));
+  ASSERT_EQUALS_POOL("[0x0],[0 0],[-1 0]", bm, "only the second file flushed");
+
+  // pinned pages keep a file registered
+  CHECK(pinFilePage(bm, other, fileId, 1));
+  ASSERT_EQUALS_INT(RC_IM_KEY_ALREADY_EXISTS, unregisterPageFile(bm, fileId), "page of file still pinned");
+  CHECK(unpinPage(bm, other));
+  CHECK(unregisterPageFile(bm, fileId));
+  ASSERT_EQUALS_POOL("[0x0],[-1 0],[-1 0]", bm, "frames of the file dropped");
+  ASSERT_EQUALS_INT(RC_FILE_HANDLE_NOT_INIT, pinFilePage(bm, other, fileId, 0), "unregistered file can't be pinned");
+  ASSERT_ERROR(unregisterPageFile(bm, MAIN_FILE_ID), "pool's own file stays registered");
+
+  // the written page is read back after registering the file again
+  CHECK(registerPageFile(bm, "testbuffer2.bin", &fileId));
+  CHECK(pinFilePage(bm, other, fileId, 0));
+  sprintf(expected, "%s-%i", "Other", 0);
+  ASSERT_EQUALS_STRING(expected, other->data, "page of second file written to its own file");
+  CHECK(unpinPage(bm, other));
+
+  // handles naming a file which isn't registered are rejected
+  CHECK(pinPage(bm, h, 2));
+  CHECK(pinPage(bm, h, 2));
+  memset(&built, 0, sizeof(BM_PageHandle));
+  built.pageNum = 2;
+  built.fileId = 4711;
+  ASSERT_EQUALS_INT(RC_FILE_HANDLE_NOT_INIT, markDirty(bm, &built), "file id out of range");
+  built.fileId = fileId + 1;
+  ASSERT_EQUALS_INT(RC_FILE_HANDLE_NOT_INIT, unpinPage(bm, &built), "file id not registered");
+  ASSERT_EQUALS_POOL("[0x0],[0 0],[2 2]", bm, "pages of rejected handles untouched");
+
+  // a zeroed handle filled in with just a page number is a page of the pool's own file
+  built.fileId = MAIN_FILE_ID;
+  CHECK(markDirty(bm, &built));
+  CHECK(unpinPage(bm, &built));
+  CHECK(unpinPage(bm, &built));
+  ASSERT_EQUALS_POOL("[0x0],[0 0],[2x0]", bm, "pages unpinned through handles without a file");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+  CHECK(destroyPageFile("testbuffer2.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  free(other);
+  TEST_DONE();
+}
+
+// test reloading the pages resident at shutdown when the pool is started again
+void
+testWarmRestart (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions opts;
+  unsigned int version;
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing warm restart from hot page file";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 10);
+  remove("testbuffer.hot");
+
+  initPoolOptions(&opts);
+  opts.warmStartFile = "testbuffer.hot";
+
+  // first start is cold, the resident pages are written at shutdown
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &opts));
+  ASSERT_EQUALS_POOL("[-1 0],[-1 0],[-1 0]", bm, "no hot page file yet");
+  CHECK(pinPage(bm, h, 4));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 2));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 7));
+  CHECK(unpinPage(bm, h));
+  CHECK(shutdownBufferPool(bm));
+
+  // pages come back newest first with their FIFO order
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &opts));
+  ASSERT_EQUALS_POOL("[7 0],[2 0],[4 0]", bm, "hot pages reloaded");
+  ASSERT_EQUALS_INT(3, getNumReadIO(bm), "hot pages read at start");
+  CHECK(pinPageOptimistic(bm, h, 2, &version));
+  sprintf(expected, "%s-%i", "Page", 2);
+  ASSERT_EQUALS_STRING(expected, h->data, "reloaded page content");
+  ASSERT_TRUE(validatePage(bm, h, version), "reloaded page is stable");
+  CHECK(pinPage(bm, h, 2));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(3, getNumReadIO(bm), "reloaded page is a hit");
+  CHECK(pinPage(bm, h, 9));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[7 0],[2 0],[9 0]", bm, "oldest page before the restart evicted first");
+  CHECK(shutdownBufferPool(bm));
+
+  // a smaller pool keeps the pages the strategy would keep longest
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 2, RS_FIFO, NULL, &opts));
+  ASSERT_EQUALS_POOL("[9 0],[7 0]", bm, "newest pages reloaded into smaller pool");
+  CHECK(saveHotPages(bm, "testbuffer.hot"));
+  ASSERT_EQUALS_INT(RC_BAD_HOT_PAGE_FILE, loadHotPages(bm, "testbuffer.bin"), "page file is not a hot page file");
+  CHECK(shutdownBufferPool(bm));
+
+  remove("testbuffer.hot");
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test a pool whose frame memory asks for huge pages and is locked (both fall back quietly where not available)
+void
+testHugePagePool (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions opts;
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing pool with huge pages and locked memory";
+
+  CHECK(createPageFile("testbuffer.bin"));
+
+  initPoolOptions(&opts);
+  opts.numPartitions = 2;
+  opts.hugePages = HUGE_PAGES_EXPLICIT;
+  opts.lockMemory = true;
+
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 4, RS_LRU, NULL, &opts));
+  for (i = 0; i < 8; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(h->data, "%s-%i", "Page", i);
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+    }
+
+  // page data added and dropped by resizing uses the same kind of memory
+  CHECK(resizeBufferPool(bm, 8));
+  CHECK(resizeBufferPool(bm, 2));
+  CHECK(shutdownBufferPool(bm));
+
+  opts.hugePages = HUGE_PAGES_TRANSPARENT;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &opts));
+  for (i = 0; i < 8; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "Page", i);
+      ASSERT_EQUALS_STRING(expected, h->data, "page written through huge page frames");
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// vector frame searches find the same frames as the scalar ones, also in the frames after the last full vector
+void
+testFrameSearch (void)
+{
+  int i, n, level, strat;
+  int pinCnts[67], keys[67], secondKeys[67];
+  int contents[2][8];
+  ReplacementStrategy strategies[] = {RS_FIFO, RS_LFU};
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing vector frame searches";
+
+  initFrameSearch();
+  SearchLevel best = getFrameSearchLevel();
+  srand(39);
+
+  for (n = 0; n <= 67; n++)
+    {
+      // few distinct keys for ties, some unset positions and some pinned frames
+      for (i = 0; i < n; i++)
+        {
+          pinCnts[i] = rand() % 3 == 0;
+          keys[i] = rand() % 5 == 0 ? INT_MAX : rand() % 8;
+          secondKeys[i] = rand() % 5 == 0 ? INT_MAX : rand() % 8;
+        }
+
+      setFrameSearchLevel(SEARCH_SCALAR);
+      int value = findValue(keys, n / 3, n, 3);
+      int minKey = findMinUnpinned(pinCnts, keys, n);
+      int minPair = findMinUnpinnedPair(pinCnts, keys, secondKeys, n);
+
+      for (level = SEARCH_AVX2; level <= best; level++)
+        {
+          setFrameSearchLevel(level);
+          ASSERT_EQUALS_INT(value, findValue(keys, n / 3, n, 3), "vector value search finds the first match");
+          ASSERT_EQUALS_INT(minKey, findMinUnpinned(pinCnts, keys, n), "vector min search finds the first unpinned minimum");
+          ASSERT_EQUALS_INT(minPair, findMinUnpinnedPair(pinCnts, keys, secondKeys, n), "vector pair search finds the first unpinned minimum");
+        }
+    }
+
+  // a pool evicts the same pages with every search
+  CHECK(createPageFile("testbuffer.bin"));
+  for (strat = 0; strat < 2; strat++)
+    {
+      for (level = 0; level < 2; level++)
+        {
+          setFrameSearchLevel(level == 0 ? SEARCH_SCALAR : best);
+          CHECK(initBufferPool(bm, "testbuffer.bin", 8, strategies[strat], NULL));
+          for (i = 0; i < 200; i++)
+            {
+              CHECK(pinPage(bm, h, (i * 7) % 13 + (i % 3) * (i % 5)));
+              CHECK(unpinPage(bm, h));
+            }
+          PageNumber *frameContents = getFrameContents(bm);
+          memcpy(contents[level], frameContents, sizeof(contents[level]));
+          free(frameContents);
+          CHECK(shutdownBufferPool(bm));
+        }
+
+      for (i = 0; i < 8; i++)
+        ASSERT_EQUALS_INT(contents[0][i], contents[1][i], "same frame contents with scalar and vector searches");
+    }
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  setFrameSearchLevel(best);
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// handles of hits point to the page's own frame, and misses read pages written by an eviction just before
+void
+testPageData (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *pinned = (BM_PageHandle *) malloc(sizeof(BM_PageHandle) * 3);
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing page data of hits and direct reads";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 5);
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+  for (i = 0; i < 3; i++)
+    CHECK(pinPage(bm, &pinned[i], i));
+
+  for (i = 2; i >= 0; i--)
+    {
+      CHECK(pinPage(bm, h, i));
+      ASSERT_TRUE(h->data == pinned[i].data, "hit returns the page's frame");
+      sprintf(expected, "%s-%i", "Page", i);
+      ASSERT_EQUALS_STRING(expected, h->data, "hit page content");
+      CHECK(unpinPage(bm, h));
+      CHECK(unpinPage(bm, &pinned[i]));
+    }
+  CHECK(shutdownBufferPool(bm));
+
+  // dirty page is written when page 4 takes its frame, then read back into the other frame
+  CHECK(initBufferPool(bm, "testbuffer.bin", 2, RS_FIFO, NULL));
+  CHECK(pinPage(bm, h, 3));
+  sprintf(h->data, "%s", "Changed-3");
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 0));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 4));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 3));
+  ASSERT_EQUALS_STRING("Changed-3", h->data, "page written on eviction is read back");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(4, getNumReadIO(bm), "every miss read once");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(pinned);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// pin of a thread waiting for a frame, page and result are filled in by the thread
+typedef struct WaitingPin {
+  BM_BufferPool *bm;
+  BM_PageHandle h;
+  PageNumber pageNum;
+  RC rc;
+} WaitingPin;
+
+static void *
+pinWaiting (void *arg)
+{
+  WaitingPin *pin = (WaitingPin *) arg;
+  pin->rc = pinPage(pin->bm, &pin->h, pin->pageNum);
+  return NULL;
+}
+
+// wait until n pins are waiting for a frame
+static void
+awaitPinWaits (BM_BufferPool *bm, uint64_t n)
+{
+  BM_PoolMetrics metrics;
+  do
+    {
+      usleep(1000);
+      getPoolMetrics(bm, &metrics);
+    }
+  while (metrics.counters[METRIC_PIN_WAITS] < n);
+}
+
+// other process of testPinWait: two threads wait for a frame whose dirty page can't be written, since writes of the
+// tier fail once the process may not write files. Both pins fail, the frame keeps its page and is pinned once writes
+// work again. Ends with exit status 0 if all of that happened
+static void
+runFailedHandOff (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *first = MAKE_PAGE_HANDLE();
+  BM_PageHandle *second = MAKE_PAGE_HANDLE();
+  BM_PoolOptions opts;
+  WaitingPin pins[2];
+  pthread_t threads[2];
+  struct rlimit limit;
+  int i;
+
+  initPoolOptions(&opts);
+  opts.pinWaitMillis = -1;
+  opts.tierFileName = "testtier.bin";
+  opts.tierPages = 2;
+  if (initBufferPoolWithOptions(bm, "testbuffer.bin", 2, RS_FIFO, NULL, &opts) != RC_OK
+      || pinPage(bm, first, 0) != RC_OK || markDirty(bm, first) != RC_OK || pinPage(bm, second, 1) != RC_OK)
+    _exit(1);
+
+  signal(SIGXFSZ, SIG_IGN);
+  getrlimit(RLIMIT_FSIZE, &limit);
+  limit.rlim_cur = 0;
+  setrlimit(RLIMIT_FSIZE, &limit);
+
+  memset(pins, 0, sizeof(pins));
+  for (i = 0; i < 2; i++)
+    {
+      pins[i].bm = bm;
+      pins[i].pageNum = 2 + i;
+      pins[i].rc = -1;
+      pthread_create(&threads[i], NULL, pinWaiting, &pins[i]);
+      awaitPinWaits(bm, i + 1);
+    }
+
+  // the second thread gets the frame after the first one failed, instead of waiting on
+  if (unpinPage(bm, first) != RC_OK)
+    _exit(1);
+  for (i = 0; i < 2; i++)
+    {
+      pthread_join(threads[i], NULL);
+      if (pins[i].rc != RC_WRITE_FAILED)
+        _exit(2);
+    }
+  if (getFixCounts(bm)[0] != 0 || !getDirtyFlags(bm)[0])
+    _exit(3);
+
+  limit.rlim_cur = limit.rlim_max;
+  setrlimit(RLIMIT_FSIZE, &limit);
+  if (pinPage(bm, first, 2) != RC_OK || unpinPage(bm, first) != RC_OK || unpinPage(bm, second) != RC_OK
+      || shutdownBufferPool(bm) != RC_OK)
+    _exit(4);
+
+  _exit(0);
+}
+
+// pins wait for a frame instead of failing, and freed frames go to the longest waiting thread
+void
+testPinWait (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *first = MAKE_PAGE_HANDLE();
+  BM_PageHandle *second = MAKE_PAGE_HANDLE();
+  BM_PoolOptions opts;
+  BM_PoolMetrics metrics;
+  WaitingPin pins[2];
+  pthread_t threads[2];
+  int status;
+  pid_t pid;
+  int i;
+  testName = "Testing pins waiting for a frame";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 4);
+
+  initPoolOptions(&opts);
+  opts.pinWaitMillis = 20;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 2, RS_FIFO, NULL, &opts));
+  CHECK(pinPage(bm, first, 0));
+  CHECK(pinPage(bm, second, 1));
+  RC rc = pinPage(bm, first, 2);
+  ASSERT_EQUALS_INT(RC_PIN_TIMEOUT, rc, "pin times out while all frames stay pinned");
+  getPoolMetrics(bm, &metrics);
+  ASSERT_EQUALS_INT(1, (int) metrics.counters[METRIC_PIN_WAITS], "timed out pin waited");
+  ASSERT_EQUALS_INT(1, (int) metrics.counters[METRIC_PIN_FAILURES], "timed out pin failed");
+  first->pageNum = 0;
+  CHECK(unpinPage(bm, first));
+  CHECK(unpinPage(bm, second));
+  CHECK(shutdownBufferPool(bm));
+
+  // two threads wait without limit, the first one to wait gets the first frame unpinned
+  opts.pinWaitMillis = -1;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 2, RS_FIFO, NULL, &opts));
+  CHECK(pinPage(bm, first, 0));
+  CHECK(pinPage(bm, second, 1));
+
+  for (i = 0; i < 2; i++)
+    {
+      pins[i].bm = bm;
+      pins[i].pageNum = 2 + i;
+      pins[i].rc = -1;
+      pthread_create(&threads[i], NULL, pinWaiting, &pins[i]);
+      awaitPinWaits(bm, i + 1);
+    }
+
+  CHECK(unpinPage(bm, first));
+  pthread_join(threads[0], NULL);
+  CHECK(pins[0].rc);
+  ASSERT_EQUALS_POOL("[2 1],[1 1]", bm, "longest waiting thread got the unpinned frame");
+  ASSERT_EQUALS_INT(-1, pins[1].rc, "second thread still waits");
+
+  CHECK(unpinPage(bm, second));
+  pthread_join(threads[1], NULL);
+  CHECK(pins[1].rc);
+  ASSERT_EQUALS_POOL("[2 1],[3 1]", bm, "second thread got the next unpinned frame");
+
+  for (i = 0; i < 2; i++)
+    CHECK(unpinPage(bm, &pins[i].h));
+  CHECK(shutdownBufferPool(bm));
+
+  // a handed frame whose dirty page can't be written goes on to the next waiting thread
+  fflush(stdout);
+  pid = fork();
+  if (pid == 0)
+    runFailedHandOff();
+  waitpid(pid, &status, 0);
+  ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0, "failed pins of the handed frame passed it on");
+  CHECK(destroyPageFile("testtier.bin"));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(first);
+  free(second);
+  TEST_DONE();
+}
+
+// threads missing on the same page at once read it only once, the others wait for that read
+void
+testConcurrentMisses (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PoolMetrics metrics;
+  WaitingPin pins[4];
+  pthread_t threads[4];
+  char *expected = malloc(sizeof(char) * 512);
+  int i, page;
+  testName = "Testing concurrent misses on the same page";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 8);
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 8, RS_LRU, NULL));
+
+  for (page = 0; page < 8; page++)
+    {
+      memset(pins, 0, sizeof(pins));
+      for (i = 0; i < 4; i++)
+        {
+          pins[i].bm = bm;
+          pins[i].pageNum = page;
+          pins[i].rc = -1;
+          pthread_create(&threads[i], NULL, pinWaiting, &pins[i]);
+        }
+
+      sprintf(expected, "%s-%i", "Page", page);
+      for (i = 0; i < 4; i++)
+        {
+          pthread_join(threads[i], NULL);
+          CHECK(pins[i].rc);
+          ASSERT_EQUALS_STRING(expected, pins[i].h.data, "every pin sees the page read by the first one");
+        }
+
+      for (i = 0; i < 4; i++)
+        CHECK(unpinPage(bm, &pins[i].h));
+    }
+
+  ASSERT_EQUALS_INT(8, getNumReadIO(bm), "each page read once");
+  getPoolMetrics(bm, &metrics);
+  ASSERT_EQUALS_INT(8, (int) metrics.counters[METRIC_MISSES], "only the first pin of a page misses");
+  ASSERT_EQUALS_INT(24, (int) metrics.counters[METRIC_HITS], "later pins hit, waiting for the read if needed");
+  ASSERT_TRUE(metrics.counters[METRIC_READ_WAITS] <= 24, "only hits wait for reads");
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[2 0],[3 0],[4 0],[5 0],[6 0],[7 0]", bm, "no frame wasted on a second copy");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  TEST_DONE();
+}
+
+// unpins never go below zero, pins are counted per client and limited, and leaked pins are reported
+void
+testPinTracking (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *pinned = (BM_PageHandle *) malloc(sizeof(BM_PageHandle) * 2);
+  PageNumber pageNums[] = {2, 3};
+  BM_PoolOptions opts;
+  WaitingPin other;
+  pthread_t thread;
+  int numPins;
+  RC rc;
+  testName = "Testing pin tracking and limits";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 6);
+
+  // untracked pool
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(pinPage(bm, h, 0));
+  CHECK(unpinPage(bm, h));
+  rc = unpinPage(bm, h);
+  ASSERT_EQUALS_INT(RC_PAGE_NOT_PINNED, rc, "unpin of an unpinned page fails");
+  ASSERT_EQUALS_POOL("[0 0],[-1 0],[-1 0]", bm, "fix count stays at zero");
+  rc = reportLeakedPins(bm, &numPins);
+  ASSERT_EQUALS_INT(RC_NOT_ENABLED, rc, "no report without tracking");
+  CHECK(shutdownBufferPool(bm));
+
+  // each client holds at most two pins
+  initPoolOptions(&opts);
+  opts.maxPinsPerClient = 2;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 5, RS_FIFO, NULL, &opts));
+  setPinClient(7);
+  CHECK(pinPage(bm, &pinned[0], 0));
+  CHECK(pinPage(bm, &pinned[1], 1));
+  rc = pinPage(bm, h, 2);
+  ASSERT_EQUALS_INT(RC_PIN_LIMIT, rc, "third pin of the client fails");
+  rc = pinPages(bm, pinned, pageNums, 2);
+  ASSERT_EQUALS_INT(RC_PIN_LIMIT, rc, "batch over the limit fails as a whole");
+  ASSERT_EQUALS_POOL("[0 1],[1 1],[-1 0],[-1 0],[-1 0]", bm, "pages over the limit are not pinned");
+
+  memset(&other, 0, sizeof(other));
+  other.bm = bm;
+  other.pageNum = 4;
+  pthread_create(&thread, NULL, pinWaiting, &other);
+  pthread_join(thread, NULL);
+  CHECK(other.rc);
+  ASSERT_EQUALS_POOL("[0 1],[1 1],[4 1],[-1 0],[-1 0]", bm, "other thread is a client of its own");
+
+  CHECK(reportLeakedPins(bm, &numPins));
+  ASSERT_EQUALS_INT(3, numPins, "all held pins reported");
+  rc = shutdownBufferPool(bm);
+  ASSERT_EQUALS_INT(RC_IM_KEY_ALREADY_EXISTS, rc, "no shutdown with pins held");
+
+  // a page may be unpinned by another client than the one which pinned it
+  CHECK(unpinPage(bm, &other.h));
+  CHECK(unpinPage(bm, &pinned[1]));
+  CHECK(pinPage(bm, h, 2));
+  CHECK(reportLeakedPins(bm, &numPins));
+  ASSERT_EQUALS_INT(2, numPins, "unpinned pins are no longer held");
+  CHECK(unpinPage(bm, h));
+  CHECK(unpinPage(bm, &pinned[0]));
+  CHECK(reportLeakedPins(bm, &numPins));
+  ASSERT_EQUALS_INT(0, numPins, "no pins left");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(pinned);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// pin pages for a tenant at a priority and unpin them again
+static void
+pinForTenant (BM_BufferPool *bm, const PageNumber *pageNums, int numPages, int tenant, BM_Priority priority)
+{
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PinContext ctx;
+  int i;
+
+  ctx.tenant = tenant;
+  ctx.priority = priority;
+
+  for (i = 0; i < numPages; i++)
+    {
+      CHECK(pinPageWithContext(bm, h, MAIN_FILE_ID, pageNums[i], &ctx));
+      CHECK(unpinPage(bm, h));
+    }
+
+  free(h);
+}
+
+// test priority classes, tenant quotas and reservations and the per tenant statistics
+void
+testTenantQuotas (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_TenantStats stats;
+  BM_PinContext ctx;
+  PageNumber hot[] = {0, 1};
+  PageNumber scan[] = {2, 3, 4, 5};
+  PageNumber own[] = {0, 1, 2};
+  RC rc;
+  testName = "Testing tenant quotas and priority classes";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 8);
+
+  // a low priority scan only evicts its own pages, never the high priority ones
+  CHECK(initBufferPool(bm, "testbuffer.bin", 4, RS_LRU, NULL));
+  pinForTenant(bm, hot, 2, 1, PRIORITY_HIGH);
+  pinForTenant(bm, scan, 4, 2, PRIORITY_LOW);
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[4 0],[5 0]", bm, "scan keeps the high priority pages");
+
+  // a hit by a higher class keeps the page like a high priority page
+  ctx.tenant = 2;
+  ctx.priority = PRIORITY_HIGH;
+  CHECK(pinPageWithContext(bm, h, MAIN_FILE_ID, 4, &ctx));
+  CHECK(unpinPage(bm, h));
+  pinForTenant(bm, &scan[0], 1, 2, PRIORITY_LOW);
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[4 0],[2 0]", bm, "promoted page stays");
+
+  CHECK(getTenantStats(bm, 2, &stats));
+  ASSERT_EQUALS_INT(1, (int) stats.hits, "hits of tenant 2");
+  ASSERT_EQUALS_INT(5, (int) stats.misses, "misses of tenant 2");
+  ASSERT_EQUALS_INT(2, stats.numFrames, "frames of tenant 2");
+
+  ctx.tenant = MAX_TENANTS;
+  rc = pinPageWithContext(bm, h, MAIN_FILE_ID, 0, &ctx);
+  ASSERT_EQUALS_INT(RC_BAD_TENANT, rc, "unknown tenant is refused");
+  CHECK(shutdownBufferPool(bm));
+
+  // a tenant at its quota replaces its own pages and leaves empty frames to others
+  CHECK(initBufferPool(bm, "testbuffer.bin", 4, RS_FIFO, NULL));
+  CHECK(setTenantQuota(bm, 1, 0, 2));
+  pinForTenant(bm, own, 3, 1, PRIORITY_NORMAL);
+  ASSERT_EQUALS_POOL("[2 0],[1 0],[-1 0],[-1 0]", bm, "quota keeps tenant 1 at two frames");
+  CHECK(pinPage(bm, h, 3));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[2 0],[1 0],[3 0],[-1 0]", bm, "default tenant takes an empty frame");
+
+  pinForTenant(bm, &own[1], 1, 1, PRIORITY_NORMAL);
+  CHECK(getTenantStats(bm, 1, &stats));
+  ASSERT_EQUALS_INT(1, (int) stats.hits, "hits of tenant 1");
+  ASSERT_EQUALS_INT(3, (int) stats.misses, "misses of tenant 1");
+  ASSERT_EQUALS_INT(2, stats.numFrames, "frames of tenant 1");
+  CHECK(getTenantStats(bm, DEFAULT_TENANT, &stats));
+  ASSERT_EQUALS_INT(1, (int) stats.misses, "pins without a context count for the default tenant");
+  CHECK(shutdownBufferPool(bm));
+
+  // reserved frames are not evicted by other tenants
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(setTenantQuota(bm, 1, 2, 0));
+  pinForTenant(bm, hot, 2, 1, PRIORITY_LOW);
+  CHECK(pinPage(bm, h, 2));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 3));
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[3 1]", bm, "default tenant evicts its own page");
+  rc = pinPage(bm, h, 4);
+  ASSERT_EQUALS_INT(RC_TENANT_QUOTA, rc, "reserved frames can't be evicted");
+  CHECK(unpinPage(bm, h));
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test DONTNEED, KEEP and SEQUENTIAL hints on pin and unpin
+void
+testPageHints (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *pinned = (BM_PageHandle *) malloc(sizeof(BM_PageHandle) * 3);
+  BM_PoolOptions opts;
+  BM_PoolMetrics metrics;
+  int i;
+  testName = "Testing page hints";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 20);
+
+  // a scan pinning with DONTNEED replaces its own pages, the last one first
+  CHECK(initBufferPool(bm, "testbuffer.bin", 4, RS_LRU, NULL));
+  for (i = 0; i < 2; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  for (i = 2; i < 8; i++)
+    {
+      CHECK(pinPageWithHint(bm, h, i, HINT_DONTNEED));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[2 0],[7 0]", bm, "scan keeps the other pages");
+  CHECK(shutdownBufferPool(bm));
+
+  // a page pinned with KEEP stays while others are replaced
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(pinPageWithHint(bm, h, 0, HINT_KEEP));
+  CHECK(unpinPage(bm, h));
+  for (i = 1; i < 5; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[0 0],[3 0],[4 0]", bm, "kept page is not replaced");
+  CHECK(shutdownBufferPool(bm));
+
+  // hints given on unpin
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+  for (i = 0; i < 3; i++)
+    CHECK(pinPage(bm, &pinned[i], i));
+  CHECK(unpinPage(bm, &pinned[0]));
+  CHECK(unpinPageWithHint(bm, &pinned[1], HINT_KEEP));
+  CHECK(unpinPageWithHint(bm, &pinned[2], HINT_DONTNEED));
+  CHECK(pinPage(bm, h, 3));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[3 0]", bm, "DONTNEED page replaced first");
+  CHECK(pinPage(bm, h, 4));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[4 0],[1 0],[3 0]", bm, "KEEP page stays");
+  CHECK(shutdownBufferPool(bm));
+
+  // SEQUENTIAL reads the following pages ahead in one batch
+  initPoolOptions(&opts);
+  opts.readAheadPages = 3;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 12, RS_LRU, NULL, &opts));
+  CHECK(pinPageWithHint(bm, h, 0, HINT_SEQUENTIAL));
+  ASSERT_EQUALS_POOL("[0 1],[1 0],[2 0],[3 0],[-1 0],[-1 0],[-1 0],[-1 0],[-1 0],[-1 0],[-1 0],[-1 0]", bm,
+      "three pages read ahead");
+  CHECK(unpinPageWithHint(bm, h, HINT_SEQUENTIAL));
+  CHECK(pinPageWithHint(bm, h, 1, HINT_SEQUENTIAL));
+  ASSERT_EQUALS_INT(4, getNumReadIO(bm), "no read-ahead while the next page is in the pool");
+  CHECK(unpinPageWithHint(bm, h, HINT_SEQUENTIAL));
+  CHECK(pinPageWithHint(bm, h, 18, HINT_SEQUENTIAL));
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "no read-ahead past the end of the file");
+  CHECK(unpinPage(bm, h));
+  CHECK(shutdownBufferPool(bm));
+
+  // read-ahead without an unpinned frame for each page is skipped, not failed
+  opts.readAheadPages = 1;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 4, RS_LRU, NULL, &opts));
+  for (i = 0; i < 3; i++)
+    CHECK(pinPage(bm, &pinned[i], i));
+  CHECK(pinPageWithHint(bm, h, 5, HINT_SEQUENTIAL));
+  ASSERT_EQUALS_POOL("[0 1],[1 1],[2 1],[5 1]", bm, "no frame left for read-ahead");
+  getPoolMetrics(bm, &metrics);
+  ASSERT_EQUALS_INT(0, (int) metrics.counters[METRIC_PIN_FAILURES], "skipped read-ahead is no pin failure");
+  CHECK(unpinPage(bm, h));
+  for (i = 0; i < 3; i++)
+    CHECK(unpinPage(bm, &pinned[i]));
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(pinned);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// other process of testSharedPool: attaches to the pool, changes page 2 and ends while still holding its pins
+static void
+runSharedProcess (const char *shmName)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions opts;
+
+  initPoolOptions(&opts);
+  opts.sharedName = shmName;
+  if (initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LRU, NULL, &opts) != RC_OK
+      || pinPage(bm, h, 1) != RC_OK || pinPage(bm, h, 2) != RC_OK)
+    _exit(1);
+
+  sprintf(h->data, "%s-%i", "Shared", 2);
+  if (markDirty(bm, h) != RC_OK)
+    _exit(1);
+
+  fflush(stdout);
+  _exit(0);
+}
+
+// test a pool in shared memory used by two processes, one of which ends without unpinning its pages
+void
+testSharedPool (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *h2 = MAKE_PAGE_HANDLE();
+  BM_PoolOptions opts;
+  char shmName[64];
+  int status;
+  int readIO;
+  pid_t pid;
+  RC rc;
+  testName = "Testing pool in shared memory";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 6);
+
+  sprintf(shmName, "/test_assign2_%d", (int) getpid());
+  initPoolOptions(&opts);
+  opts.sharedName = shmName;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LRU, NULL, &opts));
+  CHECK(pinPage(bm, h, 0));
+  CHECK(unpinPage(bm, h));
+
+  fflush(stdout);
+  pid = fork();
+  if (pid == 0)
+    runSharedProcess(shmName);
+  waitpid(pid, &status, 0);
+  ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0, "other process attached and pinned pages");
+  ASSERT_EQUALS_POOL("[0 0],[1 1],[2x1]", bm, "frames hold the pages of both processes");
+
+  // a page the other process read is a hit and shows its change
+  CHECK(pinPage(bm, h, 2));
+  ASSERT_EQUALS_STRING("Shared-2", h->data, "change of the other process is seen");
+  readIO = getNumReadIO(bm);
+  ASSERT_EQUALS_INT(3, readIO, "each page read once for both processes");
+  CHECK(unpinPage(bm, h));
+  h2->pageNum = 1;
+  h2->frameNum = -1;
+  rc = unpinPage(bm, h2);
+  ASSERT_EQUALS_INT(RC_PAGE_NOT_PINNED, rc, "pins of another process can't be unpinned");
+
+  // pins of the ended process are given back once all frames are pinned
+  CHECK(pinPage(bm, h, 3));
+  CHECK(pinPage(bm, h2, 4));
+  ASSERT_EQUALS_POOL("[3 1],[4 1],[2x0]", bm, "pins of the ended process released");
+  CHECK(unpinPage(bm, h));
+  CHECK(unpinPage(bm, h2));
+
+  // the last process writes the dirty pages and removes the pool
+  CHECK(shutdownBufferPool(bm));
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LRU, NULL, &opts));
+  ASSERT_EQUALS_POOL("[-1 0],[-1 0],[-1 0]", bm, "pool created again");
+  CHECK(pinPage(bm, h, 2));
+  ASSERT_EQUALS_STRING("Shared-2", h->data, "change written at the last detach");
+  CHECK(unpinPage(bm, h));
+  rc = resizeBufferPool(bm, 4);
+  ASSERT_EQUALS_INT(RC_NOT_ENABLED, rc, "shared pools can't be resized");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  free(h2);
+  TEST_DONE();
+}
+
+// test update pins working on a copy of the page while readers keep the page as it was
+void
+testSnapshotReads (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *reader = MAKE_PAGE_HANDLE();
+  BM_PageHandle *later = MAKE_PAGE_HANDLE();
+  BM_PageHandle *writer = MAKE_PAGE_HANDLE();
+  BM_PageHandle *writer2 = MAKE_PAGE_HANDLE();
+  testName = "Testing snapshot reads";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 4);
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(pinPage(bm, reader, 0));
+
+  // the writer changes a copy, readers pinned before and during the change see the page as it was
+  CHECK(pinPageForUpdate(bm, writer, 0));
+  ASSERT_TRUE(writer->data != reader->data, "update pin gets a copy of the page");
+  ASSERT_EQUALS_STRING("Page-0", writer->data, "copy holds the page");
+  sprintf(writer->data, "%s-%i", "Changed", 0);
+  CHECK(markDirty(bm, writer));
+  CHECK(pinPage(bm, later, 0));
+  ASSERT_EQUALS_STRING("Page-0", reader->data, "reader doesn't see the change in progress");
+  ASSERT_EQUALS_STRING("Page-0", later->data, "pin during the change reads the old page");
+  ASSERT_EQUALS_POOL("[0 3],[-1 0],[-1 0]", bm, "copy isn't published yet");
+
+  // a second writer shares the copy, which is published when the last writer unpins
+  CHECK(pinPageForUpdate(bm, writer2, 0));
+  ASSERT_TRUE(writer2->data == writer->data, "writers share the copy");
+  CHECK(unpinPage(bm, writer));
+  ASSERT_EQUALS_POOL("[0 3],[-1 0],[-1 0]", bm, "copy kept while another writer has it");
+  CHECK(unpinPage(bm, writer2));
+  ASSERT_EQUALS_POOL("[0x2],[-1 0],[-1 0]", bm, "copy published when the last writer unpins");
+  ASSERT_EQUALS_STRING("Page-0", reader->data, "reader keeps the old page until it unpins");
+
+  CHECK(pinPage(bm, writer, 0));
+  ASSERT_EQUALS_STRING("Changed-0", writer->data, "new pin sees the change");
+  CHECK(unpinPage(bm, writer));
+  CHECK(unpinPage(bm, reader));
+  CHECK(unpinPage(bm, later));
+  ASSERT_EQUALS_POOL("[0x0],[-1 0],[-1 0]", bm, "old page released with its last reader");
+
+  // a copy which isn't marked dirty is dropped
+  CHECK(pinPageForUpdate(bm, writer, 0));
+  sprintf(writer->data, "%s-%i", "Dropped", 0);
+  CHECK(unpinPage(bm, writer));
+  CHECK(pinPage(bm, reader, 0));
+  ASSERT_EQUALS_STRING("Changed-0", reader->data, "clean copy isn't published");
+  CHECK(unpinPage(bm, reader));
+  CHECK(shutdownBufferPool(bm));
+
+  // the published page is written to the page file
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(pinPage(bm, reader, 0));
+  ASSERT_EQUALS_STRING("Changed-0", reader->data, "published change written to disk");
+  CHECK(unpinPage(bm, reader));
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(reader);
+  free(later);
+  free(writer);
+  free(writer2);
+  TEST_DONE();
+}
+
+// read a page of the page file without a tier, through a handle of its own
+static void
+readPlainPage (int pageNum, char *page)
+{
+  SM_FileHandle fh;
+
+  CHECK(openPageFile("testbuffer.bin", &fh));
+  CHECK(readBlock(pageNum, &fh, page));
+  CHECK(closePageFile(&fh));
+}
+
+// other process of testPageTier: a page is only in a write-back tier when the process stops being allowed to write
+// past the tier file's size, so shutdown can't write it to the page file. Ends with the result of the shutdown
+static void
+runFailedTierFlush (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions opts;
+  struct rlimit limit;
+
+  initPoolOptions(&opts);
+  opts.tierFileName = "testtier.bin";
+  opts.tierPages = 2;
+  opts.tierWriteBack = true;
+  if (initBufferPoolWithOptions(bm, "testbuffer.bin", 2, RS_FIFO, NULL, &opts) != RC_OK
+      || pinPage(bm, h, 3) != RC_OK)
+    _exit(1);
+
+  sprintf(h->data, "%s-%i", "Lost", 3);
+  if (markDirty(bm, h) != RC_OK || unpinPage(bm, h) != RC_OK || forceFlushPool(bm) != RC_OK)
+    _exit(1);
+
+  signal(SIGXFSZ, SIG_IGN);
+  getrlimit(RLIMIT_FSIZE, &limit);
+  limit.rlim_cur = 2 * PAGE_SIZE;
+  setrlimit(RLIMIT_FSIZE, &limit);
+
+  _exit(shutdownBufferPool(bm));
+}
+
+// test a local tier in front of the page file, on its own and below a buffer pool
+void
+testPageTier (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions opts;
+  SM_FileHandle fh;
+  char page[PAGE_SIZE];
+  char page2[PAGE_SIZE];
+  char *pages[] = {page, page2};
+  int pageNums[] = {1, 2};
+  int hits;
+  int misses;
+  int status;
+  pid_t pid;
+  int i;
+  RC rc;
+  testName = "Testing tier in front of the page file";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 8);
+
+  // reads are served by the tier once they were read from the page file
+  CHECK(openPageFile("testbuffer.bin", &fh));
+  CHECK(attachPageTier(&fh, "testtier.bin", 4, TIER_WRITE_BACK));
+  rc = attachPageTier(&fh, "testtier.bin", 4, TIER_WRITE_BACK);
+  ASSERT_EQUALS_INT(RC_TIER_FAILED, rc, "file has one tier at most");
+  CHECK(readBlock(0, &fh, page));
+  CHECK(readBlock(1, &fh, page));
+  CHECK(readBlock(0, &fh, page));
+  ASSERT_EQUALS_STRING("Page-0", page, "page read from the tier");
+  CHECK(readBlocks(pageNums, 2, &fh, pages));
+  ASSERT_EQUALS_STRING("Page-1", page, "batched read hit in the tier");
+  ASSERT_EQUALS_STRING("Page-2", page2, "batched read miss in the page file");
+  CHECK(getPageTierStats(&fh, &hits, &misses));
+  ASSERT_EQUALS_INT(2, hits, "reads the tier had");
+  ASSERT_EQUALS_INT(3, misses, "reads which went to the page file");
+
+  // write-back keeps writes in the tier until the page is evicted or the file closed
+  sprintf(page, "%s-%i", "Tier", 1);
+  CHECK(writeBlock(1, &fh, page));
+  readPlainPage(1, page2);
+  ASSERT_EQUALS_STRING("Page-1", page2, "write stays in the tier");
+  CHECK(readBlock(1, &fh, page2));
+  ASSERT_EQUALS_STRING("Tier-1", page2, "tier has the written page");
+  for (i = 3; i < 8; i++)
+    CHECK(readBlock(i, &fh, page));
+  readPlainPage(1, page2);
+  ASSERT_EQUALS_STRING("Tier-1", page2, "evicted page written to the page file");
+  sprintf(page, "%s-%i", "Tier", 7);
+  CHECK(writeBlock(7, &fh, page));
+  CHECK(closePageFile(&fh));
+  readPlainPage(7, page2);
+  ASSERT_EQUALS_STRING("Tier-7", page2, "closing writes the tier's pages");
+
+  // a pool with a write-through tier writes the page file as well
+  initPoolOptions(&opts);
+  opts.tierFileName = "testtier.bin";
+  opts.tierPages = 8;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 2, RS_FIFO, NULL, &opts));
+  CHECK(pinPage(bm, h, 2));
+  sprintf(h->data, "%s-%i", "Through", 2);
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  CHECK(forceFlushPool(bm));
+  readPlainPage(2, page2);
+  ASSERT_EQUALS_STRING("Through-2", page2, "write-through reaches the page file");
+  for (i = 3; i < 6; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(pinPage(bm, h, 2));
+  ASSERT_EQUALS_STRING("Through-2", h->data, "evicted page read back from the tier");
+  CHECK(unpinPage(bm, h));
+  CHECK(shutdownBufferPool(bm));
+
+  // a pool with a write-back tier writes the page file when it shuts down
+  opts.tierWriteBack = true;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 2, RS_FIFO, NULL, &opts));
+  CHECK(pinPage(bm, h, 3));
+  sprintf(h->data, "%s-%i", "Back", 3);
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  CHECK(forceFlushPool(bm));
+  readPlainPage(3, page2);
+  ASSERT_EQUALS_STRING("Page-3", page2, "flushed page only in the tier");
+  CHECK(shutdownBufferPool(bm));
+  readPlainPage(3, page2);
+  ASSERT_EQUALS_STRING("Back-3", page2, "tier written at shutdown");
+
+  // shutdown reports tier pages it couldn't write to the page file
+  fflush(stdout);
+  pid = fork();
+  if (pid == 0)
+    runFailedTierFlush();
+  waitpid(pid, &status, 0);
+  ASSERT_TRUE(WIFEXITED(status), "other process shut its pool down");
+  ASSERT_EQUALS_INT(RC_TIER_FAILED, WEXITSTATUS(status), "failed write of the tier's pages reported");
+  readPlainPage(3, page2);
+  ASSERT_EQUALS_STRING("Back-3", page2, "page only in the tier not written");
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+  CHECK(destroyPageFile("testtier.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
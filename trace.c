@@ -0,0 +1,141 @@
+/*
+trace.c
+Author: Pradyumna Deshpande
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include "trace.h"
+#include "metrics.h"
+
+// Trace files start with this tag followed by the number of records
+#define TRACE_FILE_TAG "BMTRACE1"
+#define TRACE_TAG_SIZE 8
+
+struct PageTrace {
+    TraceRecord *records;
+    uint64_t mask;
+    uint64_t head;  // Number of records written so far. The ring holds the last (mask + 1) of them
+};
+
+static int nextThread = 0;
+static __thread int traceThread = -1;
+
+// Function to create a ring buffer for at least capacity records (rounded up to a power of two)
+PageTrace *createPageTrace(int capacity) {
+    uint64_t size = 1;
+    while(size < (uint64_t) capacity) {
+        size *= 2;
+    }
+
+    PageTrace *trace = (PageTrace*)malloc(sizeof(PageTrace));
+    trace->records = (TraceRecord*)calloc(size, sizeof(TraceRecord));
+    if(trace->records == NULL) {
+        free(trace);
+        return NULL;
+    }
+
+    trace->mask = size - 1;
+    trace->head = 0;
+
+    return trace;
+}
+
+void destroyPageTrace(PageTrace *trace) {
+    if(trace == NULL) {
+        return;
+    }
+
+    free(trace->records);
+    free(trace);
+}
+
+// Function to record one page access. Each call claims its own slot, so recording threads never wait for each other.
+// When the ring is full, the oldest record is overwritten
+void tracePageAccess(PageTrace *trace, TraceOp op, int fileId, PageNumber pageNum) {
+    if(trace == NULL) {
+        return;
+    }
+
+    if(traceThread == -1) {
+        traceThread = __atomic_fetch_add(&nextThread, 1, __ATOMIC_RELAXED);
+    }
+
+    uint64_t pos = __atomic_fetch_add(&trace->head, 1, __ATOMIC_RELAXED);
+    TraceRecord *record = &trace->records[pos & trace->mask];
+
+    record->nanos = metricsNow();
+    record->pageNum = pageNum;
+    record->fileId = (uint16_t) fileId;
+    record->thread = (uint8_t) traceThread;
+    record->op = (uint8_t) op;
+}
+
+// Function to write the records in the ring to a trace file, oldest first. Records still being written by other
+// threads may be incomplete, so the pool should be idle while it is dumped
+RC writePageTrace(PageTrace *trace, const char *fileName) {
+    if(trace == NULL) {
+        printf("Trace: Tracing is not enabled for this pool.\n");
+        return RC_NOT_ENABLED;
+    }
+
+    FILE *out = fopen(fileName, "wb");
+    if(out == NULL) {
+        printf("Trace: Could not create trace file %s.\n", fileName);
+        return RC_FILE_NOT_FOUND;
+    }
+
+    uint64_t head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+    uint64_t count = head < trace->mask + 1 ? head : trace->mask + 1;
+    bool success = fwrite(TRACE_FILE_TAG, 1, TRACE_TAG_SIZE, out) == TRACE_TAG_SIZE
+            && fwrite(&count, sizeof(uint64_t), 1, out) == 1;
+
+    for(uint64_t pos = head - count; success && pos < head; pos++) {
+        success = fwrite(&trace->records[pos & trace->mask], sizeof(TraceRecord), 1, out) == 1;
+    }
+
+    fclose(out);
+
+    if(!success) {
+        printf("Trace: Could not write trace file %s.\n", fileName);
+        return RC_WRITE_FAILED;
+    }
+
+    printf("Trace: %llu records written to %s.\n", (unsigned long long) count, fileName);
+    return RC_OK;
+}
+
+// Function to load all records of a trace file into an array allocated for the caller
+RC readPageTrace(const char *fileName, TraceRecord **records, int *numRecords) {
+    FILE *in = fopen(fileName, "rb");
+    if(in == NULL) {
+        printf("Trace: Could not open trace file %s.\n", fileName);
+        return RC_FILE_NOT_FOUND;
+    }
+
+    char tag[TRACE_TAG_SIZE];
+    uint64_t count;
+
+    if(fread(tag, 1, TRACE_TAG_SIZE, in) != TRACE_TAG_SIZE || memcmp(tag, TRACE_FILE_TAG, TRACE_TAG_SIZE) != 0
+            || fread(&count, sizeof(uint64_t), 1, in) != 1 || count > INT32_MAX) {
+        fclose(in);
+        printf("Trace: %s is not a trace file.\n", fileName);
+        return RC_BAD_TRACE_FILE;
+    }
+
+    *records = (TraceRecord*)malloc(sizeof(TraceRecord) * (count > 0 ? count : 1));
+    *numRecords = (int) fread(*records, sizeof(TraceRecord), count, in);
+
+    fclose(in);
+
+    if(*numRecords != (int) count) {
+        free(*records);
+        *records = NULL;
+        printf("Trace: %s is truncated.\n", fileName);
+        return RC_BAD_TRACE_FILE;
+    }
+
+    return RC_OK;
+}
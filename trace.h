@@ -0,0 +1,44 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#include "dberror.h"
+#include "buffer_mgr.h"
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+// Page accesses recorded by the tracer
+typedef enum TraceOp {
+	TRACE_PIN = 0,
+	TRACE_UNPIN = 1,
+	TRACE_DIRTY = 2
+} TraceOp;
+
+// One recorded access (16 bytes). Threads are numbered (modulo 256) in the order they first used a tracer
+typedef struct TraceRecord {
+	uint64_t nanos;
+	PageNumber pageNum;
+	uint16_t fileId;
+	uint8_t thread;
+	uint8_t op;
+} TraceRecord;
+
+// Ring buffer keeping the most recent page accesses of a pool
+typedef struct PageTrace PageTrace;
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+extern PageTrace *createPageTrace (int capacity);
+extern void destroyPageTrace (PageTrace *trace);
+
+/* recording (safe to call from any thread, no latch needed) */
+extern void tracePageAccess (PageTrace *trace, TraceOp op, int fileId, PageNumber pageNum);
+
+/* trace files, oldest record first */
+extern RC writePageTrace (PageTrace *trace, const char *fileName);
+extern RC readPageTrace (const char *fileName, TraceRecord **records, int *numRecords);
+
+#endif
@@ -0,0 +1,211 @@
+/*
+trace_replay.c
+Author: Pradyumna Deshpande
+*/
+
+// Replays a page trace written by dumpPageTrace() through every replacement strategy at a range of pool sizes and
+// prints the miss ratio of each run as CSV, i.e. one miss ratio curve per strategy.
+// Usage: trace_replay <trace file> [pool sizes...]
+// Without pool sizes, powers of two up to the number of distinct pages in the trace are used.
+// Pages of all files in the trace are replayed as pages of a single file, so the pool is shared like in the traced run.
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<unistd.h>
+
+#include "storage_mgr.h"
+#include "buffer_mgr.h"
+#include "trace.h"
+
+#define REPLAY_PAGE_FILE "trace_replay.bin"
+#define NUM_STRATEGIES 5
+
+static const ReplacementStrategy strategies[NUM_STRATEGIES] = {RS_FIFO, RS_LRU, RS_CLOCK, RS_LFU, RS_LRU_K};
+static const char *strategyNames[NUM_STRATEGIES] = {"FIFO", "LRU", "CLOCK", "LFU", "LRU-K"};
+
+// Struct for the result of one replay
+typedef struct ReplayResult {
+    uint64_t pins;
+    uint64_t misses;
+    uint64_t writes;
+    int failedPins;
+} ReplayResult;
+
+static int compareKeys(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static uint64_t pageKey(TraceRecord *record) {
+    return ((uint64_t) record->fileId << 32) | (uint32_t) record->pageNum;
+}
+
+// Function to number the distinct (file, page) pairs of a trace densely from 0 in their sort order and replace the
+// page numbers of the records with them. Returns the number of distinct pages
+static int remapPages(TraceRecord *records, int numRecords) {
+    uint64_t *keys = (uint64_t*)malloc(sizeof(uint64_t) * (numRecords > 0 ? numRecords : 1));
+    int numKeys = 0;
+
+    for(int i = 0; i < numRecords; i++) {
+        if(records[i].pageNum >= 0) {
+            keys[numKeys++] = pageKey(&records[i]);
+        }
+    }
+
+    qsort(keys, numKeys, sizeof(uint64_t), compareKeys);
+
+    int numDistinct = 0;
+    for(int i = 0; i < numKeys; i++) {
+        if(numDistinct == 0 || keys[numDistinct - 1] != keys[i]) {
+            keys[numDistinct++] = keys[i];
+        }
+    }
+
+    for(int i = 0; i < numRecords; i++) {
+        if(records[i].pageNum < 0) {
+            continue;
+        }
+
+        uint64_t key = pageKey(&records[i]);
+        uint64_t *found = (uint64_t*)bsearch(&key, keys, numDistinct, sizeof(uint64_t), compareKeys);
+
+        records[i].pageNum = (PageNumber) (found - keys);
+        records[i].fileId = MAIN_FILE_ID;
+    }
+
+    free(keys);
+    return numDistinct;
+}
+
+// Function to replay a trace on a fresh pool. Unpins and markDirty calls of pins which failed in the smaller pool are skipped
+static RC replayTrace(TraceRecord *records, int numRecords, int maxPage, ReplacementStrategy strategy, int numFrames, ReplayResult *result) {
+    BM_BufferPool bm;
+    BM_PageHandle h;
+    BM_PoolMetrics metrics;
+    int *pinCnts = (int*)calloc(maxPage + 1, sizeof(int));
+
+    RC rc = initBufferPool(&bm, REPLAY_PAGE_FILE, numFrames, strategy, NULL);
+    if(rc != RC_OK) {
+        free(pinCnts);
+        return rc;
+    }
+
+    result->failedPins = 0;
+
+    for(int i = 0; i < numRecords; i++) {
+        PageNumber pageNum = records[i].pageNum;
+        if(pageNum < 0 || pageNum > maxPage) {
+            continue;
+        }
+
+        h.pageNum = pageNum;
+
+        if(records[i].op == TRACE_PIN) {
+            if(pinPage(&bm, &h, pageNum) == RC_OK) {
+                pinCnts[pageNum]++;
+            } else {
+                result->failedPins++;
+            }
+        } else if(records[i].op == TRACE_UNPIN && pinCnts[pageNum] > 0) {
+            unpinPage(&bm, &h);
+            pinCnts[pageNum]--;
+        } else if(records[i].op == TRACE_DIRTY && pinCnts[pageNum] > 0) {
+            markDirty(&bm, &h);
+        }
+    }
+
+    // Pages still pinned at the end of the trace are released so the pool can shut down
+    for(PageNumber pageNum = 0; pageNum <= maxPage; pageNum++) {
+        h.pageNum = pageNum;
+        while(pinCnts[pageNum] > 0) {
+            unpinPage(&bm, &h);
+            pinCnts[pageNum]--;
+        }
+    }
+
+    getPoolMetrics(&bm, &metrics);
+    result->pins = metrics.counters[METRIC_HITS] + metrics.counters[METRIC_MISSES];
+    result->misses = metrics.counters[METRIC_MISSES];
+    result->writes = metrics.counters[METRIC_WRITES];
+
+    free(pinCnts);
+    return shutdownBufferPool(&bm);
+}
+
+int main(int argc, char *argv[]) {
+    TraceRecord *records;
+    int numRecords;
+    SM_FileHandle fHandle;
+
+    if(argc < 2) {
+        fprintf(stderr, "Usage: %s <trace file> [pool sizes...]\n", argv[0]);
+        return 1;
+    }
+
+    if(readPageTrace(argv[1], &records, &numRecords) != RC_OK) {
+        return 1;
+    }
+
+    // Page file holds exactly the distinct pages of the trace
+    int numDistinct = remapPages(records, numRecords);
+    int maxPage = numDistinct > 0 ? numDistinct - 1 : 0;
+
+    int numSizes = 0;
+    int *sizes = (int*)malloc(sizeof(int) * (argc > 2 ? argc - 2 : 32));
+    if(argc > 2) {
+        for(int i = 2; i < argc; i++) {
+            int size = atoi(argv[i]);
+            if(size > 0) {
+                sizes[numSizes++] = size;
+            }
+        }
+    } else {
+        for(int size = 1; size < numDistinct && numSizes < 31; size *= 2) {
+            sizes[numSizes++] = size;
+        }
+        sizes[numSizes++] = numDistinct > 0 ? numDistinct : 1;
+    }
+
+    // Results go to the original stdout. The buffer manager's own logging is discarded while replaying
+    fflush(stdout);
+    FILE *results = fdopen(dup(STDOUT_FILENO), "w");
+    if(results == NULL || freopen("/dev/null", "w", stdout) == NULL) {
+        fprintf(stderr, "Could not redirect buffer manager output.\n");
+        return 1;
+    }
+
+    initStorageManager();
+    createPageFile(REPLAY_PAGE_FILE);
+    openPageFile(REPLAY_PAGE_FILE, &fHandle);
+    ensureCapacity(maxPage + 1, &fHandle);
+    closePageFile(&fHandle);
+
+    fprintf(results, "# %d records, %d distinct pages\n", numRecords, numDistinct);
+    fprintf(results, "strategy,frames,pins,misses,missRatio,writes,failedPins\n");
+
+    int exitCode = 0;
+    for(int s = 0; s < NUM_STRATEGIES; s++) {
+        for(int i = 0; i < numSizes; i++) {
+            ReplayResult result;
+
+            if(replayTrace(records, numRecords, maxPage, strategies[s], sizes[i], &result) != RC_OK) {
+                fprintf(stderr, "Replay with %s and %d frames failed.\n", strategyNames[s], sizes[i]);
+                exitCode = 1;
+                continue;
+            }
+
+            fprintf(results, "%s,%d,%llu,%llu,%.4f,%llu,%d\n", strategyNames[s], sizes[i],
+                    (unsigned long long) result.pins, (unsigned long long) result.misses,
+                    result.pins == 0 ? 0.0 : (double) result.misses / result.pins,
+                    (unsigned long long) result.writes, result.failedPins);
+        }
+    }
+
+    destroyPageFile(REPLAY_PAGE_FILE);
+
+    fclose(results);
+    free(sizes);
+    free(records);
+
+    return exitCode;
+}
@@ -0,0 +1,290 @@
+/*
+victim_cache.c
+Author: Pradyumna Deshpande
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include "victim_cache.h"
+
+// Longest literal and repeat runs a single control byte of the page encoding can describe
+#define MAX_LITERAL_RUN 128
+#define MIN_REPEAT_RUN 3
+#define MAX_REPEAT_RUN (127 + MIN_REPEAT_RUN)
+
+// Worst case size of an encoded page (one control byte per literal run)
+#define MAX_ENCODED_SIZE (PAGE_SIZE + PAGE_SIZE / MAX_LITERAL_RUN + 1)
+
+// Struct for one evicted page. Entries are chained in their hash bucket and in a FIFO list (oldest evicted first)
+typedef struct VictimEntry {
+    int fileId;
+    PageNumber pageNo;
+    int size;
+    bool isRaw;
+    char *bytes;
+    struct VictimEntry *hashNext;
+    struct VictimEntry *older;
+    struct VictimEntry *newer;
+} VictimEntry;
+
+struct VictimCache {
+    int budgetBytes;
+    int usedBytes;
+    int numBuckets;
+    VictimEntry **buckets;
+    VictimEntry *oldest;
+    VictimEntry *newest;
+    char *scratch;
+    int hits;
+    int misses;
+};
+
+// Function to encode a page as literal runs (control byte 0..127) and repeat runs (control byte 128..255)
+static int compressPage(char *src, char *dst) {
+    int in = 0;
+    int out = 0;
+
+    while(in < PAGE_SIZE) {
+        // Count how often the current byte repeats
+        int run = 1;
+        while(in + run < PAGE_SIZE && run < MAX_REPEAT_RUN && src[in + run] == src[in]) {
+            run++;
+        }
+
+        if(run >= MIN_REPEAT_RUN) {
+            dst[out++] = (char) (128 + run - MIN_REPEAT_RUN);
+            dst[out++] = src[in];
+            in += run;
+            continue;
+        }
+
+        // Copy bytes literally until the next repeat run starts
+        int start = in;
+        while(in < PAGE_SIZE && in - start < MAX_LITERAL_RUN) {
+            if(in + 2 < PAGE_SIZE && src[in] == src[in + 1] && src[in] == src[in + 2]) {
+                break;
+            }
+            in++;
+        }
+
+        dst[out++] = (char) (in - start - 1);
+        memcpy(dst + out, src + start, in - start);
+        out += in - start;
+    }
+
+    return out;
+}
+
+// Function to decode a page encoded by compressPage()
+static void decompressPage(char *src, int size, char *dst) {
+    int in = 0;
+    int out = 0;
+
+    while(in < size && out < PAGE_SIZE) {
+        int ctrl = (unsigned char) src[in++];
+
+        if(ctrl >= 128) {
+            int run = ctrl - 128 + MIN_REPEAT_RUN;
+            memset(dst + out, src[in++], run);
+            out += run;
+        } else {
+            memcpy(dst + out, src + in, ctrl + 1);
+            in += ctrl + 1;
+            out += ctrl + 1;
+        }
+    }
+}
+
+static int hashPage(VictimCache *vc, int fileId, PageNumber pageNum) {
+    return (int) ((((unsigned int) pageNum + (unsigned int) fileId * 40503u) * 2654435761u) & (vc->numBuckets - 1));
+}
+
+// Function to unlink an entry from its bucket and the FIFO list and release its memory
+static void removeEntry(VictimCache *vc, VictimEntry *entry) {
+    VictimEntry **link = &vc->buckets[hashPage(vc, entry->fileId, entry->pageNo)];
+    while(*link != entry) {
+        link = &(*link)->hashNext;
+    }
+    *link = entry->hashNext;
+
+    if(entry->older != NULL) {
+        entry->older->newer = entry->newer;
+    } else {
+        vc->oldest = entry->newer;
+    }
+
+    if(entry->newer != NULL) {
+        entry->newer->older = entry->older;
+    } else {
+        vc->newest = entry->older;
+    }
+
+    vc->usedBytes -= entry->size + (int) sizeof(VictimEntry);
+
+    free(entry->bytes);
+    free(entry);
+}
+
+static VictimEntry *findEntry(VictimCache *vc, int fileId, PageNumber pageNum) {
+    VictimEntry *entry = vc->buckets[hashPage(vc, fileId, pageNum)];
+
+    while(entry != NULL && (entry->pageNo != pageNum || entry->fileId != fileId)) {
+        entry = entry->hashNext;
+    }
+
+    return entry;
+}
+
+// Function to create a victim cache holding at most budgetBytes of compressed pages and bookkeeping
+VictimCache *createVictimCache(int budgetBytes) {
+    VictimCache *vc = (VictimCache*)malloc(sizeof(VictimCache));
+
+    // Size the hash table for pages compressing to roughly an eighth of a page
+    int expectedPages = budgetBytes / (PAGE_SIZE / 8);
+    vc->numBuckets = 64;
+    while(vc->numBuckets < expectedPages) {
+        vc->numBuckets *= 2;
+    }
+
+    vc->buckets = (VictimEntry**)calloc(vc->numBuckets, sizeof(VictimEntry*));
+    vc->budgetBytes = budgetBytes;
+    vc->usedBytes = 0;
+    vc->oldest = NULL;
+    vc->newest = NULL;
+    vc->scratch = (char*)malloc(MAX_ENCODED_SIZE);
+    vc->hits = 0;
+    vc->misses = 0;
+
+    return vc;
+}
+
+// Function to free all cached pages and the cache itself
+void destroyVictimCache(VictimCache *vc) {
+    if(vc == NULL) {
+        return;
+    }
+
+    while(vc->oldest != NULL) {
+        removeEntry(vc, vc->oldest);
+    }
+
+    free(vc->buckets);
+    free(vc->scratch);
+    free(vc);
+}
+
+// Function to store a clean page evicted from the pool. Oldest entries are dropped until the page fits in the budget
+void putVictimPage(VictimCache *vc, int fileId, PageNumber pageNum, char *data) {
+    if(vc == NULL || pageNum == NO_PAGE) {
+        return;
+    }
+
+    dropVictimPage(vc, fileId, pageNum);
+
+    // Keep the page uncompressed if encoding doesn't save anything
+    int size = compressPage(data, vc->scratch);
+    bool isRaw = size >= PAGE_SIZE;
+    if(isRaw) {
+        size = PAGE_SIZE;
+    }
+
+    int needed = size + (int) sizeof(VictimEntry);
+    if(needed > vc->budgetBytes) {
+        return;
+    }
+
+    while(vc->usedBytes + needed > vc->budgetBytes) {
+        removeEntry(vc, vc->oldest);
+    }
+
+    VictimEntry *entry = (VictimEntry*)malloc(sizeof(VictimEntry));
+    entry->fileId = fileId;
+    entry->pageNo = pageNum;
+    entry->size = size;
+    entry->isRaw = isRaw;
+    entry->bytes = (char*)malloc(size);
+    memcpy(entry->bytes, isRaw ? data : vc->scratch, size);
+
+    int bucket = hashPage(vc, fileId, pageNum);
+    entry->hashNext = vc->buckets[bucket];
+    vc->buckets[bucket] = entry;
+
+    entry->newer = NULL;
+    entry->older = vc->newest;
+    if(vc->newest != NULL) {
+        vc->newest->newer = entry;
+    } else {
+        vc->oldest = entry;
+    }
+    vc->newest = entry;
+
+    vc->usedBytes += needed;
+}
+
+// Function to move a cached page back into a frame. The entry is removed since the pool now owns the page
+bool takeVictimPage(VictimCache *vc, int fileId, PageNumber pageNum, char *data) {
+    if(vc == NULL) {
+        return false;
+    }
+
+    VictimEntry *entry = findEntry(vc, fileId, pageNum);
+    if(entry == NULL) {
+        vc->misses++;
+        return false;
+    }
+
+    if(entry->isRaw) {
+        memcpy(data, entry->bytes, PAGE_SIZE);
+    } else {
+        decompressPage(entry->bytes, entry->size, data);
+    }
+
+    removeEntry(vc, entry);
+
+    vc->hits++;
+    return true;
+}
+
+// Function to forget a cached page, e.g. when it is about to be changed on disk
+void dropVictimPage(VictimCache *vc, int fileId, PageNumber pageNum) {
+    if(vc == NULL) {
+        return;
+    }
+
+    VictimEntry *entry = findEntry(vc, fileId, pageNum);
+    if(entry != NULL) {
+        removeEntry(vc, entry);
+    }
+}
+
+// Function to forget all cached pages of a page file, e.g. when the file is closed
+void dropVictimFile(VictimCache *vc, int fileId) {
+    if(vc == NULL) {
+        return;
+    }
+
+    VictimEntry *entry = vc->oldest;
+    while(entry != NULL) {
+        VictimEntry *newer = entry->newer;
+        if(entry->fileId == fileId) {
+            removeEntry(vc, entry);
+        }
+        entry = newer;
+    }
+}
+
+// Statistics
+
+int getVictimHits(VictimCache *vc) {
+    return vc == NULL ? 0 : vc->hits;
+}
+
+int getVictimMisses(VictimCache *vc) {
+    return vc == NULL ? 0 : vc->misses;
+}
+
+int getVictimUsedBytes(VictimCache *vc) {
+    return vc == NULL ? 0 : vc->usedBytes;
+}
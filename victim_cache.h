@@ -0,0 +1,31 @@
+#ifndef VICTIM_CACHE_H
+#define VICTIM_CACHE_H
+
+#include "dberror.h"
+#include "dt.h"
+#include "buffer_mgr.h"
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+// Second tier cache holding compressed copies of clean pages evicted from the buffer pool
+typedef struct VictimCache VictimCache;
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+extern VictimCache *createVictimCache (int budgetBytes);
+extern void destroyVictimCache (VictimCache *vc);
+
+/* storing and looking up evicted pages */
+extern void putVictimPage (VictimCache *vc, int fileId, PageNumber pageNum, char *data);
+extern bool takeVictimPage (VictimCache *vc, int fileId, PageNumber pageNum, char *data);
+extern void dropVictimPage (VictimCache *vc, int fileId, PageNumber pageNum);
+extern void dropVictimFile (VictimCache *vc, int fileId);
+
+/* statistics */
+extern int getVictimHits (VictimCache *vc);
+extern int getVictimMisses (VictimCache *vc);
+extern int getVictimUsedBytes (VictimCache *vc);
+
+#endif